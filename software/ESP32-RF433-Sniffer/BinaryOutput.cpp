@@ -0,0 +1,110 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#include "BinaryOutput.h"
+#include "HeapFree.h"
+
+// CRC-16/CCITT-FALSE (polynomial 0x1021), 4 bits at a time
+static const uint16_t CRC16_NIBBLES[16] = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+uint16_t RecordWriter::crc16 (const uint8_t* bytes, unsigned int length) {
+  uint16_t crc = 0xFFFF;
+  for (unsigned int i = 0; i < length; i++) {
+    crc = (crc << 4) ^ CRC16_NIBBLES[(crc >> 12) ^ (bytes[i] >> 4)];
+    crc = (crc << 4) ^ CRC16_NIBBLES[(crc >> 12) ^ (bytes[i] & 0x0F)];
+  }
+  return crc;
+}
+
+void RecordWriter::begin (RecordType type, uint32_t time) {
+  _length = 0;
+  put8(type);
+  put16(_sequence++);
+  put32(time);
+}
+
+void RecordWriter::begin (RecordType type) {
+  begin(type, millis());
+}
+
+void RecordWriter::put8 (uint8_t value) {
+  if (_length < MAX_SIZE - 2) {
+    _record[_length++] = value;
+  }
+}
+
+void RecordWriter::put16 (uint16_t value) {
+  put8(value);
+  put8(value >> 8);
+}
+
+void RecordWriter::put32 (uint32_t value) {
+  put16(value);
+  put16(value >> 16);
+}
+
+void RecordWriter::put (const char* bytes, unsigned int length) {
+  for (unsigned int i = 0; i < length; i++) {
+    put8(bytes[i]);
+  }
+}
+
+void RecordWriter::end (Formatter& out) {
+  // put8() keeps room for the CRC
+  const uint16_t crc = crc16(_record, _length);
+  _record[_length++] = crc;
+  _record[_length++] = crc >> 8;
+
+  // COBS: each block starts with the offset of the next 0x00. A block of
+  // 254 bytes (0xFF) is not followed by a 0x00.
+  char block[255];
+  unsigned int size = 1;
+  for (unsigned int i = 0; i < _length; i++) {
+    if (_record[i] == 0) {
+      block[0] = size;
+      out.write(block, size);
+      size = 1;
+    } else {
+      block[size++] = _record[i];
+      if (size == 255) {
+        block[0] = (char)0xFF;
+        out.write(block, size);
+        size = 1;
+      }
+    }
+  }
+  block[0] = size;
+  out.write(block, size);
+  out.print('\0');
+}
+
+ReplyRecords::ReplyRecords (RecordWriter& records, void (*send)(Formatter& out)) : _records(records), _send(send) {
+  // ...
+}
+
+size_t ReplyRecords::write (uint8_t c) {
+  if (c == '\r') {
+    return 1;
+  }
+  if (c != '\n') {
+    if (_length < MAX_LINE) {
+      _line[_length++] = c;
+    }
+    return 1;
+  }
+  _records.begin(RECORD_REPLY);
+  _records.put(_line, _length);
+  _records.end(_out);
+  _send(_out);
+  _length = 0;
+  return 1;
+}
@@ -0,0 +1,132 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef BINARY_OUTPUT_H
+#define BINARY_OUTPUT_H
+
+#include <Arduino.h>
+#include <RCSwitch.h>
+#include "Formatter.h"
+
+// Binary output ("BIN" command): each record is COBS encoded and ends with
+// a 0x00 byte, so that a reader can always resync on the next record.
+//
+// Decoded record (little endian):
+//   type (1 byte) | sequence (2) | time (4, millis) | payload | CRC (2)
+// The sequence is incremented for each record: a gap means lost records.
+// The CRC is a CRC-16/CCITT-FALSE of type, sequence, time and payload.
+//
+// Payloads:
+//   RECORD_TYPE1 : decimal (4) | length (1) | protocol (1) | delay (2) | flags (1)
+//                  [| next 32 bits words of the code (4 each), if length > 32]
+//   RECORD_TYPE2 : address (4) | period (2) | unit (1) | flags (1) | state (1) | dimLevel (1)
+//   RECORD_RAW   : count (2) | count timings (2 each, in microseconds)
+//   RECORD_STATS : loops (4) | loops/s (4) | max loop (4, us) | dropped frames (4)
+//                  | dropped bytes (4) | dropped edges (4) | dropped signals (4)
+//   RECORD_REPLY : command reply, as text ("OK TX1", "ERR BUSY"...)
+//
+// flags: bit 0: echo of our own transmission,
+//        bit 1: group bit (type 2), bit 2: dim level present (type 2)
+
+/**
+ * Record types
+ */
+enum RecordType {
+  RECORD_TYPE1 = 1,
+  RECORD_TYPE2 = 2,
+  RECORD_RAW = 3,
+  RECORD_STATS = 4,
+  RECORD_REPLY = 5
+};
+
+/**
+ * Record flags
+ */
+const uint8_t RECORD_FLAG_ECHO = 0x01;
+const uint8_t RECORD_FLAG_GROUP = 0x02;
+const uint8_t RECORD_FLAG_DIM_LEVEL = 0x04;
+
+/**
+ * RecordWriter class
+ *
+ * Builds a record, then appends it (CRC, COBS encoded) to a Formatter.
+ * Sequence numbers are shared by all records of the writer.
+ */
+class RecordWriter {
+  public:
+    /**
+     * Maximum size of a record (header, payload and CRC): fits the raw
+     * timings of the longest frame
+     */
+    static const unsigned int MAX_SIZE = 16 + RCSWITCH_MAX_CHANGES * 2;
+
+    /**
+     * Start a record: type, sequence and time
+     *
+     * @param type The record type
+     * @param time The record time (millis). Default: now
+     */
+    void begin (RecordType type, uint32_t time);
+    void begin (RecordType type);
+
+    /**
+     * Append payload values (little endian)
+     */
+    void put8 (uint8_t value);
+    void put16 (uint16_t value);
+    void put32 (uint32_t value);
+    void put (const char* bytes, unsigned int length);
+
+    /**
+     * End the record: append it, encoded, to "out"
+     *
+     * @param out The output buffer
+     */
+    void end (Formatter& out);
+
+    /**
+     * CRC-16/CCITT-FALSE (the CRC of the records)
+     */
+    static uint16_t crc16 (const uint8_t* bytes, unsigned int length);
+
+  private:
+    uint8_t _record[MAX_SIZE];
+    unsigned int _length = 0;
+    uint16_t _sequence = 0;
+};
+
+/**
+ * ReplyRecords class
+ *
+ * Command replies written here (as on Serial) are sent as RECORD_REPLY
+ * records, one per line.
+ */
+class ReplyRecords : public Print {
+  public:
+    /**
+     * Constructor
+     *
+     * @param records The record writer
+     * @param send Sends a rendered record (e.g. to the output queue)
+     */
+    ReplyRecords (RecordWriter& records, void (*send)(Formatter& out));
+
+    size_t write (uint8_t c) override;
+
+  private:
+    static const unsigned int MAX_LINE = 64;
+
+    RecordWriter& _records;
+    void (*_send)(Formatter& out);
+    Formatter _out;
+    char _line[MAX_LINE];
+    unsigned int _length = 0;
+};
+
+#endif
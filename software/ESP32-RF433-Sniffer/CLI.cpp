@@ -9,10 +9,13 @@
 
 #include "CLI.h"
 #include "Utils.h"
+#include "HeapFree.h"
 
 // Init mode and type
 Mode CLI::currentMode = NONE_MODE;
 Type CLI::currentType = NONE_TYPE;
+bool CLI::terseOutput = false;
+bool CLI::binaryOutput = false;
 
 void CLI::printHeader () {
   Serial.println(F("\r\n========================================"));
@@ -44,6 +47,33 @@ void CLI::printMainMenu () {
   Serial.println(F("Commands (case insensitive):"));
   Serial.println(F("  R     : Receiver mode (listening)"));
   Serial.println(F("  T     : Transmitter mode (emitting)"));
+  Serial.println(F("  TEST [<frames>] [<seed>]"));
+  Serial.println(F("        : Loopback self-test (encode > decode)"));
+  Serial.println(F("  BENCH [<iterations>]"));
+  Serial.println(F("        : Benchmark (command parsing, frame formatting, log records)"));
+  Serial.println(F("One-shot commands (any menu, one line reply):"));
+  Serial.println(F("  TX1 <decimal> <protocol> <delay> <length> [<repeat>]"));
+  Serial.println(F("  TX2 <id> <period> <group> <unit> <state> [<dimLevel>] [<repeat>]"));
+  Serial.println(F("        : Send now (<dimLevel> only with state 2)"));
+  Serial.println(F("  RX1 / RX2 / RXALL"));
+  Serial.println(F("        : Receive type 1 / type 2 / both, one line per signal"));
+  Serial.println(F("  STOP  : Stop receiving, back to main menu"));
+  Serial.println(F("  STATS [RESET]"));
+  Serial.println(F("        : Loop latency, stalls and queues (or clear them)"));
+  Serial.println(F("  HEAP  : Heap free, minimum free and largest block"));
+  Serial.println(F("  FILTER [INCLUDE|EXCLUDE|REMOVE <field> <value>] / FILTER CLEAR"));
+  Serial.println(F("        : Watch list (PROTO, CODE, LEN, ADDR, UNIT), or list it"));
+  Serial.println(F("          (CODE never matches frames longer than 32 bits)"));
+  Serial.println(F("  LOG [DUMP|TAIL [<count>]|CLEAR]"));
+  Serial.println(F("        : Signals stored in flash: count, print all / last ones, erase"));
+  Serial.println(F("  LOG LAST 1 <decimal>|LAST 2 <id>|PROTO <protocol> [<minutes>]|TOP"));
+  Serial.println(F("        : Last record of a code, records of a protocol, most frequent codes"));
+  Serial.println(F("  LIB [SAVE <name> [RAW]|ADD <name> TX1 ...|ADD <name> TX2 ...|DEL <name>]"));
+  Serial.println(F("        : Named codes: list, save the last signal, add, delete"));
+  Serial.println(F("  SEND <name> [<repeat>]"));
+  Serial.println(F("        : Send a named code now"));
+  Serial.println(F("  BIN / TEXT"));
+  Serial.println(F("        : Binary records (COBS, CRC, sequence) / text output"));
   Serial.println(F("  ?     : Show this help"));
   Serial.println(F("----------------------------------------"));
 }
@@ -64,18 +94,36 @@ void CLI::printTypeMenu () {
 
 void CLI::printSendMenu () {
   if (currentType == OLD_STYLE) {
-    // ...
+    Serial.println(F("-----------TRANSMIT-COMMAND-------------"));
+    Serial.println(F("<decimal> <protocol> <delay> <length>"));
+    Serial.println(F("Example: 5592332 1 350 24"));
+    Serial.println();
+    Serial.println(F("<decimal>      :     Code (integer)"));
+    Serial.println(F("<protocol>     :     Protocol (1..12)"));
+    Serial.println(F("<delay>        :     Pulse length (microseconds, 0: protocol default)"));
+    Serial.println(F("<length>       :     Bit length (1..32)"));
+    Serial.println();
+    Serial.println(F("RAW [<scale>] [I]"));
+    Serial.println(F("Replay the last captured signal timings as is"));
+    Serial.println(F("Example: RAW 105 I"));
+    Serial.println();
+    Serial.println(F("[<scale>]      :     [Optional] Time scaling in percent (default: 100)"));
+    Serial.println(F("[I]            :     [Optional] Invert high and low levels"));
+    Serial.println();
+    Serial.println(F("  Q / QUIT  : Back to previous menu"));
+    Serial.println(F("  ?         : Show this help"));
+    Serial.println(F("----------------------------------------"));
   } else {
     Serial.println(F("-----------TRANSMIT-COMMAND-------------"));
-    Serial.println(F("<id> <period> <group> <state> <unit> [<dimLevel>]"));
-    Serial.println(F("Example: 123456789 260 0 1 1"));
+    Serial.println(F("<id> <period> <group> <unit> <state> [<dimLevel>]"));
+    Serial.println(F("Example: 12345678 260 0 1 1"));
     Serial.println();
-    Serial.println(F("<id>           :     Address (integer)"));
+    Serial.println(F("<id>           :     Address (0..67108863)"));
     Serial.println(F("<period>       :     Default period (260 microseconds) seems good"));
     Serial.println(F("<group>        :     Group bit (0/1)"));
-    Serial.println(F("<state>        :     0: off, 1: on, 2: dim"));
     Serial.println(F("<unit>         :     Unit (0..15)"));
-    Serial.println(F("[<dimLevel>]   :     [Optional] The dim level (0..255)"));
+    Serial.println(F("<state>        :     0: off, 1: on, 2: dim"));
+    Serial.println(F("[<dimLevel>]   :     [Optional] The dim level (0..15)"));
     Serial.println();
     Serial.println(F("  Q / QUIT  : Back to previous menu"));
     Serial.println(F("  ?         : Show this help"));
@@ -87,11 +135,25 @@ void CLI::printPromptPrefix () {
   Serial.print(F("> "));
 }
 
-void CLI::handleSerialCommands (String input) {
+void CLI::printPromptPrefix (Formatter& out) {
+  out.print(F("> "));
+}
+
+void CLI::handleSerialCommands (const Command& command) {
+  // One-shot command: no menu, no prompt
+  if (handleOneShotCommand(command)) {
+    return;
+  }
+  // Menus would break the binary records
+  if (binaryOutput) {
+    reply().print(F("ERR UNKNOWN ")); reply().println(command.token(0).str);
+    return;
+  }
+
   // Stop/quit command
-  if (handleQuitCommand(input)) {
+  if (handleQuitCommand(command)) {
     return;
-  } else if (handleHelpCommand(input)) { // help command
+  } else if (handleHelpCommand(command)) { // help command
     return;
   }
 
@@ -99,24 +161,59 @@ void CLI::handleSerialCommands (String input) {
   if (currentType == NONE_TYPE) {
     // No mode selected
     if (currentMode == NONE_MODE) {
-      handleModeCommand(input);
+      handleModeCommand(command);
     } else {
-      handleTypeCommand(input);
+      handleTypeCommand(command);
     }
   } else {
     if (currentMode == RECEIVE_MODE) {
       // ...
     } else {
-      handleSendCommand(input);
+      handleSendCommand(command);
     }
   }
 
   printPromptPrefix();
 }
 
-boolean CLI::handleQuitCommand (String input) {
+boolean CLI::handleOneShotCommand (const Command& command) {
+  if (command.is("TX1")) {
+    onTransmitNow(command, OLD_STYLE);
+  } else if (command.is("TX2")) {
+    onTransmitNow(command, NEW_STYLE);
+  } else if (command.is("RX1")) {
+    onReceiveNow(command, OLD_STYLE);
+  } else if (command.is("RX2")) {
+    onReceiveNow(command, NEW_STYLE);
+  } else if (command.is("RXALL")) {
+    onReceiveNow(command, ALL_TYPES);
+  } else if (command.is("STOP")) {
+    onStopNow(command);
+  } else if (command.is("STATS")) {
+    onStats(command);
+  } else if (command.is("HEAP")) {
+    onHeap(command);
+  } else if (command.is("FILTER")) {
+    onFilter(command);
+  } else if (command.is("LOG")) {
+    onLog(command);
+  } else if (command.is("LIB")) {
+    onLibrary(command);
+  } else if (command.is("SEND")) {
+    onSendCode(command);
+  } else if (command.is("BIN")) {
+    onOutputMode(command, true);
+  } else if (command.is("TEXT")) {
+    onOutputMode(command, false);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+boolean CLI::handleQuitCommand (const Command& command) {
   // Stop/quit command
-  if (input == "Q" || input == "QUIT") {
+  if (command.count() == 1 && (command.is("Q") || command.is("QUIT"))) {
     onQuit();
     return true;
   } else {
@@ -124,9 +221,9 @@ boolean CLI::handleQuitCommand (String input) {
   }
 }
 
-boolean CLI::handleHelpCommand (String input) {
+boolean CLI::handleHelpCommand (const Command& command) {
   // Help command
-  if (input == "?") {
+  if (command.count() == 1 && command.is("?")) {
     onHelp();
     return true;
   } else {
@@ -134,31 +231,35 @@ boolean CLI::handleHelpCommand (String input) {
   }
 }
 
-void CLI::handleModeCommand (String input) {
-  if (input == "R") {
+void CLI::handleModeCommand (const Command& command) {
+  if (command.is("R")) {
     currentMode = RECEIVE_MODE;
     onModeChosen();
-  } else if (input == "T") {
+  } else if (command.is("T")) {
     currentMode = TRANSMIT_MODE;
     onModeChosen();
+  } else if (command.is("TEST")) {
+    onTest(command);
+  } else if (command.is("BENCH")) {
+    onBenchmark(command);
   } else {
-    Serial.print(F("ERROR: Unknown mode: ")); Serial.println(input);
+    Serial.print(F("ERROR: Unknown mode: ")); Serial.println(command.token(0).str);
   }
   printMenu();
 }
 
-void CLI::handleTypeCommand (String input) {
+void CLI::handleTypeCommand (const Command& command) {
   bool unknownCmd = false;
-  if (input == "1") {
+  if (command.is("1")) {
     currentType = OLD_STYLE;
-  } else if (input == "2") {
+  } else if (command.is("2")) {
     currentType = NEW_STYLE;
   } else {
     unknownCmd = true;
   }
 
   if (unknownCmd) {
-    Serial.print(F("ERROR: Unknown command: ")); Serial.println(input);
+    Serial.print(F("ERROR: Unknown command: ")); Serial.println(command.token(0).str);
   } else {
     onTypeChosen();
   }
@@ -166,6 +267,6 @@ void CLI::handleTypeCommand (String input) {
   printMenu();
 }
 
-void CLI::handleSendCommand (String input) {
-  onSend(input);
+void CLI::handleSendCommand (const Command& command) {
+  onSend(command);
 }
@@ -12,17 +12,28 @@
 
 #include <Arduino.h>
 #include "Data.h"
+#include "Command.h"
+#include "Formatter.h"
 
 // Mode
 enum Mode { NONE_MODE, RECEIVE_MODE, TRANSMIT_MODE };
 // Type
-enum Type { NONE_TYPE, OLD_STYLE, NEW_STYLE };
+enum Type { NONE_TYPE, OLD_STYLE, NEW_STYLE, ALL_TYPES /* one-shot RXALL only */ };
 
 class CLI {
   public:
     // Static variables
     static Mode currentMode;
     static Type currentType;
+    // Set by one-shot commands: one line per decoded signal, no menu
+    static bool terseOutput;
+    // Set by "BIN": binary records instead of text (see BinaryOutput.h)
+    static bool binaryOutput;
+
+    /**
+     * Where one-shot commands reply: Serial, or binary records
+     */
+    static Print& reply ();
 
     /**
      * Print the header
@@ -48,43 +59,56 @@ class CLI {
      * Print prompt prefix "> "
      */
     static void printPromptPrefix ();
+    /**
+     * Render prompt prefix "> " (after a queued signal)
+     *
+     * @param out The output buffer
+     */
+    static void printPromptPrefix (Formatter& out);
 
     /**
      * Handle serial commands sent by user
      *
-     * @param input The user prompt
+     * @param command The user command
      */
-    static void handleSerialCommands (String input);
+    static void handleSerialCommands (const Command& command);
+    /**
+     * Handle one-shot commands (TX1, TX2, RX1, RX2, RXALL, STOP).
+     * They work in any state and reply with a single line.
+     *
+     * @param command The user command
+     */
+    static boolean handleOneShotCommand (const Command& command);
     /**
      * Handle any "quit" command
      *
-     * @param input The user prompt
+     * @param command The user command
      */
-    static boolean handleQuitCommand (String input);
+    static boolean handleQuitCommand (const Command& command);
     /**
      * Handle any "help" command
      *
-     * @param input The user prompt
+     * @param command The user command
      */
-    static boolean handleHelpCommand (String input);
+    static boolean handleHelpCommand (const Command& command);
     /**
      * Handle serial commands for main menu
      *
-     * @param input The user prompt
+     * @param command The user command
      */
-    static void handleModeCommand (String input);
+    static void handleModeCommand (const Command& command);
     /**
      * Handle serial commands for type menu
      *
-     * @param input The user prompt
+     * @param command The user command
      */
-    static void handleTypeCommand (String input);
+    static void handleTypeCommand (const Command& command);
     /**
      * Handle serial commands to send signals
      *
-     * @param input The user prompt
+     * @param command The user command
      */
-    static void handleSendCommand (String input);
+    static void handleSendCommand (const Command& command);
 
     /**
      * Do something when "help" command is readen
@@ -105,9 +129,90 @@ class CLI {
     /**
      * Do something when "send" command is readen
      *
-     * @param input The user prompt
+     * @param command The user command
+     */
+    static void onSend (const Command& command);
+    /**
+     * Do something when "test" command is readen
+     *
+     * @param command The user command
+     */
+    static void onTest (const Command& command);
+    /**
+     * Do something when "bench" command is readen
+     *
+     * @param command The user command
+     */
+    static void onBenchmark (const Command& command);
+    /**
+     * Do something when "TX1" or "TX2" command is readen
+     *
+     * @param command The user command
+     * @param type The type to send
+     */
+    static void onTransmitNow (const Command& command, Type type);
+    /**
+     * Do something when "RX1", "RX2" or "RXALL" command is readen
+     *
+     * @param command The user command
+     * @param type The type to receive
+     */
+    static void onReceiveNow (const Command& command, Type type);
+    /**
+     * Do something when "STOP" command is readen
+     *
+     * @param command The user command
+     */
+    static void onStopNow (const Command& command);
+    /**
+     * Do something when "STATS" command is readen
+     *
+     * @param command The user command
+     */
+    static void onStats (const Command& command);
+    /**
+     * Do something when "HEAP" command is readen
+     *
+     * @param command The user command
+     */
+    static void onHeap (const Command& command);
+    /**
+     * Do something when "BIN" or "TEXT" command is readen
+     *
+     * @param command The user command
+     * @param binary Switch to binary output
+     */
+    static void onOutputMode (const Command& command, bool binary);
+    /**
+     * Do something when "FILTER" command is readen
+     *
+     * @param command The user command
+     */
+    static void onFilter (const Command& command);
+    /**
+     * Do something when "LOG" command is readen
+     *
+     * @param command The user command
+     */
+    static void onLog (const Command& command);
+    /**
+     * Do something when "LOG LAST", "LOG PROTO" or "LOG TOP" command is readen
+     *
+     * @param command The user command
+     */
+    static void onLogQuery (const Command& command);
+    /**
+     * Do something when "LIB" command is readen
+     *
+     * @param command The user command
+     */
+    static void onLibrary (const Command& command);
+    /**
+     * Do something when "SEND" command is readen
+     *
+     * @param command The user command
      */
-    static void onSend (String input);
+    static void onSendCode (const Command& command);
 };
 
 #endif
\ No newline at end of file
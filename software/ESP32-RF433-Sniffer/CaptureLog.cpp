@@ -0,0 +1,537 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#include "CaptureLog.h"
+#include "HeapFree.h"
+
+// Tag flags stored in a record
+static const uint8_t STORED_FLAGS = FRAME_FLAG_ECHO | FRAME_FLAG_RAW | FRAME_FLAG_DIM_LEVEL;
+
+/**
+ * Append a varint, returns its size
+ */
+static unsigned int putVarint (uint8_t* bytes, uint32_t value) {
+  unsigned int size = 0;
+  while (value >= 0x80) {
+    bytes[size++] = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  bytes[size++] = value;
+  return size;
+}
+
+/**
+ * Read a varint at "offset" (moved after it), false if it goes past "length"
+ */
+static bool getVarint (const uint8_t* bytes, unsigned int length, unsigned int& offset, uint32_t& value) {
+  value = 0;
+  for (unsigned int shift = 0; shift < 35; shift += 7) {
+    if (offset >= length) {
+      return false;
+    }
+    const uint8_t byte = bytes[offset++];
+    value |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Payload bytes of a frame: type 2 payload is 37 bits, whatever its bit length
+ */
+static unsigned int payloadBytes (uint8_t decoder, unsigned int bitLength) {
+  return decoder == FRAME_TYPE2 ? 5 : (bitLength + 7) / 8;
+}
+
+static uint8_t checksum (const uint8_t* bytes, unsigned int length) {
+  uint8_t sum = 0;
+  for (unsigned int i = 0; i < length; i++) {
+    sum += bytes[i];
+  }
+  return sum;
+}
+
+// CaptureLog class constructor
+CaptureLog::CaptureLog (TimerWheel& timers, unsigned long flushDelay, bool (*isBusy)()) : _timers(timers), _flushDelay(flushDelay), _isBusy(isBusy) {
+  // ...
+}
+
+bool CaptureLog::begin (const char* storage, unsigned int sectors) {
+  _ready = sectors > 0 && _flash.begin(storage, 0, (unsigned long)sectors * FlashRegion::SECTOR_SIZE);
+  if (!_ready) {
+    return false;
+  }
+  _sectors = sectors;
+  _usedSectors = 0;
+  _head = sectors - 1;
+  _sequence = 0;
+  _boot = 0;
+  // Newest sector: highest sequence
+  bool found = false;
+  for (unsigned int sector = 0; sector < sectors; sector++) {
+    SectorHeader header;
+    if (!_readHeader(sector, header)) {
+      continue;
+    }
+    _usedSectors++;
+    if (!found || (int32_t)(header.sequence - _sequence) > 0) {
+      _head = sector;
+      _sequence = header.sequence;
+    }
+    if (!found || header.boot > _boot) {
+      _boot = header.boot;
+    }
+    found = true;
+  }
+  if (found) {
+    _boot++;
+  }
+  // The first record of this boot starts a new sector
+  _needSector = true;
+  _pendingLength = 0;
+  _pendingCount = 0;
+  return true;
+}
+
+bool CaptureLog::isReady () const {
+  return _ready;
+}
+
+bool CaptureLog::append (const Frame& frame, const RawCapture* raw) {
+  if (!_ready) {
+    return false;
+  }
+  // After the waiting records, in order
+  if (_pendingCount > 0 || (_busy() && _needsFlash(frame, raw))) {
+    return _defer(frame, raw);
+  }
+  return _append(frame, raw);
+}
+
+unsigned int CaptureLog::pending () const {
+  return _pendingCount;
+}
+
+bool CaptureLog::writePending (LogEntry& entry) {
+  // No timer was left for the flush: tried again (see _scheduleFlush)
+  if (_flushMissed) {
+    _flushMissed = false;
+    _scheduleFlush(_flushDelay);
+  }
+  while (_pendingCount > 0 && !_busy()) {
+    // Oldest record: tag, length, then its timestamp as delta
+    unsigned int offset = 1;
+    uint32_t length = 0;
+    uint32_t timestamp;
+    getVarint(_pending, _pendingLength, offset, length);
+    const unsigned int size = offset + length;
+    const bool valid = decode(_pending, size, entry.frame, timestamp, &_pendingRaw);
+    _pendingLength -= size;
+    _pendingCount--;
+    memmove(_pending, _pending + size, _pendingLength);
+    entry.frame.timestamp = timestamp;
+    if (valid && _append(entry.frame, &_pendingRaw)) {
+      entry.boot = _boot;
+      entry.address = _lastAddress;
+      return true;
+    }
+  }
+  return false;
+}
+
+void CaptureLog::flush () {
+  _timers.cancel(_flushTimer);
+  _flushTimer = NO_TIMER;
+  _flushMissed = false;
+  if (!_ready) {
+    return;
+  }
+  if (_busy()) {
+    // Tried again once the device is free
+    _scheduleFlush(BUSY_RETRY);
+    return;
+  }
+  if (!_flushPage()) {
+    _failed++;
+  }
+}
+
+bool CaptureLog::clear () {
+  if (!_ready || _busy()) {
+    return false;
+  }
+  flush();
+  _pendingLength = 0;
+  _pendingCount = 0;
+  for (unsigned int sector = 0; sector < _sectors; sector++) {
+    SectorHeader header;
+    // Erased sectors stay as they are
+    if (_readHeader(sector, header) && !_flash.erase(sector * FlashRegion::SECTOR_SIZE, FlashRegion::SECTOR_SIZE)) {
+      return false;
+    }
+  }
+  _usedSectors = 0;
+  _head = _sectors - 1;
+  _needSector = true;
+  return true;
+}
+
+void CaptureLog::first (LogCursor& cursor) {
+  flush();
+  // Oldest sector first: the one after the newest, around the ring
+  cursor.sector = _sectors > 0 ? (_head + 1) % _sectors : 0;
+  cursor.sectorsLeft = _ready ? _sectors : 0;
+  cursor.address = 0;
+  cursor.time = 0;
+  cursor.boot = 0;
+}
+
+bool CaptureLog::next (LogCursor& cursor, LogEntry& entry, RawCapture* raw) {
+  while (true) {
+    if (cursor.address == 0) {
+      // Open the next sector
+      if (cursor.sectorsLeft == 0) {
+        return false;
+      }
+      cursor.sectorsLeft--;
+      SectorHeader header;
+      if (!_readHeader(cursor.sector, header)) {
+        cursor.sector = (cursor.sector + 1) % _sectors;
+        continue;
+      }
+      cursor.address = cursor.sector * FlashRegion::SECTOR_SIZE + HEADER_SIZE;
+      cursor.time = header.time;
+      cursor.boot = header.boot;
+    }
+
+    // Tag and length (up to 2 bytes), without reading past the sector
+    const uint32_t sectorEnd = (cursor.sector + 1) * FlashRegion::SECTOR_SIZE;
+    unsigned int available = sectorEnd - cursor.address;
+    unsigned int offset = 1;
+    uint32_t length = 0;
+    bool valid = available >= 3 && _flash.read(cursor.address, _record, 3) && _record[0] != 0xFF &&
+      getVarint(_record, 3, offset, length) && length > 0 && offset + length <= available &&
+      offset + length <= MAX_RECORD_SIZE;
+    if (valid) {
+      valid = _flash.read(cursor.address + 3, _record + 3, offset + length - 3);
+    }
+    uint32_t delta;
+    if (valid) {
+      valid = decode(_record, offset + length, entry.frame, delta, raw);
+    }
+    if (!valid) {
+      // End of the sector
+      cursor.address = 0;
+      cursor.sector = (cursor.sector + 1) % _sectors;
+      continue;
+    }
+    cursor.time += delta;
+    entry.frame.timestamp = cursor.time;
+    entry.boot = cursor.boot;
+    entry.address = cursor.address;
+    cursor.address += offset + length;
+    return true;
+  }
+}
+
+void CaptureLog::seek (LogCursor& cursor, unsigned int sector) {
+  flush();
+  cursor.sector = sector;
+  cursor.sectorsLeft = _ready && sector < _sectors ? 1 : 0;
+  cursor.address = 0;
+  cursor.time = 0;
+  cursor.boot = 0;
+}
+
+unsigned long CaptureLog::tail (LogCursor& cursor, unsigned long count) {
+  flush();
+  unsigned long records = 0;
+  unsigned int sector = _head;
+  unsigned int opened = 0;
+  // Newest sector first, back around the ring
+  while (_ready && opened < _sectors && records < count) {
+    LogCursor counter;
+    LogEntry entry;
+    seek(counter, sector);
+    while (next(counter, entry, nullptr)) {
+      records++;
+    }
+    opened++;
+    sector = (sector + _sectors - 1) % _sectors;
+  }
+  // Read from the oldest of them
+  cursor.sector = _sectors > 0 ? (sector + 1) % _sectors : 0;
+  cursor.sectorsLeft = opened;
+  cursor.address = 0;
+  cursor.time = 0;
+  cursor.boot = 0;
+  return records > count ? records - count : 0;
+}
+
+unsigned int CaptureLog::sectors () const {
+  return _sectors;
+}
+
+unsigned int CaptureLog::usedSectors () const {
+  return _usedSectors;
+}
+
+unsigned int CaptureLog::head () const {
+  return _head;
+}
+
+uint32_t CaptureLog::lastAddress () const {
+  return _lastAddress;
+}
+
+uint32_t CaptureLog::boot () const {
+  return _boot;
+}
+
+unsigned long CaptureLog::appended () const {
+  return _appended;
+}
+
+unsigned long CaptureLog::pageWrites () const {
+  return _pageWrites;
+}
+
+unsigned long CaptureLog::erases () const {
+  return _erases;
+}
+
+unsigned long CaptureLog::failed () const {
+  return _failed;
+}
+
+unsigned int CaptureLog::encode (uint8_t* record, const Frame& frame, uint32_t delta, const RawCapture* raw) {
+  // The body is encoded after room for the tag and the length (moved back
+  // once the length is known)
+  uint8_t* body = record + 3;
+  unsigned int n = 0;
+  n += putVarint(body + n, delta);
+  body[n++] = frame.protocol;
+  body[n++] = frame.bitLength;
+  n += putVarint(body + n, frame.period);
+  const unsigned int bytes = payloadBytes(frame.decoder, frame.bitLength);
+  for (unsigned int i = 0; i < bytes && i < FRAME_PAYLOAD_WORDS * 4; i++) {
+    body[n++] = frame.payload[i / 4] >> (i % 4 * 8);
+  }
+  uint8_t flags = frame.flags & (STORED_FLAGS & ~FRAME_FLAG_RAW);
+  if (raw && (frame.flags & FRAME_FLAG_RAW)) {
+    flags |= FRAME_FLAG_RAW;
+    const unsigned int count = raw->count < RCSWITCH_MAX_CHANGES ? raw->count : RCSWITCH_MAX_CHANGES;
+    n += putVarint(body + n, count);
+    for (unsigned int i = 0; i < count; i++) {
+      if (i < 2) {
+        n += putVarint(body + n, raw->timings[i]);
+      } else {
+        // Timings alternate high and low: compared with the same level of
+        // the previous bit. Zigzag: small differences, positive or negative,
+        // on few bytes
+        const int32_t difference = (int32_t)raw->timings[i] - raw->timings[i - 2];
+        n += putVarint(body + n, ((uint32_t)difference << 1) ^ (uint32_t)(difference >> 31));
+      }
+    }
+  }
+
+  // Tag and length, right before the body
+  uint8_t header[3];
+  header[0] = frame.decoder | (flags << 2);
+  const unsigned int headerSize = 1 + putVarint(header + 1, n + 1);
+  const unsigned int start = 3 - headerSize;
+  memcpy(record + start, header, headerSize);
+  const unsigned int size = headerSize + n;
+  if (start > 0) {
+    memmove(record, record + start, size);
+  }
+  record[size] = checksum(record, size);
+  return size + 1;
+}
+
+bool CaptureLog::decode (const uint8_t* record, unsigned int length, Frame& frame, uint32_t& delta, RawCapture* raw) {
+  if (length < 2 || record[0] == 0xFF || checksum(record, length - 1) != record[length - 1]) {
+    return false;
+  }
+  // Checksum excluded
+  length--;
+  unsigned int offset = 1;
+  uint32_t bodyLength, period;
+  if (!getVarint(record, length, offset, bodyLength) || !getVarint(record, length, offset, delta)) {
+    return false;
+  }
+  memset(&frame, 0, sizeof(Frame));
+  frame.decoder = record[0] & 0x03;
+  frame.flags = (record[0] >> 2) & STORED_FLAGS;
+  if ((frame.decoder != FRAME_TYPE1 && frame.decoder != FRAME_TYPE2) || offset + 2 > length) {
+    return false;
+  }
+  frame.protocol = record[offset++];
+  frame.bitLength = record[offset++];
+  if (!getVarint(record, length, offset, period) || frame.bitLength > FRAME_MAX_BITS) {
+    return false;
+  }
+  frame.period = period;
+  const unsigned int bytes = payloadBytes(frame.decoder, frame.bitLength);
+  if (offset + bytes > length) {
+    return false;
+  }
+  for (unsigned int i = 0; i < bytes; i++) {
+    frame.payload[i / 4] |= (uint32_t)record[offset++] << (i % 4 * 8);
+  }
+  if (raw) {
+    raw->count = 0;
+  }
+  if (frame.flags & FRAME_FLAG_RAW) {
+    uint32_t count, value;
+    if (!getVarint(record, length, offset, count) || count > RCSWITCH_MAX_CHANGES) {
+      return false;
+    }
+    // The last two timings
+    uint16_t timings[2] = { 0, 0 };
+    for (unsigned int i = 0; i < count; i++) {
+      if (!getVarint(record, length, offset, value)) {
+        return false;
+      }
+      const uint16_t timing = i < 2 ? value : timings[i % 2] + (int32_t)((value >> 1) ^ -(int32_t)(value & 1));
+      timings[i % 2] = timing;
+      if (raw) {
+        raw->timings[i] = timing;
+      }
+    }
+    if (raw) {
+      raw->count = count;
+    }
+  }
+  return offset == length;
+}
+
+bool CaptureLog::_busy () const {
+  return _isBusy != nullptr && _isBusy();
+}
+
+bool CaptureLog::_append (const Frame& frame, const RawCapture* raw) {
+  int32_t delta = frame.timestamp - _lastTime;
+  unsigned int length = encode(_record, frame, delta > 0 ? delta : 0, raw);
+  // Records never span sectors
+  if (_needSector || _pageAddress + _pageLength + length > (_head + 1) * FlashRegion::SECTOR_SIZE) {
+    if (!_startSector(frame.timestamp)) {
+      _failed++;
+      return false;
+    }
+    length = encode(_record, frame, 0, raw);
+  }
+  const uint32_t address = _pageAddress + _pageLength;
+  if (!_write(_record, length)) {
+    _failed++;
+    return false;
+  }
+  _lastTime = frame.timestamp;
+  _lastAddress = address;
+  _appended++;
+  // Written at the latest after the flush delay
+  _scheduleFlush(_flushDelay);
+  return true;
+}
+
+bool CaptureLog::_needsFlash (const Frame& frame, const RawCapture* raw) {
+  int32_t delta = frame.timestamp - _lastTime;
+  const unsigned int length = encode(_record, frame, delta > 0 ? delta : 0, raw);
+  // A new sector is erased, a full page is programmed
+  return _needSector || _pageAddress + _pageLength + length > (_head + 1) * FlashRegion::SECTOR_SIZE ||
+    _pageLength + length >= FlashRegion::PAGE_SIZE;
+}
+
+bool CaptureLog::_defer (const Frame& frame, const RawCapture* raw) {
+  const unsigned int length = encode(_record, frame, frame.timestamp, raw);
+  if (_pendingLength + length > PENDING_SIZE) {
+    _failed++;
+    return false;
+  }
+  memcpy(_pending + _pendingLength, _record, length);
+  _pendingLength += length;
+  _pendingCount++;
+  return true;
+}
+
+void CaptureLog::_scheduleFlush (unsigned long delay) {
+  if (!_timers.isPending(_flushTimer)) {
+    _flushTimer = _timers.schedule([this]() {
+      flush();
+    }, delay);
+    // Pool full: scheduled again by the next writePending (loop)
+    _flushMissed = _flushTimer == NO_TIMER;
+  }
+}
+
+bool CaptureLog::_startSector (uint32_t time) {
+  if (!_flushPage()) {
+    return false;
+  }
+  const unsigned int sector = (_head + 1) % _sectors;
+  if (!_flash.erase(sector * FlashRegion::SECTOR_SIZE, FlashRegion::SECTOR_SIZE)) {
+    return false;
+  }
+  _erases++;
+  if (_usedSectors < _sectors) {
+    _usedSectors++;
+  }
+  _head = sector;
+  _sequence++;
+  _needSector = false;
+  _lastTime = time;
+
+  // The header is programmed now: the sector is the newest one from now
+  const SectorHeader header = { MAGIC, _sequence, _boot, time };
+  _pageAddress = sector * FlashRegion::SECTOR_SIZE;
+  _pageLength = 0;
+  _pageFlushed = 0;
+  return _write((const uint8_t*)&header, sizeof(header)) && _flushPage();
+}
+
+bool CaptureLog::_write (const uint8_t* bytes, unsigned int length) {
+  while (length > 0) {
+    unsigned int count = FlashRegion::PAGE_SIZE - _pageLength;
+    if (count > length) {
+      count = length;
+    }
+    memcpy(_page + _pageLength, bytes, count);
+    _pageLength += count;
+    bytes += count;
+    length -= count;
+    if (_pageLength == FlashRegion::PAGE_SIZE) {
+      // Full page: next one
+      if (!_flushPage()) {
+        return false;
+      }
+      _pageAddress += FlashRegion::PAGE_SIZE;
+      _pageLength = 0;
+      _pageFlushed = 0;
+    }
+  }
+  return true;
+}
+
+bool CaptureLog::_flushPage () {
+  if (_pageLength == _pageFlushed) {
+    return true;
+  }
+  if (!_flash.write(_pageAddress + _pageFlushed, _page + _pageFlushed, _pageLength - _pageFlushed)) {
+    return false;
+  }
+  _pageFlushed = _pageLength;
+  _pageWrites++;
+  return true;
+}
+
+bool CaptureLog::_readHeader (unsigned int sector, SectorHeader& header) {
+  return _flash.read(sector * FlashRegion::SECTOR_SIZE, &header, sizeof(header)) && header.magic == MAGIC;
+}
@@ -0,0 +1,344 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef CAPTURE_LOG_H
+#define CAPTURE_LOG_H
+
+#include <Arduino.h>
+#include "Data.h"
+#include "FlashRegion.h"
+#include "TimerWheel.h"
+
+// Capture log ("LOG" command): decoded signals are appended to a ring of
+// flash sectors, so that they are kept when nobody listens to the serial
+// port, and across reboots. When the ring is full, the oldest sector is
+// erased.
+//
+// Sector (FlashRegion::SECTOR_SIZE bytes): header | records | erased (0xFF)
+//   header : magic "RFL1" (4) | sequence (4) | boot (4) | time (4, millis of the first record)
+// The sequence is incremented for each new sector: the newest sector has the
+// highest one. A new sector is started at each boot (boot is incremented).
+//
+// Record (varint: 7 bits per byte, least significant first, bit 7 set if
+// another byte follows):
+//   tag (1)       : decoder | flags << 2 (FRAME_FLAG_*), never 0xFF
+//   length        : varint, bytes after it (checksum included)
+//   time          : varint, ms since the previous record of the sector
+//                   (since the header time for the first one)
+//   protocol (1) | bit length (1) | period (varint)
+//   payload       : type 1: (bit length + 7) / 8 bytes, type 2: 5 bytes (little endian)
+//   [raw timings, if FRAME_FLAG_RAW: count (varint) | first two timings (varint)
+//    | next timings (varint, zigzag encoded difference with the timing two
+//    places before: the same level of the previous bit)]
+//   checksum (1)  : sum of the previous bytes of the record
+// A record that is erased, cut (power loss while writing) or invalid ends
+// its sector.
+//
+// Records are written in a RAM page (FlashRegion::PAGE_SIZE bytes): a page is
+// programmed once full, or when nothing has been appended for the flush
+// delay. Partly written pages are completed in place (erased bytes only).
+//
+// Nothing is programmed or erased while the device is busy (see the
+// constructor): on the ESP32, a flash operation stalls the code running from
+// flash on both cores, the transmit task included. A record that would need
+// one waits in RAM (encoded, with its timestamp instead of a delta), and so do
+// the next ones, until writePending is called when the device is free again.
+
+/**
+ * A record read from the log
+ */
+struct LogEntry {
+  // The decoded signal (timestamp: millis since its boot)
+  Frame frame;
+  // Boot of the device when it was decoded
+  uint32_t boot;
+  // Address of the record in the log
+  uint32_t address;
+};
+
+/**
+ * Position of a reader in the log (see CaptureLog::first)
+ */
+struct LogCursor {
+  // Sector being read
+  unsigned int sector;
+  // Sectors left to open
+  unsigned int sectorsLeft;
+  // Next record, 0 when the sector must be opened
+  uint32_t address;
+  // Time of the previous record and boot of the sector
+  uint32_t time;
+  uint32_t boot;
+};
+
+/**
+ * CaptureLog class
+ *
+ * Append-only ring log of decoded signals in flash (see above). Nothing is
+ * allocated: one page and one record are buffered in RAM.
+ */
+class CaptureLog {
+  public:
+    /**
+     * "RFL1"
+     */
+    static const uint32_t MAGIC = 0x314C4652;
+    /**
+     * Size of a sector header
+     */
+    static const unsigned int HEADER_SIZE = 16;
+    /**
+     * Maximum size of a record: the longest frame with its raw timings
+     */
+    static const unsigned int MAX_RECORD_SIZE = 20 + FRAME_PAYLOAD_WORDS * 4 + RCSWITCH_MAX_CHANGES * 3;
+    /**
+     * Records waiting while the device is busy (bytes)
+     */
+    static const unsigned int PENDING_SIZE = 2 * MAX_RECORD_SIZE;
+    /**
+     * Delay before a flush is tried again when the device is busy (in ms)
+     */
+    static const unsigned long BUSY_RETRY = 100;
+
+    /**
+     * Constructor
+     *
+     * @param timers The timer wheel flushing the page
+     * @param flushDelay Delay before the page is written when nothing is appended (in ms)
+     * @param isBusy To know if the flash must be left alone (e.g. while transmitting), or nullptr
+     */
+    CaptureLog (TimerWheel& timers, unsigned long flushDelay, bool (*isBusy)() = nullptr);
+
+    /**
+     * Open the log (at the start of the storage) and find its newest sector
+     *
+     * @param storage The partition label (ESP32) or the file path (host build)
+     * @param sectors The number of sectors of the ring
+     * @return false if the storage is not available (the log stays disabled)
+     */
+    bool begin (const char* storage, unsigned int sectors);
+
+    /**
+     * To know if the log is available
+     */
+    bool isReady () const;
+
+    /**
+     * Append a decoded signal (it may wait in RAM, see pending)
+     *
+     * @param frame The decoded signal
+     * @param raw Its raw timings (type 1), or nullptr
+     * @return false if it could not be written, nor kept to be written later
+     */
+    bool append (const Frame& frame, const RawCapture* raw);
+
+    /**
+     * Number of records waiting for the device to be free
+     */
+    unsigned int pending () const;
+
+    /**
+     * Write the oldest waiting record, if the device is free. To call from
+     * the loop: it also schedules the flush no timer was left for.
+     *
+     * @param entry The record written
+     * @return false if there is nothing to write, or not now
+     */
+    bool writePending (LogEntry& entry);
+
+    /**
+     * Write the buffered bytes now (later if the device is busy)
+     */
+    void flush ();
+
+    /**
+     * Erase the whole log (waiting records included)
+     *
+     * @return false if the flash could not be erased, or the device is busy
+     */
+    bool clear ();
+
+    /**
+     * Start reading from the oldest record (buffered bytes are written first)
+     *
+     * @param cursor The reader position
+     */
+    void first (LogCursor& cursor);
+
+    /**
+     * Read the next record
+     *
+     * @param cursor The reader position
+     * @param entry The record
+     * @param raw Its raw timings (count 0 if none), or nullptr to skip them
+     * @return false at the end of the log
+     */
+    bool next (LogCursor& cursor, LogEntry& entry, RawCapture* raw);
+
+    /**
+     * Start reading a single sector (buffered bytes are written first)
+     *
+     * @param cursor The reader position
+     * @param sector The sector
+     */
+    void seek (LogCursor& cursor, unsigned int sector);
+
+    /**
+     * Start reading the last records: the sectors are counted from the
+     * newest one back, until they hold enough records (buffered bytes are
+     * written first)
+     *
+     * @param cursor The reader position (oldest of these sectors)
+     * @param count The number of records
+     * @return The number of records to skip before the last "count" ones
+     */
+    unsigned long tail (LogCursor& cursor, unsigned long count);
+
+    /**
+     * Ring size and sectors holding records (in sectors)
+     */
+    unsigned int sectors () const;
+    unsigned int usedSectors () const;
+
+    /**
+     * Newest sector (the oldest one is the next around the ring)
+     */
+    unsigned int head () const;
+
+    /**
+     * Address of the last appended record
+     */
+    uint32_t lastAddress () const;
+
+    /**
+     * Current boot number
+     */
+    uint32_t boot () const;
+
+    /**
+     * Counters since boot: appended records, programmed pages, erased
+     * sectors and failed appends
+     */
+    unsigned long appended () const;
+    unsigned long pageWrites () const;
+    unsigned long erases () const;
+    unsigned long failed () const;
+
+    /**
+     * Encode a record
+     *
+     * @param record Where to encode it (MAX_RECORD_SIZE bytes)
+     * @param frame The decoded signal
+     * @param delta Time since the previous record (in ms)
+     * @param raw Its raw timings, or nullptr
+     * @return The record size
+     */
+    static unsigned int encode (uint8_t* record, const Frame& frame, uint32_t delta, const RawCapture* raw);
+
+    /**
+     * Decode a record
+     *
+     * @param record The record
+     * @param length Its size
+     * @param frame The decoded signal (no timestamp)
+     * @param delta Time since the previous record (in ms)
+     * @param raw Its raw timings, or nullptr to skip them
+     * @return false if the record is invalid
+     */
+    static bool decode (const uint8_t* record, unsigned int length, Frame& frame, uint32_t& delta, RawCapture* raw);
+
+  private:
+    struct SectorHeader {
+      uint32_t magic;
+      uint32_t sequence;
+      uint32_t boot;
+      uint32_t time;
+    };
+
+    FlashRegion _flash;
+    TimerWheel& _timers;
+    unsigned long _flushDelay;
+    bool (*_isBusy)();
+    TimerId _flushTimer = NO_TIMER;
+    bool _flushMissed = false;
+    bool _ready = false;
+
+    unsigned int _sectors = 0;
+    unsigned int _usedSectors = 0;
+    // Newest sector, its sequence, and if records go to a new sector
+    unsigned int _head = 0;
+    uint32_t _sequence = 0;
+    bool _needSector = true;
+    uint32_t _boot = 0;
+    // Time and address of the last record of the head sector
+    uint32_t _lastTime = 0;
+    uint32_t _lastAddress = 0;
+
+    // Page being written: address, bytes buffered, bytes already programmed
+    uint8_t _page[FlashRegion::PAGE_SIZE];
+    uint32_t _pageAddress = 0;
+    unsigned int _pageLength = 0;
+    unsigned int _pageFlushed = 0;
+
+    // Record being encoded or read
+    uint8_t _record[MAX_RECORD_SIZE];
+
+    // Records waiting for the device to be free, and the raw timings of the
+    // one being written
+    uint8_t _pending[PENDING_SIZE];
+    unsigned int _pendingLength = 0;
+    unsigned int _pendingCount = 0;
+    RawCapture _pendingRaw;
+
+    unsigned long _appended = 0;
+    unsigned long _pageWrites = 0;
+    unsigned long _erases = 0;
+    unsigned long _failed = 0;
+
+    /**
+     * To know if the flash must be left alone
+     */
+    bool _busy () const;
+    /**
+     * Append a record to the flash (page, sectors)
+     */
+    bool _append (const Frame& frame, const RawCapture* raw);
+    /**
+     * To know if appending a record programs a page or erases a sector
+     */
+    bool _needsFlash (const Frame& frame, const RawCapture* raw);
+    /**
+     * Keep a record in RAM, to be written later
+     */
+    bool _defer (const Frame& frame, const RawCapture* raw);
+    /**
+     * Flush after a delay, unless a flush is already scheduled
+     */
+    void _scheduleFlush (unsigned long delay);
+    /**
+     * Erase the next sector and write its header
+     */
+    bool _startSector (uint32_t time);
+    /**
+     * Append bytes to the page (programmed when full)
+     */
+    bool _write (const uint8_t* bytes, unsigned int length);
+    /**
+     * Program the buffered bytes of the page
+     */
+    bool _flushPage ();
+    /**
+     * Read a sector header (false if not valid)
+     */
+    bool _readHeader (unsigned int sector, SectorHeader& header);
+};
+
+static_assert(CaptureLog::HEADER_SIZE + CaptureLog::MAX_RECORD_SIZE <= FlashRegion::SECTOR_SIZE, "A record fits in a sector");
+
+#endif
@@ -0,0 +1,326 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#include "CodeLibrary.h"
+#include "HeapFree.h"
+
+// "RFC1"
+static const uint32_t BANK_MAGIC = 0x31434652;
+// Levels copied at a time between flash and a waveform
+static const unsigned int LEVEL_CHUNK = 32;
+
+CodeLibrary::CodeLibrary (bool (*isBusy)()) : _isBusy(isBusy) {
+  // ...
+}
+
+bool CodeLibrary::begin (const char* storage, unsigned long offset, unsigned int sectors) {
+  _bankSize = (unsigned long)(sectors / 2) * FlashRegion::SECTOR_SIZE;
+  // Entry addresses are 16 bits
+  _ready = _bankSize > 0 && _bankSize <= 0x10000 && _flash.begin(storage, offset, 2 * _bankSize);
+  if (!_ready) {
+    return false;
+  }
+  // Active bank: highest sequence
+  bool found = false;
+  for (unsigned int bank = 0; bank < 2; bank++) {
+    BankHeader header;
+    if (_flash.read(_bankStart(bank), &header, sizeof(header)) && header.magic == BANK_MAGIC &&
+      header.layout == sizeof(EntryHeader) && (!found || (int32_t)(header.sequence - _sequence) > 0)) {
+      _bank = bank;
+      _sequence = header.sequence;
+      found = true;
+    }
+  }
+  if (!found) {
+    // New library (or written by a build with another frame layout)
+    _ready = _flash.erase(_bankStart(0), _bankSize) && _activateBank(0, 1);
+    if (!_ready) {
+      return false;
+    }
+  }
+  _buildIndex();
+  return true;
+}
+
+bool CodeLibrary::isReady () const {
+  return _ready;
+}
+
+bool CodeLibrary::save (const char* name, const Frame& frame, const Waveform& waveform, unsigned int first, unsigned int repeats) {
+  const unsigned int nameLength = strlen(name);
+  if (!_ready || _busy() || nameLength == 0 || nameLength > MAX_NAME || waveform.count > WAVEFORM_MAX_LEVELS) {
+    return false;
+  }
+  const unsigned long size = _entrySize(nameLength, waveform.count);
+  if (_end + size > _bankSize && !_compact()) {
+    return false;
+  }
+  // The replaced entry (its address may have changed with the compaction)
+  const uint16_t replaced = _lookup(name, _hash(name));
+  if ((!replaced && _count >= MAX_CODES) || _end + size > _bankSize) {
+    return false;
+  }
+
+  const uint16_t address = _end;
+  const unsigned long start = _bankStart(_bank) + address;
+  EntryHeader header;
+  memset(&header, 0, sizeof(header));
+  header.state = ENTRY_WRITING;
+  header.nameLength = nameLength;
+  header.levelCount = waveform.count;
+  header.first = first;
+  header.inverted = waveform.inverted;
+  header.repeats = repeats;
+  header.frame = frame;
+  bool written = _flash.write(start, &header, sizeof(header)) &&
+    _flash.write(start + sizeof(header), name, nameLength);
+  uint16_t levels[LEVEL_CHUNK];
+  for (unsigned int i = 0; written && i < waveform.count; i += LEVEL_CHUNK) {
+    const unsigned int count = waveform.count - i < LEVEL_CHUNK ? waveform.count - i : LEVEL_CHUNK;
+    for (unsigned int j = 0; j < count; j++) {
+      levels[j] = waveform.durations[i + j];
+    }
+    written = _flash.write(start + sizeof(header) + nameLength + i * 2, levels, count * 2);
+  }
+  // The space is used, even if the entry could not be written
+  _end += size;
+  // Committed, then the replaced entry is deleted
+  const uint8_t valid = ENTRY_VALID;
+  if (!written || !_flash.write(start, &valid, 1)) {
+    return false;
+  }
+  if (replaced) {
+    const uint8_t deleted = ENTRY_DELETED;
+    _flash.write(_bankStart(_bank) + replaced, &deleted, 1);
+  }
+  return _insert(name, address);
+}
+
+bool CodeLibrary::remove (const char* name) {
+  const uint16_t address = _ready && !_busy() ? _lookup(name, _hash(name)) : 0;
+  if (!address) {
+    return false;
+  }
+  const uint8_t deleted = ENTRY_DELETED;
+  _flash.write(_bankStart(_bank) + address, &deleted, 1);
+  // Open addressing: entries after it may have to move
+  _buildIndex();
+  return true;
+}
+
+bool CodeLibrary::find (const char* name, LibraryCode& code) {
+  const uint16_t address = _ready ? _lookup(name, _hash(name)) : 0;
+  if (!address) {
+    return false;
+  }
+  EntryHeader header;
+  if (!_readEntry(address, header, code.name)) {
+    return false;
+  }
+  code.frame = header.frame;
+  code.levelCount = header.levelCount;
+  code.first = header.first;
+  code.inverted = header.inverted;
+  code.repeats = header.repeats;
+  code.address = address;
+  return true;
+}
+
+bool CodeLibrary::load (const LibraryCode& code, Waveform& waveform) {
+  if (code.levelCount > WAVEFORM_MAX_LEVELS) {
+    return false;
+  }
+  const unsigned long levelsAddress = _bankStart(_bank) + code.address + sizeof(EntryHeader) + strlen(code.name);
+  uint16_t levels[LEVEL_CHUNK];
+  for (unsigned int i = 0; i < code.levelCount; i += LEVEL_CHUNK) {
+    const unsigned int count = code.levelCount - i < LEVEL_CHUNK ? code.levelCount - i : LEVEL_CHUNK;
+    if (!_flash.read(levelsAddress + i * 2, levels, count * 2)) {
+      return false;
+    }
+    for (unsigned int j = 0; j < count; j++) {
+      waveform.durations[i + j] = levels[j];
+    }
+  }
+  waveform.count = code.levelCount;
+  waveform.inverted = code.inverted;
+  return true;
+}
+
+bool CodeLibrary::next (unsigned int& position, LibraryCode& code) {
+  if (position == 0) {
+    position = sizeof(BankHeader);
+  }
+  while (_ready && position < _end) {
+    EntryHeader header;
+    const unsigned long address = position;
+    if (!_readEntry(address, header, code.name)) {
+      return false;
+    }
+    position += _entrySize(header.nameLength, header.levelCount);
+    // Only the indexed entry of a name (see _insert)
+    if (header.state == ENTRY_VALID && _lookup(code.name, _hash(code.name)) == address) {
+      code.frame = header.frame;
+      code.levelCount = header.levelCount;
+      code.first = header.first;
+      code.inverted = header.inverted;
+      code.repeats = header.repeats;
+      code.address = address;
+      return true;
+    }
+  }
+  return false;
+}
+
+unsigned int CodeLibrary::count () const {
+  return _count;
+}
+
+unsigned long CodeLibrary::available () const {
+  return _ready ? _bankSize - _end : 0;
+}
+
+bool CodeLibrary::_busy () const {
+  return _isBusy != nullptr && _isBusy();
+}
+
+uint32_t CodeLibrary::_hash (const char* name) {
+  uint32_t hash = 2166136261UL;
+  while (*name) {
+    hash = (hash ^ (uint8_t)*name++) * 16777619UL;
+  }
+  return hash;
+}
+
+uint16_t CodeLibrary::_lookup (const char* name, uint32_t hash) {
+  unsigned int slot = hash & (INDEX_SIZE - 1);
+  for (unsigned int n = 0; n < INDEX_SIZE; n++) {
+    const IndexSlot& entry = _index[slot];
+    if (entry.address == 0) {
+      return 0;
+    }
+    // Same hash: compare the names (a single flash read)
+    EntryHeader header;
+    char stored[MAX_NAME + 1];
+    if (entry.hash == hash && _readEntry(entry.address, header, stored) && strcmp(stored, name) == 0) {
+      return entry.address;
+    }
+    slot = (slot + 1) & (INDEX_SIZE - 1);
+  }
+  return 0;
+}
+
+bool CodeLibrary::_insert (const char* name, uint16_t address) {
+  const uint32_t hash = _hash(name);
+  unsigned int slot = hash & (INDEX_SIZE - 1);
+  for (unsigned int n = 0; n < INDEX_SIZE; n++) {
+    IndexSlot& entry = _index[slot];
+    EntryHeader header;
+    char stored[MAX_NAME + 1];
+    if (entry.address == 0) {
+      if (_count >= MAX_CODES) {
+        return false;
+      }
+      entry.hash = hash;
+      entry.address = address;
+      _count++;
+      return true;
+    }
+    if (entry.hash == hash && _readEntry(entry.address, header, stored) && strcmp(stored, name) == 0) {
+      // Newer entry of the same name
+      entry.address = address;
+      return true;
+    }
+    slot = (slot + 1) & (INDEX_SIZE - 1);
+  }
+  return false;
+}
+
+void CodeLibrary::_buildIndex () {
+  memset(_index, 0, sizeof(_index));
+  _count = 0;
+  unsigned long address = sizeof(BankHeader);
+  EntryHeader header;
+  char name[MAX_NAME + 1];
+  // Entries follow each other up to the erased space
+  while (address + sizeof(EntryHeader) <= _bankSize && _readEntry(address, header, name)) {
+    if (header.state == ENTRY_VALID) {
+      _insert(name, address);
+    }
+    address += _entrySize(header.nameLength, header.levelCount);
+  }
+  _end = address < _bankSize ? address : _bankSize;
+}
+
+bool CodeLibrary::_readEntry (unsigned long address, EntryHeader& header, char* name) {
+  if (!_flash.read(_bankStart(_bank) + address, &header, sizeof(header)) || header.nameLength == 0 ||
+    header.nameLength > MAX_NAME || header.levelCount > WAVEFORM_MAX_LEVELS ||
+    address + _entrySize(header.nameLength, header.levelCount) > _bankSize) {
+    // Erased (end of the entries) or not valid
+    return false;
+  }
+  if (!_flash.read(_bankStart(_bank) + address + sizeof(header), name, header.nameLength)) {
+    return false;
+  }
+  name[header.nameLength] = '\0';
+  return true;
+}
+
+bool CodeLibrary::_compact () {
+  const unsigned int from = _bank;
+  const unsigned int to = 1 - _bank;
+  if (!_flash.erase(_bankStart(to), _bankSize)) {
+    return false;
+  }
+  // Indexed entries only: the deleted and replaced ones are left behind
+  unsigned long address = sizeof(BankHeader);
+  for (unsigned int slot = 0; slot < INDEX_SIZE; slot++) {
+    if (_index[slot].address == 0) {
+      continue;
+    }
+    EntryHeader header;
+    char name[MAX_NAME + 1];
+    if (!_readEntry(_index[slot].address, header, name)) {
+      continue;
+    }
+    const unsigned long size = _entrySize(header.nameLength, header.levelCount);
+    uint8_t chunk[64];
+    for (unsigned long i = 0; i < size; i += sizeof(chunk)) {
+      const unsigned int count = size - i < sizeof(chunk) ? size - i : sizeof(chunk);
+      if (!_flash.read(_bankStart(from) + _index[slot].address + i, chunk, count) ||
+        !_flash.write(_bankStart(to) + address + i, chunk, count)) {
+        return false;
+      }
+    }
+    address += size;
+  }
+  // Written last: the copy is complete when it becomes the active bank
+  if (!_activateBank(to, _sequence + 1)) {
+    return false;
+  }
+  _buildIndex();
+  return true;
+}
+
+bool CodeLibrary::_activateBank (unsigned int bank, uint32_t sequence) {
+  const BankHeader header = { BANK_MAGIC, sequence, sizeof(EntryHeader) };
+  if (!_flash.write(_bankStart(bank), &header, sizeof(header))) {
+    return false;
+  }
+  _bank = bank;
+  _sequence = sequence;
+  return true;
+}
+
+unsigned long CodeLibrary::_entrySize (unsigned int nameLength, unsigned int levelCount) {
+  return (sizeof(EntryHeader) + nameLength + levelCount * 2 + 3) & ~3UL;
+}
+
+unsigned long CodeLibrary::_bankStart (unsigned int bank) const {
+  return bank * _bankSize;
+}
@@ -0,0 +1,233 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef CODE_LIBRARY_H
+#define CODE_LIBRARY_H
+
+#include <Arduino.h>
+#include "Data.h"
+#include "Waveform.h"
+#include "FlashRegion.h"
+
+// Code library ("LIB" and "SEND <name>" commands): named codes, stored in
+// flash with their waveform, ready to be sent.
+//
+// The region is made of two banks: codes are appended to the active bank.
+// When it is full, the codes are copied to the other bank (without the
+// deleted and replaced ones), which becomes the active one.
+//
+// Bank: header | entries | erased (0xFF)
+//   header : magic "RFC1" (4) | sequence (4) | entry layout (4, size of the entry header)
+// The active bank is the valid one with the highest sequence.
+//
+// Entry (4 bytes aligned): EntryHeader | name | levels (2 bytes each, in microseconds)
+// An entry is written with state ENTRY_WRITING, then committed
+// (ENTRY_VALID). Deleting it only clears its state (ENTRY_DELETED).
+//
+// A hash index of the names (open addressing, in RAM) is built when the
+// library is opened: a name is found with a single flash read.
+//
+// As for the capture log, nothing is programmed or erased while the device
+// is busy (see the constructor): save and remove are refused.
+
+/**
+ * A code of the library
+ */
+struct LibraryCode {
+  // As typed (case sensitive), null terminated (CodeLibrary::MAX_NAME characters at most)
+  char name[17];
+  // The code, as decoded or typed (timestamp: when it was saved)
+  Frame frame;
+  // Waveform: number of levels, first level played, first level low
+  uint16_t levelCount;
+  uint8_t first;
+  bool inverted;
+  // Frames sent by "SEND <name>"
+  uint8_t repeats;
+  // Where it is stored
+  uint16_t address;
+};
+
+/**
+ * CodeLibrary class
+ *
+ * Named codes in flash with a RAM hash index (see above). Nothing is
+ * allocated.
+ */
+class CodeLibrary {
+  public:
+    /**
+     * Maximum length of a name
+     */
+    static const unsigned int MAX_NAME = 16;
+    /**
+     * Maximum number of codes
+     */
+    static const unsigned int MAX_CODES = 64;
+
+    /**
+     * Constructor
+     *
+     * @param isBusy To know if the flash must be left alone (e.g. while transmitting), or nullptr
+     */
+    CodeLibrary (bool (*isBusy)() = nullptr);
+
+    /**
+     * Open the library and build its index
+     *
+     * @param storage The partition label (ESP32) or the file path (host build)
+     * @param offset The start of the library in the storage (multiple of FlashRegion::SECTOR_SIZE)
+     * @param sectors The number of sectors (even: two banks)
+     * @return false if the storage is not available
+     */
+    bool begin (const char* storage, unsigned long offset, unsigned int sectors);
+
+    /**
+     * To know if the library is available
+     */
+    bool isReady () const;
+
+    /**
+     * Save a code (replaces the code of the same name)
+     *
+     * @param name The name (MAX_NAME characters at most)
+     * @param frame The code
+     * @param waveform Its waveform
+     * @param first The first level played (see Transmitter::play)
+     * @param repeats The number of frames sent
+     * @return false if the library is full, or if the device is busy
+     */
+    bool save (const char* name, const Frame& frame, const Waveform& waveform, unsigned int first, unsigned int repeats);
+
+    /**
+     * Delete a code
+     *
+     * @return false if not found, or if the device is busy
+     */
+    bool remove (const char* name);
+
+    /**
+     * Find a code by name
+     *
+     * @param name The name
+     * @param code The code found
+     * @return false if not found
+     */
+    bool find (const char* name, LibraryCode& code);
+
+    /**
+     * Read the waveform of a code
+     *
+     * @param code The code (see find)
+     * @param waveform The waveform to fill
+     */
+    bool load (const LibraryCode& code, Waveform& waveform);
+
+    /**
+     * Iterate over the codes
+     *
+     * @param position Start with 0
+     * @param code The next code
+     * @return false when there is no more code
+     */
+    bool next (unsigned int& position, LibraryCode& code);
+
+    /**
+     * Number of codes, and bytes left in the active bank
+     */
+    unsigned int count () const;
+    unsigned long available () const;
+
+  private:
+    static const uint8_t ENTRY_WRITING = 0xFF;
+    static const uint8_t ENTRY_VALID = 0x0F;
+    static const uint8_t ENTRY_DELETED = 0x00;
+    // Index size (power of 2): at most half full
+    static const unsigned int INDEX_SIZE = 2 * MAX_CODES;
+
+    struct BankHeader {
+      uint32_t magic;
+      uint32_t sequence;
+      uint32_t layout;
+    };
+
+    struct EntryHeader {
+      uint8_t state;
+      uint8_t nameLength;
+      uint16_t levelCount;
+      uint8_t first;
+      uint8_t inverted;
+      uint8_t repeats;
+      uint8_t reserved;
+      Frame frame;
+    };
+
+    struct IndexSlot {
+      // Hash of the name
+      uint32_t hash;
+      // Entry address in the bank, 0 if the slot is empty
+      uint16_t address;
+    };
+
+    FlashRegion _flash;
+    bool (*_isBusy)();
+    bool _ready = false;
+    unsigned long _bankSize = 0;
+    // Active bank, its sequence, and where the next entry goes
+    unsigned int _bank = 0;
+    uint32_t _sequence = 0;
+    unsigned long _end = 0;
+    unsigned int _count = 0;
+    IndexSlot _index[INDEX_SIZE];
+
+    /**
+     * To know if the device is busy (see the constructor)
+     */
+    bool _busy () const;
+    /**
+     * Hash of a name (FNV-1a)
+     */
+    static uint32_t _hash (const char* name);
+    /**
+     * Entry address of a name in the active bank, 0 if not found
+     */
+    uint16_t _lookup (const char* name, uint32_t hash);
+    /**
+     * Index an entry (replaces the entry of the same name)
+     */
+    bool _insert (const char* name, uint16_t address);
+    /**
+     * Scan the active bank: index its valid entries, find its end
+     */
+    void _buildIndex ();
+    /**
+     * Read an entry (header and name)
+     */
+    bool _readEntry (unsigned long address, EntryHeader& header, char* name);
+    /**
+     * Copy the valid entries to the other bank, which becomes active
+     */
+    bool _compact ();
+    /**
+     * Write the header of an erased bank: it becomes the active one
+     */
+    bool _activateBank (unsigned int bank, uint32_t sequence);
+    /**
+     * Size of an entry (4 bytes aligned)
+     */
+    static unsigned long _entrySize (unsigned int nameLength, unsigned int levelCount);
+    /**
+     * Bank start in the region
+     */
+    unsigned long _bankStart (unsigned int bank) const;
+};
+
+static_assert((2 * CodeLibrary::MAX_CODES & (2 * CodeLibrary::MAX_CODES - 1)) == 0, "The index size is a power of 2");
+
+#endif
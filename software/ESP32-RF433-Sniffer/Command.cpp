@@ -0,0 +1,161 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#include "Command.h"
+#include "HeapFree.h"
+
+bool Token::equals (const char* keyword) const {
+  return strcmp(str, keyword) == 0;
+}
+
+bool Command::parse (char* line) {
+  _count = 0;
+  _overflow = false;
+  _errorIndex = 0;
+
+  char* c = line;
+  while (*c != '\0') {
+    // Skip separators
+    while (*c == ' ' || *c == '\t') {
+      *c++ = '\0';
+    }
+    if (*c == '\0') {
+      break;
+    }
+
+    char* start = c;
+    while (*c != '\0' && *c != ' ' && *c != '\t') {
+      if (*c >= 'a' && *c <= 'z') {
+        *c -= 'a' - 'A';
+      }
+      c++;
+    }
+
+    if (_count < MAX_TOKENS) {
+      _tokens[_count].str = start;
+      _tokens[_count].length = c - start;
+      _count++;
+    } else {
+      _overflow = true;
+    }
+  }
+
+  return _count > 0;
+}
+
+unsigned int Command::count () const {
+  return _count;
+}
+
+Token Command::token (unsigned int index) const {
+  if (index < _count) {
+    return _tokens[index];
+  }
+  return { "", 0 };
+}
+
+bool Command::is (const char* keyword) const {
+  return _count > 0 && _tokens[0].equals(keyword);
+}
+
+ParseResult Command::expect (unsigned int min, unsigned int max) const {
+  if (_count < min) {
+    _errorIndex = _count;
+    return PARSE_MISSING_ARGUMENT;
+  }
+  if (_count > max || _overflow) {
+    _errorIndex = max;
+    return PARSE_TOO_MANY_ARGUMENTS;
+  }
+  return PARSE_OK;
+}
+
+ParseResult Command::number (unsigned int index, unsigned long min, unsigned long max, unsigned long& value) const {
+  _errorIndex = index;
+  if (index >= _count) {
+    return PARSE_MISSING_ARGUMENT;
+  }
+
+  const Token& token = _tokens[index];
+  unsigned long result = 0;
+  for (unsigned int i = 0; i < token.length; i++) {
+    char c = token.str[i];
+    if (c < '0' || c > '9') {
+      return PARSE_INVALID_NUMBER;
+    }
+    unsigned long digit = c - '0';
+    // result * 10 + digit > max, without overflowing
+    if (result > max / 10 || digit > max - result * 10) {
+      return PARSE_OUT_OF_RANGE;
+    }
+    result = result * 10 + digit;
+  }
+
+  if (result < min) {
+    return PARSE_OUT_OF_RANGE;
+  }
+  value = result;
+  return PARSE_OK;
+}
+
+unsigned int Command::errorIndex () const {
+  return _errorIndex;
+}
+
+void Command::printError (ParseResult result) const {
+  Serial.print(F("ERROR: "));
+  switch (result) {
+    case PARSE_OK:
+      Serial.print(F("no error"));
+      break;
+    case PARSE_MISSING_ARGUMENT:
+      Serial.print(F("missing argument"));
+      break;
+    case PARSE_TOO_MANY_ARGUMENTS:
+      Serial.print(F("too many arguments"));
+      break;
+    case PARSE_INVALID_NUMBER:
+      Serial.print(F("invalid number"));
+      break;
+    case PARSE_OUT_OF_RANGE:
+      Serial.print(F("value out of range"));
+      break;
+  }
+  if (result != PARSE_OK && _errorIndex < _count) {
+    Serial.print(F(": ")); Serial.print(_tokens[_errorIndex].str);
+  } else if (result == PARSE_MISSING_ARGUMENT) {
+    Serial.print(F(" #")); Serial.print(_errorIndex);
+  }
+  Serial.println(F(". Type ? to show help."));
+}
+
+void Command::printTerseError (ParseResult result, Print& out) const {
+  out.print(F("ERR "));
+  switch (result) {
+    case PARSE_OK:
+      out.print(F("NONE"));
+      break;
+    case PARSE_MISSING_ARGUMENT:
+      out.print(F("MISSING"));
+      break;
+    case PARSE_TOO_MANY_ARGUMENTS:
+      out.print(F("ARGS"));
+      break;
+    case PARSE_INVALID_NUMBER:
+      out.print(F("NUMBER"));
+      break;
+    case PARSE_OUT_OF_RANGE:
+      out.print(F("RANGE"));
+      break;
+  }
+  if (result != PARSE_OK && result != PARSE_MISSING_ARGUMENT && _errorIndex < _count) {
+    out.print(F(" ")); out.print(_tokens[_errorIndex].str);
+  }
+  out.println();
+}
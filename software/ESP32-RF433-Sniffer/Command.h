@@ -0,0 +1,122 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <Arduino.h>
+
+/**
+ * Result of a command parsing
+ */
+enum ParseResult {
+  PARSE_OK,
+  PARSE_MISSING_ARGUMENT,
+  PARSE_TOO_MANY_ARGUMENTS,
+  PARSE_INVALID_NUMBER,
+  PARSE_OUT_OF_RANGE
+};
+
+/**
+ * A token of the command line: points into the line buffer (no copy)
+ */
+struct Token {
+  // Null terminated
+  const char* str;
+  unsigned int length;
+
+  /**
+   * Compare with an (uppercase) keyword
+   */
+  bool equals (const char* keyword) const;
+};
+
+/**
+ * Command class
+ *
+ * Splits a command line in place (no allocation): separators are replaced
+ * by '\0' and letters are uppercased, tokens point into the line.
+ * The line must live as long as the command is used.
+ */
+class Command {
+  public:
+    /**
+     * Maximum number of tokens (keyword included): "LIB ADD <name> TX2"
+     * and its 6 arguments
+     */
+    static const unsigned int MAX_TOKENS = 10;
+
+    /**
+     * Split a line (modified in place)
+     *
+     * @param line The null terminated line
+     * @return false if the line is empty
+     */
+    bool parse (char* line);
+
+    /**
+     * Number of tokens
+     */
+    unsigned int count () const;
+
+    /**
+     * Get a token. Out of range index returns an empty token
+     */
+    Token token (unsigned int index) const;
+
+    /**
+     * To know if the first token is the given (uppercase) keyword
+     */
+    bool is (const char* keyword) const;
+
+    /**
+     * Check the number of tokens
+     *
+     * @param min Minimum number of tokens
+     * @param max Maximum number of tokens
+     */
+    ParseResult expect (unsigned int min, unsigned int max) const;
+
+    /**
+     * Strictly parse a decimal token (digits only, no overflow)
+     *
+     * @param index The token index
+     * @param min The minimum accepted value
+     * @param max The maximum accepted value
+     * @param value The parsed value (unchanged on error)
+     */
+    ParseResult number (unsigned int index, unsigned long min, unsigned long max, unsigned long& value) const;
+
+    /**
+     * Index of the token that caused the last error
+     */
+    unsigned int errorIndex () const;
+
+    /**
+     * Print "ERROR: ..." for a parse result
+     */
+    void printError (ParseResult result) const;
+
+    /**
+     * Print a one line machine readable error: "ERR <reason> [<token>]"
+     *
+     * @param out Where to print it (Serial, or the binary replies)
+     */
+    void printTerseError (ParseResult result, Print& out = Serial) const;
+
+  private:
+    Token _tokens[MAX_TOKENS];
+    unsigned int _count = 0;
+    // More tokens than MAX_TOKENS
+    bool _overflow = false;
+    // Set by const checks
+    mutable unsigned int _errorIndex = 0;
+};
+
+#endif
@@ -11,6 +11,7 @@
 #define CONFIG_H
 
 #include "RGBCC.h"
+#include "OutputQueue.h"
 
 // You can adapt these values to fill your needs
 
@@ -19,6 +20,85 @@
 const int RX_PIN = 27;
 const int TX_PIN = 14;
 
+// Number of times a frame is repeated by one transmission
+// (same as RCSwitch and NewRemoteTransmitter defaults)
+const unsigned int TYPE1_REPEAT_TRANSMIT = 10;
+const unsigned int TYPE2_REPEAT_TRANSMIT = 16;
+
+// Keep the receiver listening while transmitting (of the same type)
+const bool RECEIVE_WHILE_TRANSMITTING = true;
+// How long our own signal is recognized after being sent (in ms)
+const unsigned long ECHO_WINDOW = 500;
+// Our own signals are tagged as "ECHO" when decoded. Set to true to hide them
+// (not printed, in any output mode, and not logged).
+const bool ECHO_SUPPRESS = false;
+
+// Default number of frames of the loopback self-test ("TEST" command)
+const unsigned long LOOPBACK_DEFAULT_FRAMES = 1300;
+// Default number of iterations of the benchmark ("BENCH" command)
+const unsigned long BENCHMARK_DEFAULT_ITERATIONS = 100000;
+
+// Tasks: edges are decoded on core 0 (highest priority). Signals are sent on
+// core 1, above the "loop" (CLI, serial output, led): the decoding never
+// preempts a waveform, and the "loop" runs while the transmitter sleeps
+// (sync gaps, see Gpio.h) or rests between repeats
+const int DECODE_TASK_CORE = 0;
+const unsigned int DECODE_TASK_PRIORITY = 3;
+const int TRANSMIT_TASK_CORE = 1;
+const unsigned int TRANSMIT_TASK_PRIORITY = 2;
+// Longest busy time of the transmit task (in ms) when its waveform has no
+// level long enough to sleep in: it rests a tick between bursts of repeats
+const unsigned long TRANSMIT_MAX_BUSY = 100;
+// Queue sizes: received edges, decoded signals, signals to send
+const unsigned int EDGE_QUEUE_SIZE = 256;
+const unsigned int FRAME_QUEUE_SIZE = 8;
+const unsigned int TRANSMIT_QUEUE_SIZE = 2;
+
+// The longest type 1 frame is RCSWITCH_MAX_BITS long (RCSwitch.h, 128 bits by
+// default, set for the build). Each bit costs about 4 bytes per timing
+// buffer: RCSwitch (2 buffers), raw captures (FRAME_QUEUE_SIZE + 2), waveform
+// and formatter buffers.
+
+// Capture log ("LOG" command): decoded signals are also stored in flash, in
+// a ring of CAPTURE_LOG_SECTORS sectors of 4 KB (see CaptureLog.h), at the
+// start of the data partition CAPTURE_LOG_STORAGE (the "spiffs" partition
+// of the default partition scheme). On a host build, it is a plain file.
+const bool CAPTURE_LOG_ENABLED = true;
+#ifdef ARDUINO_ARCH_ESP32
+const char* const CAPTURE_LOG_STORAGE = "spiffs";
+#else
+const char* const CAPTURE_LOG_STORAGE = "capture-log.bin";
+#endif
+const unsigned int CAPTURE_LOG_SECTORS = 64;
+// Also store the raw timings of type 1 signals (1 or 2 bytes per timing)
+const bool CAPTURE_LOG_RAW = true;
+// Records are written by pages of 256 bytes: a page not full yet is written
+// when nothing has been received for this delay (in ms). Flash writes stall
+// both cores (a page: under 1 ms, a sector erase: about 50 ms, once every
+// 4 KB of records).
+const unsigned long CAPTURE_LOG_FLUSH_DELAY = 2000;
+
+// Code library ("LIB" and "SEND <name>" commands): named codes with their
+// waveform, in CODE_LIBRARY_SECTORS sectors of the same partition, after the
+// capture log (two banks, see CodeLibrary.h)
+const unsigned int CODE_LIBRARY_SECTORS = 8;
+
+// A "loop" iteration longer than this is recorded as a stall (in microseconds)
+const unsigned long STALL_THRESHOLD = 20000;
+
+// Serial output queue: the "loop" never waits for the serial port.
+// When the host reads too slowly, OUTPUT_POLICY applies (see OutputQueue.h):
+// OUTPUT_DROP_OLDEST, OUTPUT_DROP_RAW or OUTPUT_COALESCE
+const OutputPolicy OUTPUT_POLICY = OUTPUT_DROP_OLDEST;
+// Size of the queue (in bytes) and maximum number of queued frames
+const unsigned int OUTPUT_QUEUE_SIZE = 4096;
+const unsigned int OUTPUT_QUEUE_FRAMES = 16;
+
+// Heap-free build: everything is allocated statically, nothing on the heap
+// after startup (the device runs for months: no fragmentation). The sketch
+// fails to compile if it calls the allocator. Set to 0 to disable.
+#define HEAP_FREE_BUILD 1
+
 // Define the serial connection baud rate
 const int SERIAL_BAUDRATE = 115200;
 
@@ -11,19 +11,19 @@
 #define DATA_H
 
 #include <Arduino.h>
+#include <RCSwitch.h>
 #include <NewRemoteReceiver.h>
+#include <type_traits>
 
 /**
- * Data structure for type 1 ("old style" with RCSwitch)
+ * Data structure for type 1 ("old style" with RCSwitch).
+ * A value: binary and tri-state are rendered on output.
  */
 struct Type1Data {
   unsigned long decimal;
   unsigned int length;
   unsigned int delay;
-  unsigned int* raw;
   unsigned int protocol;
-  char* bin;
-  const char* triState;
 
   // Clear data
   void clear() {
@@ -31,6 +31,20 @@ struct Type1Data {
   }
 };
 
+static_assert(std::is_trivially_copyable<Type1Data>::value, "Type1Data is copied between frames");
+
+/**
+ * Data structure for a raw replay of type 1 timings (as captured by RCSwitch)
+ */
+struct RawReplayData {
+  // Points to a snapshot of the captured timings (replayedRaw): the capture
+  // slots and the last type 1 timings are overwritten by new signals
+  const uint16_t* raw;
+  unsigned int changeCount;
+  unsigned int scale;
+  bool inverted;
+};
+
 /**
  * Data structure for type 2 ("new style" with NewRemoteSwitch)
  */
@@ -41,4 +55,110 @@ struct Type2Data : NewRemoteCode {
   }
 };
 
+/**
+ * Decoder of a frame
+ */
+enum FrameDecoder {
+  FRAME_TYPE1 = 1,
+  FRAME_TYPE2 = 2
+};
+
+/**
+ * Frame sources
+ */
+const uint8_t FRAME_SOURCE_RADIO = 0;
+
+/**
+ * Frame flags
+ */
+// Our own transmission (see EchoFilter)
+const uint8_t FRAME_FLAG_ECHO = 0x01;
+// Raw timings have been captured (see RawCapture)
+const uint8_t FRAME_FLAG_RAW = 0x02;
+// Type 2: the dim level is present
+const uint8_t FRAME_FLAG_DIM_LEVEL = 0x04;
+
+/**
+ * Payload words of a frame: the longest type 1 frame, and at least the
+ * 37 bits of a type 2 frame
+ */
+const unsigned int FRAME_PAYLOAD_WORDS = RCSWITCH_MAX_WORDS > 2 ? RCSWITCH_MAX_WORDS : 2;
+const unsigned int FRAME_MAX_BITS = FRAME_PAYLOAD_WORDS * 32;
+
+static_assert(RCSWITCH_MAX_BITS <= 255, "A bit length is stored on 8 bits (Frame, capture log records)");
+
+/**
+ * A decoded signal, whatever its decoder: a fixed size record passed from
+ * the decode task to the "loop", then filtered, logged and queued with a
+ * single code path.
+ *
+ * The payload is packed in 32 bits words, least significant word first.
+ * Type 1 payload: the code (bitLength bits, up to RCSWITCH_MAX_BITS).
+ * Type 2 payload: address (26 bits) | group bit | switch type (2 bits) | unit (4 bits) | dim level (4 bits)
+ */
+struct Frame {
+  uint32_t payload[FRAME_PAYLOAD_WORDS];
+  // When it was decoded (millis)
+  uint32_t timestamp;
+  // Pulse length (type 1) or period (type 2), in microseconds
+  uint16_t period;
+  uint8_t source;
+  uint8_t decoder;
+  // Type 1 protocol, 0 for type 2
+  uint8_t protocol;
+  // Type 1 bit length, type 2: 32 bits (36 with dim level)
+  uint8_t bitLength;
+  uint8_t flags;
+  // Slot of the raw timings (see FRAME_FLAG_RAW)
+  uint8_t rawSlot;
+
+  // The 64 least significant bits of the payload
+  uint64_t low64 () const { return payload[0] | ((uint64_t)payload[1] << 32); }
+
+  // Type 2 fields
+  unsigned long address () const { return low64() >> 11; }
+  bool groupBit () const { return (payload[0] >> 10) & 1; }
+  unsigned int switchType () const { return (payload[0] >> 8) & 0x3; }
+  unsigned int unit () const { return (payload[0] >> 4) & 0xF; }
+  unsigned int dimLevel () const { return payload[0] & 0xF; }
+  bool dimLevelPresent () const { return flags & FRAME_FLAG_DIM_LEVEL; }
+  bool isEcho () const { return flags & FRAME_FLAG_ECHO; }
+};
+
+static_assert(std::is_trivially_copyable<Frame>::value && sizeof(Frame) <= 12 + FRAME_PAYLOAD_WORDS * 4, "Frame is a compact record");
+
+/**
+ * Raw timings of a type 1 frame: sync, 2 per bit, last pulse
+ */
+struct RawCapture {
+  uint16_t count;
+  uint16_t timings[RCSWITCH_MAX_CHANGES];
+};
+
+/**
+ * Create a frame (not decoded yet: no timestamp, no raw timings)
+ */
+inline Frame createFrame (const Type1Data& data) {
+  Frame frame = {};
+  frame.decoder = FRAME_TYPE1;
+  frame.payload[0] = data.decimal;
+  frame.period = data.delay;
+  frame.protocol = data.protocol;
+  frame.bitLength = data.length;
+  return frame;
+}
+
+inline Frame createFrame (const Type2Data& data) {
+  Frame frame = {};
+  frame.decoder = FRAME_TYPE2;
+  const uint64_t payload = ((uint64_t)(data.address & 0x3FFFFFF) << 11) | ((uint64_t)data.groupBit << 10) |
+    ((data.switchType & 0x3) << 8) | ((data.unit & 0xF) << 4) | (data.dimLevel & 0xF);
+  frame.payload[0] = payload;
+  frame.payload[1] = payload >> 32;
+  frame.period = data.period;
+  frame.bitLength = data.dimLevelPresent ? 36 : 32;
+  frame.flags = data.dimLevelPresent ? FRAME_FLAG_DIM_LEVEL : 0;
+  return frame;
+}
+
 #endif
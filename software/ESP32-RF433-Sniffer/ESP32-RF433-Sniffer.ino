@@ -9,28 +9,87 @@
 
 #include <RCSwitch.h>
 #include <NewRemoteReceiver.h>
-#include <NewRemoteTransmitter.h>
 #include "Config.h"
 #include "Utils.h"
 #include "Data.h"
 #include "CLI.h"
+#include "Command.h"
 #include "Led.h"
+#include "TimerWheel.h"
+#include "EchoFilter.h"
+#include "TaskGraph.h"
+#include "Waveform.h"
+#include "SelfTest.h"
+#include "Stats.h"
+#include "Formatter.h"
+#include "OutputQueue.h"
+#include "BinaryOutput.h"
+#include "WatchList.h"
+#include "CaptureLog.h"
+#include "CodeLibrary.h"
+#include "LogIndex.h"
+#include "HeapFree.h"
 
 // Create a RCSwitch instance
 RCSwitch rcSwitch = RCSwitch();
 
-// Create instance type 1 data
-Type1Data t1Data;
-// Create instance type 2 data
-Type2Data t2Data;
-// Flag for type 2 data availability
-bool type2DataAvailable = false;
+// Raw timings of the last decoded type 1 signal, and the signal (for raw replay)
+RawCapture lastType1Raw;
+Frame lastType1Frame = {};
+// Timings being replayed, and their signal (new signals may be decoded meanwhile)
+RawCapture replayedRaw;
+Frame replayedFrame = {};
+// Timings read from the capture log
+RawCapture loggedRaw;
+// Last decoded signal (for "LIB SAVE")
+Frame lastFrame = {};
+
+// Timers of the led, repeater and echo filter (run in the "loop")
+TimerWheel timers;
+
+// Recognize our own signals when the receiver listens while transmitting
+EchoFilter echoFilter = EchoFilter(ECHO_WINDOW, timers);
+
+// Decoded signals are also stored in flash ("LOG" command), never while
+// transmitting (a flash operation would stall the transmit task) nor while
+// the log is read (see isLogBusy)
+CaptureLog captureLog = CaptureLog(timers, CAPTURE_LOG_FLUSH_DELAY, isLogBusy);
+// A log read (LOG DUMP, TAIL or PROTO) is in progress (see handleBetweenRecords)
+bool logReading = false;
+// Indexes of the log ("LOG LAST", "LOG PROTO" and "LOG TOP" commands)
+LogIndex logIndex = LogIndex(captureLog);
+static_assert(CAPTURE_LOG_SECTORS <= LogIndex::MAX_SECTORS, "The whole capture log is indexed");
+
+// Named codes ready to be sent ("LIB" and "SEND <name>" commands), never
+// written while transmitting
+CodeLibrary codeLibrary = CodeLibrary(isTransmitting);
 
 // Init RGB led
-Led rgbLed = Led(new RGBCC(RGB_LED_RED_PIN, RGB_LED_GREEN_PIN, RGB_LED_BLUE_PIN));
+RGBCC rgbLedPins = RGBCC(RGB_LED_RED_PIN, RGB_LED_GREEN_PIN, RGB_LED_BLUE_PIN);
+Led rgbLed = Led(&rgbLedPins, timers);
 
 // Init transmitter repeater
-Repeater transmitRepeater = Repeater();
+Repeater transmitRepeater = Repeater(timers);
+
+// Signal being prepared for the transmit task
+TransmitJob transmitJob;
+
+// Last user command
+Command command;
+
+// Decoded signals are rendered here, then queued for the serial port
+Formatter output;
+OutputQueue<OUTPUT_QUEUE_SIZE, OUTPUT_QUEUE_FRAMES> serialOutput = OutputQueue<OUTPUT_QUEUE_SIZE, OUTPUT_QUEUE_FRAMES>(OUTPUT_POLICY);
+
+// Signals of interest ("FILTER" command)
+WatchList watchList;
+
+// Binary output ("BIN" command): records and command replies
+RecordWriter records;
+ReplyRecords replyRecords = ReplyRecords(records, queueRecord);
+
+// "loop" latency and stalls ("STATS" command)
+LoopStats loopStats = LoopStats(STALL_THRESHOLD, timers);
 
 /**
  * Setup function
@@ -39,11 +98,21 @@ Repeater transmitRepeater = Repeater();
 void setup () {
   // Set baudrate for serial connection
   Serial.begin(SERIAL_BAUDRATE);
-  // Reduce serial timeout for Serial.readStringUntil method (default is 1000)
-  Serial.setTimeout(100);
   // Arbitrary delay for PuTTY like tools
   delay(1000);
 
+  // Decode and transmit tasks (see TaskGraph.h)
+  startTaskGraph(rcSwitch);
+
+  if (CAPTURE_LOG_ENABLED && !captureLog.begin(CAPTURE_LOG_STORAGE, CAPTURE_LOG_SECTORS)) {
+    Serial.println(F("Capture log not available (data partition not found)"));
+  }
+  // Reads the whole log once
+  logIndex.begin();
+  if (!codeLibrary.begin(CAPTURE_LOG_STORAGE, (unsigned long)CAPTURE_LOG_SECTORS * FlashRegion::SECTOR_SIZE, CODE_LIBRARY_SECTORS)) {
+    Serial.println(F("Code library not available (data partition not found)"));
+  }
+
   CLI::printHeader();
   CLI::printMenu();
   CLI::printPromptPrefix();
@@ -57,69 +126,182 @@ void setup () {
  * See https://docs.arduino.cc/language-reference/en/structure/sketch/loop/
  */
 void loop () {
-  // Always update led and repeater
+  loopStats.beginLoop();
+
+  // Always update led and timers (led timeouts, repeater...)
+  loopStats.begin(SECTION_LED);
   rgbLed.update();
-  transmitRepeater.update();
+  loopStats.end();
+  loopStats.begin(SECTION_TIMERS);
+  timers.update();
+  loopStats.end();
 
-  // Try to read serial command
-  String input = readSerialCommand();
+  // Try to read serial command (split in place, no allocation)
+  loopStats.begin(SECTION_SERIAL_INPUT);
+  // In binary output, a line too long is a reply record
+  char* line = readSerialCommand(CLI::reply(), CLI::binaryOutput);
+  bool hasCommand = line != nullptr && command.parse(line);
+  loopStats.end();
 
+  loopStats.begin(SECTION_COMMAND);
+  // Replies come after the queued signals
+  if (hasCommand) {
+    serialOutput.drainAll(Serial);
+  }
   // If transmitter is currently sending signals
   if (transmitRepeater.isRunning()) {
-    if (input.length() > 0 && CLI::handleQuitCommand(input)) {
+    if (hasCommand && CLI::handleQuitCommand(command)) {
       transmitRepeater.stop();
+    } else if (hasCommand) {
+      // One-shot commands reply "ERR BUSY"
+      CLI::handleOneShotCommand(command);
     }
-  } else {
+  } else if (hasCommand) {
     // Handle user command
-    if (input.length() > 0) {
-      CLI::handleSerialCommands(input);
-    }
+    CLI::handleSerialCommands(command);
+  }
+  loopStats.end();
 
-    // Type 1 data available
-    if (CLI::currentType == OLD_STYLE && rcSwitch.available()) {
-      rgbLed.receivingState();
-      rgbLed.setTimeout([]() {
-        refreshLedState();
-      }, 400 /* duration of receivingState */);
-      // Get data
-      t1Data = createData(
-        rcSwitch.getReceivedValue(), // decimal
-        rcSwitch.getReceivedProtocol(), // protocol
-        rcSwitch.getReceivedDelay(), // delay
-        rcSwitch.getReceivedBitlength(), // length
-        rcSwitch.getReceivedRawdata() // raw
-      );
-      // Show data
-      Serial.println(F("\r\n------------ DECODED SIGNAL ------------"));
-      logData(t1Data);
-      Serial.println(F("----------------------------------------"));
-
-      rcSwitch.resetAvailable();
-      // Always clear data
-      t1Data.clear();
-
-      CLI::printPromptPrefix();
-    }
-
-    // Type 2 data available
-    if (CLI::currentType == NEW_STYLE && type2DataAvailable) {
-      rgbLed.receivingState();
-      rgbLed.setTimeout([]() {
-        refreshLedState();
-      }, 400 /* duration of receivingState */);
-      // Show data
-      Serial.println(F("\r\n------------ DECODED SIGNAL ------------"));
-      logData(t2Data);
-      Serial.println(F("----------------------------------------"));
+  // Note: the receiver is also listening in transmit mode (see RECEIVE_WHILE_TRANSMITTING)
+
+  // Signals decoded by the decode task
+  loopStats.begin(SECTION_OUTPUT);
+  handleDecodedSignals();
+  // Never waits for the serial port
+  serialOutput.drain(Serial);
+  loopStats.end();
 
-      type2DataAvailable = false;
-      // Always clear data
-      t2Data.clear();
+  loopStats.endLoop();
+}
 
-      CLI::printPromptPrefix();
+/**
+ * Handle the signals decoded by the decode task: filtered, logged and
+ * printed. Records that waited for the end of a transmission are logged
+ * first.
+ */
+void handleDecodedSignals () {
+  loopStats.begin(SECTION_LOG);
+  logIndex.update();
+  loopStats.end();
+  Frame frame;
+  while (frameQueue.pop(frame, 0)) {
+    // Decoded before the receiver was stopped
+    if (CLI::currentType == NONE_TYPE) {
+      continue;
+    }
+    // Filtered out before any formatting
+    if (!watchList.accepts(frame)) {
+      continue;
+    }
+    if (echoFilter.isEcho(frame)) {
+      // Hidden: neither printed (whatever the output mode) nor logged
+      if (ECHO_SUPPRESS) {
+        continue;
+      }
+      frame.flags |= FRAME_FLAG_ECHO;
+    }
+    if (frame.decoder == FRAME_TYPE1) {
+      // The slot is reused by the decode task: copy it now
+      const RawCapture* raw = rawCapture(frame);
+      if (raw) {
+        lastType1Raw = *raw;
+        lastType1Frame = frame;
+      }
     }
+    lastFrame = frame;
+    loopStats.begin(SECTION_LOG);
+    const bool withRaw = CAPTURE_LOG_RAW && frame.decoder == FRAME_TYPE1 && (frame.flags & FRAME_FLAG_RAW);
+    logIndex.append(frame, withRaw ? &lastType1Raw : nullptr);
+    loopStats.end();
+    printDecodedSignal(frame);
   }
+}
 
+/**
+ * To know if the capture log flash must be left alone: while transmitting,
+ * and while the log is read (a new sector would erase the oldest one, under
+ * the read cursor). The records wait in RAM meanwhile (see CaptureLog).
+ */
+bool isLogBusy () {
+  return isTransmitting() || logReading;
+}
+
+/**
+ * Between two records of a long reply (log reads): the timers and the
+ * decoded signals are handled as in the "loop", so that they are not held
+ * up by the reply. Set logReading around the read: the signals are logged
+ * once it is done.
+ */
+void handleBetweenRecords () {
+  timers.update();
+  handleDecodedSignals();
+}
+
+/**
+ * Print a decoded signal, and show it on the led
+ */
+void printDecodedSignal (const Frame& frame) {
+  // Whatever the output mode. Keep the sending led effect while the repeater
+  // is running (echoes are decoded)
+  if (!transmitRepeater.isRunning()) {
+    rgbLed.receivingState();
+    rgbLed.setTimeout([]() {
+      refreshLedState();
+    }, 400 /* duration of receivingState */);
+  }
+  const RawCapture* raw = frame.decoder == FRAME_TYPE1 ? &lastType1Raw : nullptr;
+  if (CLI::binaryOutput) {
+    logDataRecord(output, records, frame, raw);
+    serialOutput.push(output, outputKey(frame));
+  } else if (CLI::terseOutput) {
+    logDataLine(output, frame);
+    serialOutput.push(output, outputKey(frame));
+  } else {
+    printDecodedSignalHeader(frame.isEcho());
+    logData(output, frame, raw);
+    output.println(F("----------------------------------------"));
+    CLI::printPromptPrefix(output);
+    serialOutput.push(output, outputKey(frame));
+  }
+}
+
+/**
+ * Queue a rendered binary record
+ */
+void queueRecord (Formatter& out) {
+  serialOutput.push(out);
+}
+
+Print& CLI::reply () {
+  if (binaryOutput) {
+    return replyRecords;
+  }
+  return Serial;
+}
+
+/**
+ * Identifies a decoded signal for OUTPUT_COALESCE (raw timings excluded)
+ */
+uint32_t outputKey (const Frame& frame) {
+  uint32_t code = 0;
+  for (unsigned int i = 0; i < FRAME_PAYLOAD_WORDS; i++) {
+    code = (code ^ frame.payload[i]) * 2654435761UL;
+  }
+  return code ^ (frame.bitLength << 24) ^ (frame.protocol << 16) ^
+    ((frame.flags & FRAME_FLAG_ECHO) << 1) ^ (frame.decoder << 2) ^ 1;
+}
+
+/**
+ * Render the header of a decoded signal (in "output")
+ *
+ * @param isEcho If the signal is our own transmission
+ */
+void printDecodedSignalHeader (bool isEcho) {
+  if (isEcho) {
+    output.println(F("\r\n-------- DECODED SIGNAL (ECHO) ---------"));
+  } else {
+    output.println(F("\r\n------------ DECODED SIGNAL ------------"));
+  }
 }
 
 /**
@@ -167,72 +349,829 @@ void CLI::onTypeChosen () {
   }
 }
 
-void CLI::onSend (String input) {
-  if (currentType == OLD_STYLE) {
+void CLI::onSend (const Command& command) {
+  ParseResult result;
+  if (currentType == OLD_STYLE && command.is("RAW")) {
+    RawReplayData data;
+    result = parseRawReplayCommand(command, data);
+    if (result != PARSE_OK) {
+      command.printError(result);
+      return;
+    }
+    if (data.changeCount == 0) {
+      Serial.println(F("ERROR: no captured signal to replay. Receive one first with type 1."));
+      return;
+    }
+    output.println(F("----------------------------------------"));
+    logData(output, data);
+    output.println(F("----------------------------------------"));
+    output.flush(Serial);
+
+    Serial.print("Sending");
+    // Set first: also reports a repeater that could not start
+    transmitRepeater.onStop(onTransmitStopped);
+    transmitRepeater.start([data](unsigned long count) {
+      Serial.print(".");
+      rgbLed.sendingState();
+      rgbLed.setTimeout([]() {
+        refreshLedState();
+      }, 400 /* duration of sendingState */);
+      // Queued to the transmit task
+      if (!sendRawData(data)) {
+        transmitRepeater.stop();
+      }
+    }, 10, 2000);
+  } else if (currentType == OLD_STYLE) {
     Type1Data data;
-    try {
-      data = parseType1SendCommand(input);
-    } catch (String error) {
-      Serial.println(F("ERROR: unable to parse the given command. Type ? to show help."));
+    result = command.expect(4, 4);
+    if (result == PARSE_OK) {
+      result = parseType1SendCommand(command, 0, data);
+    }
+    if (result != PARSE_OK) {
+      command.printError(result);
+      return;
     }
-    Serial.println(F("----------------------------------------"));
-    logData(data);
-    Serial.println(F("----------------------------------------"));
+    output.println(F("----------------------------------------"));
+    logData(output, createFrame(data), nullptr);
+    output.println(F("----------------------------------------"));
+    output.flush(Serial);
 
     Serial.print("Sending");
+    // Set first: also reports a repeater that could not start
+    transmitRepeater.onStop(onTransmitStopped);
     transmitRepeater.start([data](unsigned long count) {
       Serial.print(".");
       rgbLed.sendingState();
-      rgbLed.setTimeout([data]() {
+      rgbLed.setTimeout([]() {
         refreshLedState();
-        unsigned long timeStart = millis();
-        // This function is "blocking": it uses delay() under the hood
-        sendType1Data(data); // ≃ 370 ms but consider 1400 ms to match same interval as Type2Data sending
       }, 400 /* duration of sendingState */);
-    }, 10, 2000); // Every 1400 + 400 + 200 (safety margin) ms
-    transmitRepeater.onStop([](unsigned long count) {
-      Serial.print("Stopped. Signal has been sent "); Serial.print(count); Serial.println(" times");
-      refreshLedState();
-      CLI::printPromptPrefix();
-    });
+      // Queued to the transmit task
+      if (!sendType1Data(data, TYPE1_REPEAT_TRANSMIT)) { // ≃ 370 ms but consider 1400 ms to match same interval as Type2Data sending
+        transmitRepeater.stop();
+      }
+    }, 10, 2000); // Every 1400 + 600 (safety margin) ms
   } else {
     Type2Data data;
-    try {
-      data = parseType2SendCommand(input);
-    } catch (String error) {
-      Serial.println(F("ERROR: unable to parse the given command. Type ? to show help."));
+    result = command.expect(5, 6);
+    if (result == PARSE_OK) {
+      result = parseType2SendCommand(command, 0, command.count() > 5, data);
     }
-    Serial.println(F("----------------------------------------"));
-    logData(data);
-    Serial.println(F("----------------------------------------"));
+    if (result != PARSE_OK) {
+      command.printError(result);
+      return;
+    }
+    output.println(F("----------------------------------------"));
+    logData(output, createFrame(data), nullptr);
+    output.println(F("----------------------------------------"));
+    output.flush(Serial);
 
     Serial.print("Sending");
+    // Set first: also reports a repeater that could not start
+    transmitRepeater.onStop(onTransmitStopped);
     transmitRepeater.start([data](unsigned long count) {
       Serial.print(".");
       rgbLed.sendingState();
-      rgbLed.setTimeout([data]() {
+      rgbLed.setTimeout([]() {
         refreshLedState();
-        // This function is "blocking": it uses delay() under the hood
-        sendType2Data(data); // ≃ 1400 ms
       }, 400 /* duration of sendingState */);
-    }, 10, 2000); // Every 1400 + 400 + 200 (safety margin) ms
-    transmitRepeater.onStop([](unsigned long count) {
-      Serial.print("Stopped. Signal has been sent "); Serial.print(count); Serial.println(" times");
-      refreshLedState();
-      CLI::printPromptPrefix();
-    });
+      // Queued to the transmit task
+      if (!sendType2Data(data, TYPE2_REPEAT_TRANSMIT)) { // ≃ 1400 ms
+        transmitRepeater.stop();
+      }
+    }, 10, 2000); // Every 1400 + 600 (safety margin) ms
   }
 }
 
 /**
- * Start the receiver based on currentType
+ * Run the loopback self-test: "TEST [<frames>] [<seed>]"
+ * Only from main menu: receivers are stopped
  */
-void startReceiveMode () {
-  if (CLI::currentType == OLD_STYLE) {
-    rcSwitch.enableReceive(digitalPinToInterrupt(RX_PIN));
+void CLI::onTest (const Command& command) {
+  unsigned long frames = LOOPBACK_DEFAULT_FRAMES;
+  unsigned long seed = 1;
+  ParseResult result = command.expect(1, 3);
+  if (result == PARSE_OK && command.count() > 1) {
+    result = command.number(1, 1, 1000000, frames);
+  }
+  if (result == PARSE_OK && command.count() > 2) {
+    result = command.number(2, 1, 0xFFFFFFFF, seed);
+  }
+  if (result != PARSE_OK) {
+    command.printError(result);
+    return;
+  }
+  rgbLed.sendingState();
+  LoopbackResult loopback;
+  runLoopbackTest(loopback, frames, seed);
+  printLoopbackResult(loopback);
+  refreshLedState();
+}
+
+/**
+ * Run the benchmark: "BENCH [<iterations>]"
+ */
+void CLI::onBenchmark (const Command& command) {
+  unsigned long iterations = BENCHMARK_DEFAULT_ITERATIONS;
+  ParseResult result = command.expect(1, 2);
+  if (result == PARSE_OK && command.count() > 1) {
+    result = command.number(1, 1, 100000000, iterations);
+  }
+  if (result != PARSE_OK) {
+    command.printError(result);
+    return;
+  }
+  runBenchmark(iterations);
+}
+
+/**
+ * One-shot send: "TX1 <decimal> <protocol> <delay> <length> [<repeat>]"
+ * or "TX2 <id> <period> <group> <unit> <state> [<dimLevel>] [<repeat>]"
+ * (<dimLevel> only with state 2). Sends now, whatever the current menu.
+ */
+void CLI::onTransmitNow (const Command& command, Type type) {
+  if (transmitRepeater.isRunning()) {
+    reply().println(F("ERR BUSY"));
+    return;
+  }
+
+  unsigned long repeat;
+  unsigned int repeatIndex;
+  ParseResult result;
+  Type1Data t1;
+  Type2Data t2;
+  if (type == OLD_STYLE) {
+    repeat = TYPE1_REPEAT_TRANSMIT;
+    repeatIndex = 5;
+    result = command.expect(5, 6);
+    if (result == PARSE_OK) {
+      result = parseType1SendCommand(command, 1, t1);
+    }
+  } else {
+    // The dim level is only given for a dim command
+    unsigned long switchType = Type2Data::off;
+    result = command.number(5, Type2Data::off, Type2Data::dim, switchType);
+    const bool dimLevelPresent = switchType == Type2Data::dim;
+    repeat = TYPE2_REPEAT_TRANSMIT;
+    repeatIndex = dimLevelPresent ? 7 : 6;
+    if (result == PARSE_OK) {
+      result = command.expect(repeatIndex, repeatIndex + 1);
+    }
+    if (result == PARSE_OK) {
+      result = parseType2SendCommand(command, 1, dimLevelPresent, t2);
+    }
+  }
+  if (result == PARSE_OK && command.count() > repeatIndex) {
+    result = command.number(repeatIndex, 1, 255, repeat);
+  }
+  if (result != PARSE_OK) {
+    command.printTerseError(result, reply());
+    return;
+  }
+
+  // Queued to the transmit task: replies before the end of the transmission
+  bool queued = type == OLD_STYLE ? sendType1Data(t1, repeat) : sendType2Data(t2, repeat);
+  if (!queued) {
+    reply().println(F("ERR BUSY"));
+    return;
+  }
+  reply().println(command.is("TX1") ? F("OK TX1") : F("OK TX2"));
+}
+
+/**
+ * One-shot receive: "RX1", "RX2" or "RXALL"
+ * Switches to receive mode, then each decoded signal is printed on one line
+ */
+void CLI::onReceiveNow (const Command& command, Type type) {
+  ParseResult result = command.expect(1, 1);
+  if (result != PARSE_OK) {
+    command.printTerseError(result, reply());
+    return;
+  }
+  if (transmitRepeater.isRunning()) {
+    reply().println(F("ERR BUSY"));
+    return;
+  }
+
+  stopCurrentReceiver();
+  currentMode = RECEIVE_MODE;
+  currentType = type;
+  terseOutput = true;
+  startReceiver();
+  refreshLedState();
+  reply().print(F("OK ")); reply().println(command.token(0).str);
+}
+
+/**
+ * One-shot stop: "STOP"
+ * Stops receiving and goes back to main menu (without printing it)
+ */
+void CLI::onStopNow (const Command& command) {
+  ParseResult result = command.expect(1, 1);
+  if (result != PARSE_OK) {
+    command.printTerseError(result, reply());
+    return;
+  }
+  if (transmitRepeater.isRunning()) {
+    reply().println(F("ERR BUSY"));
+    return;
+  }
+
+  stopCurrentReceiver();
+  currentMode = NONE_MODE;
+  currentType = NONE_TYPE;
+  terseOutput = false;
+  refreshLedState();
+  reply().println(F("OK STOP"));
+}
+
+/**
+ * Loop stats: "STATS" (print) or "STATS RESET"
+ */
+void CLI::onStats (const Command& command) {
+  ParseResult result = command.expect(1, 2);
+  if (result != PARSE_OK) {
+    command.printTerseError(result, reply());
+    return;
+  }
+  if (command.count() > 1 && !command.token(1).equals("RESET")) {
+    reply().print(F("ERR ARGS ")); reply().println(command.token(1).str);
+    return;
+  }
+  if (command.count() > 1) {
+    loopStats.reset();
+    serialOutput.resetCounters();
+    reply().println(F("OK STATS"));
+    return;
+  }
+  if (binaryOutput) {
+    records.begin(RECORD_STATS);
+    records.put32(loopStats.loops());
+    records.put32(loopStats.loopRate());
+    records.put32(loopStats.maxLoop());
+    records.put32(serialOutput.droppedFrames());
+    records.put32(serialOutput.droppedBytes());
+    records.put32(edgeQueue.dropped());
+    records.put32(frameQueue.dropped());
+    records.end(output);
+    serialOutput.push(output);
+    return;
+  }
+  loopStats.print();
+  Serial.print(F("Output      : ")); Serial.print(serialOutput.used()); Serial.print(F(" bytes queued, "));
+  Serial.print(serialOutput.droppedFrames()); Serial.print(F(" frames (")); Serial.print(serialOutput.droppedBytes());
+  Serial.print(F(" bytes) dropped, ")); Serial.print(serialOutput.strippedFrames()); Serial.print(F(" without raw, "));
+  Serial.print(serialOutput.coalescedFrames()); Serial.println(F(" coalesced"));
+  Serial.print(F("Filtered    : ")); Serial.print(watchList.filtered());
+  Serial.print(F(" signals (")); Serial.print(watchList.count()); Serial.println(F(" filters)"));
+  Serial.print(F("Dropped     : edges ")); Serial.print(edgeQueue.dropped());
+  Serial.print(F(", frames ")); Serial.print(frameQueue.dropped());
+  Serial.print(F(", transmit ")); Serial.println(transmitQueue.dropped());
+  Serial.print(F("Timers      : ")); Serial.println(timers.pending());
+  Serial.print(F("Capture log : ")); Serial.print(captureLog.appended()); Serial.print(F(" records, "));
+  Serial.print(captureLog.pageWrites()); Serial.print(F(" page writes, ")); Serial.print(captureLog.erases());
+  Serial.print(F(" erases, ")); Serial.print(captureLog.failed()); Serial.println(F(" failed"));
+  Serial.print(F("Log queries : ")); Serial.print(logIndex.sectorsRead()); Serial.print(F(" sectors read, "));
+  Serial.print(logIndex.sectorsSkipped()); Serial.println(F(" skipped by the index"));
+  Serial.print(F("Heap        : ")); printHeap(Serial);
+  Serial.println(F("----------------------------------------"));
+}
+
+/**
+ * Heap state: "HEAP" command
+ */
+void CLI::onHeap (const Command& command) {
+  ParseResult result = command.expect(1, 1);
+  if (result != PARSE_OK) {
+    command.printTerseError(result, reply());
+    return;
+  }
+  reply().print(F("OK HEAP "));
+  reply().print(ESP.getFreeHeap()); reply().print(F(" "));
+  reply().print(ESP.getMinFreeHeap()); reply().print(F(" "));
+  reply().println(ESP.getMaxAllocHeap());
+}
+
+/**
+ * Print the heap state: free, minimum free since boot and largest block
+ */
+void printHeap (Print& out) {
+  out.print(ESP.getFreeHeap()); out.print(F(" bytes free (min "));
+  out.print(ESP.getMinFreeHeap()); out.print(F("), largest block "));
+  out.println(ESP.getMaxAllocHeap());
+}
+
+/**
+ * Output mode: "BIN" (binary records) or "TEXT"
+ * Replies in text, before switching to binary / after switching to text
+ */
+void CLI::onOutputMode (const Command& command, bool binary) {
+  ParseResult result = command.expect(1, 1);
+  if (result != PARSE_OK) {
+    command.printTerseError(result, reply());
+    return;
+  }
+  if (transmitRepeater.isRunning()) {
+    reply().println(F("ERR BUSY"));
+    return;
+  }
+  binaryOutput = false;
+  Serial.print(F("OK ")); Serial.println(command.token(0).str);
+  binaryOutput = binary;
+}
+
+/**
+ * Watch list: "FILTER" (list), "FILTER CLEAR",
+ * "FILTER INCLUDE|EXCLUDE|REMOVE <field> <value>"
+ */
+void CLI::onFilter (const Command& command) {
+  ParseResult result = command.expect(1, 4);
+  if (result != PARSE_OK) {
+    command.printTerseError(result, reply());
+    return;
+  }
+  if (command.count() == 1) {
+    watchList.print(reply());
+    reply().println(F("OK FILTER"));
+    return;
+  }
+  if (command.count() == 2 && command.token(1).equals("CLEAR")) {
+    watchList.clear();
+    reply().println(F("OK FILTER"));
+    return;
+  }
+
+  const Token& action = command.token(1);
+  WatchMode mode = WATCH_NONE;
+  if (action.equals("INCLUDE")) {
+    mode = WATCH_INCLUDE;
+  } else if (action.equals("EXCLUDE")) {
+    mode = WATCH_EXCLUDE;
+  } else if (!action.equals("REMOVE")) {
+    reply().print(F("ERR ARGS ")); reply().println(action.str);
+    return;
+  }
+  result = command.expect(4, 4);
+  if (result != PARSE_OK) {
+    command.printTerseError(result, reply());
+    return;
+  }
+  int field = 0;
+  while (field < WATCH_FIELD_COUNT && !command.token(2).equals(WatchList::fieldName((WatchField)field))) {
+    field++;
+  }
+  if (field == WATCH_FIELD_COUNT) {
+    reply().print(F("ERR ARGS ")); reply().println(command.token(2).str);
+    return;
+  }
+  // Same ranges as the send commands, but the length: decoded frames are
+  // up to RCSWITCH_MAX_BITS long
+  static const unsigned long maxValues[WATCH_FIELD_COUNT] = {
+    0xFFFF, // PROTO
+    0xFFFFFFFF, // CODE
+    RCSWITCH_MAX_BITS, // LEN
+    0x3FFFFFF, // ADDR
+    15 // UNIT
+  };
+  unsigned long value;
+  result = command.number(3, 0, maxValues[field], value);
+  if (result != PARSE_OK) {
+    command.printTerseError(result, reply());
+    return;
+  }
+
+  if (mode == WATCH_NONE) {
+    if (!watchList.remove((WatchField)field, value)) {
+      reply().println(F("ERR NOT FOUND"));
+      return;
+    }
+  } else if (!watchList.add((WatchField)field, value, mode)) {
+    reply().println(F("ERR FULL"));
+    return;
+  }
+  reply().println(F("OK FILTER"));
+}
+
+/**
+ * Print a record of the capture log: "LOG <boot> <time> RX1 ..." line (as
+ * RX1/RX2 output), or binary record
+ */
+void printLogEntry (const LogEntry& entry, const RawCapture* raw) {
+  if (CLI::binaryOutput) {
+    logDataRecord(output, records, entry.frame, raw && raw->count > 0 ? raw : nullptr);
+  } else {
+    output.print(F("LOG ")); output.print(entry.boot);
+    output.print(F(" ")); output.print(entry.frame.timestamp); output.print(F(" "));
+    logDataLine(output, entry.frame);
+  }
+  // Written now (may be long): never dropped by the output queue
+  output.flush(Serial);
+}
+
+/**
+ * Capture log: "LOG" (records and sectors used), "LOG DUMP",
+ * "LOG TAIL [<count>]" or "LOG CLEAR" (see onLogQuery for the queries)
+ * Records are printed by printLogEntry
+ */
+void CLI::onLog (const Command& command) {
+  if (command.count() > 1 && (command.token(1).equals("LAST") || command.token(1).equals("PROTO") ||
+    command.token(1).equals("TOP"))) {
+    onLogQuery(command);
+    return;
+  }
+  ParseResult result = command.expect(1, 3);
+  if (result != PARSE_OK) {
+    command.printTerseError(result, reply());
+    return;
+  }
+  if (!captureLog.isReady()) {
+    reply().println(F("ERR NO LOG"));
+    return;
+  }
+  const bool isDump = command.count() == 2 && command.token(1).equals("DUMP");
+  const bool isTail = command.count() > 1 && command.token(1).equals("TAIL");
+  if (command.count() == 2 && command.token(1).equals("CLEAR")) {
+    // Erasing would stall the transmit task
+    if (isTransmitting()) {
+      reply().println(F("ERR BUSY"));
+      return;
+    }
+    if (!logIndex.clear()) {
+      reply().println(F("ERR FLASH"));
+      return;
+    }
+    reply().println(F("OK LOG"));
+    return;
+  }
+  if (command.count() > 1 && !isDump && !isTail) {
+    reply().print(F("ERR ARGS ")); reply().println(command.token(1).str);
+    return;
+  }
+  unsigned long tail = 10;
+  if (isTail && command.count() > 2) {
+    result = command.number(2, 1, 0xFFFFFFFF, tail);
+    if (result != PARSE_OK) {
+      command.printTerseError(result, reply());
+      return;
+    }
+  }
+
+  // Records are read from flash one at a time
+  LogCursor cursor;
+  LogEntry entry;
+  unsigned long count = 0;
+  if (!isDump && !isTail) {
+    captureLog.first(cursor);
+    while (captureLog.next(cursor, entry, nullptr)) {
+      count++;
+    }
+    reply().print(F("OK LOG ")); reply().print(count); reply().print(F(" "));
+    reply().print(captureLog.usedSectors()); reply().print(F(" ")); reply().println(captureLog.sectors());
+    return;
+  }
+
+  // Tail: only the newest sectors holding the last records are read
+  unsigned long skip = 0;
+  if (isTail) {
+    skip = captureLog.tail(cursor, tail);
   } else {
-    NewRemoteReceiver::init(RX_PIN, 2, nrsInitCallback);
+    captureLog.first(cursor);
+  }
+  logReading = true;
+  while (captureLog.next(cursor, entry, &loggedRaw)) {
+    if (skip > 0) {
+      skip--;
+      continue;
+    }
+    printLogEntry(entry, &loggedRaw);
+    count++;
+    handleBetweenRecords();
+  }
+  logReading = false;
+  reply().print(F("OK LOG ")); reply().println(count);
+}
+
+/**
+ * Capture log queries, answered from the index (see LogIndex.h):
+ * "LOG LAST 1 <decimal>" or "LOG LAST 2 <id>" (last record of a code),
+ * "LOG PROTO <protocol> [<minutes>]" (records of a type 1 protocol, 0 for
+ * type 2, in the last minutes of this boot) or "LOG TOP" (most frequent codes,
+ * "TOP <count> <boot> <time> RX1 ..." lines)
+ */
+void CLI::onLogQuery (const Command& command) {
+  ParseResult result = command.expect(2, 4);
+  if (result != PARSE_OK) {
+    command.printTerseError(result, reply());
+    return;
+  }
+  if (!logIndex.isReady()) {
+    reply().println(F("ERR NO LOG"));
+    return;
+  }
+  LogEntry entry;
+  const Token& action = command.token(1);
+  if (action.equals("LAST")) {
+    unsigned long decoder, code;
+    result = command.expect(4, 4);
+    if (result == PARSE_OK) {
+      result = command.number(2, 1, 2, decoder);
+    }
+    if (result == PARSE_OK) {
+      result = command.number(3, 0, decoder == 2 ? 0x3FFFFFF : 0xFFFFFFFF, code);
+    }
+    if (result != PARSE_OK) {
+      command.printTerseError(result, reply());
+      return;
+    }
+    if (!logIndex.last(LogIndex::key(decoder == 2 ? FRAME_TYPE2 : FRAME_TYPE1, code), entry)) {
+      reply().println(F("ERR NOT FOUND"));
+      return;
+    }
+    printLogEntry(entry, nullptr);
+    reply().println(F("OK LOG 1"));
+    return;
+  }
+
+  if (action.equals("TOP")) {
+    result = command.expect(2, 2);
+    if (result != PARSE_OK) {
+      command.printTerseError(result, reply());
+      return;
+    }
+    for (unsigned int rank = 0; rank < logIndex.talkers(); rank++) {
+      const LogTalker& talker = logIndex.talker(rank);
+      output.print(F("TOP ")); output.print(talker.count); output.print(F(" "));
+      output.print(talker.last.boot); output.print(F(" ")); output.print(talker.last.frame.timestamp);
+      output.print(F(" ")); logDataLine(output, talker.last.frame);
+      output.flush(reply());
+    }
+    reply().print(F("OK LOG ")); reply().println(logIndex.talkers());
+    return;
+  }
+
+  // "PROTO"
+  LogQuery query;
+  query.clear();
+  unsigned long protocol, minutes = 0;
+  result = command.expect(3, 4);
+  if (result == PARSE_OK) {
+    result = command.number(2, 0, 255, protocol);
+  }
+  if (result == PARSE_OK && command.count() > 3) {
+    // Up to 49 days (millis)
+    result = command.number(3, 1, 71582, minutes);
+  }
+  if (result != PARSE_OK) {
+    command.printTerseError(result, reply());
+    return;
+  }
+  query.byProtocol = true;
+  query.protocol = protocol;
+  if (minutes > 0) {
+    // No clock: the previous boots are left out
+    const unsigned long window = minutes * 60000UL;
+    const unsigned long now = millis();
+    query.byTime = true;
+    query.boot = captureLog.boot();
+    query.since = now > window ? now - window : 0;
+  }
+  unsigned long count = 0;
+  logIndex.start(query);
+  logReading = true;
+  while (logIndex.next(query, entry, &loggedRaw)) {
+    printLogEntry(entry, &loggedRaw);
+    count++;
+    handleBetweenRecords();
+  }
+  logReading = false;
+  reply().print(F("OK LOG ")); reply().println(count);
+}
+
+/**
+ * Code library: "LIB" (list), "LIB SAVE <name> [RAW]" (last decoded signal,
+ * or its raw timings), "LIB ADD <name> TX1 <decimal> <protocol> <delay> <length>",
+ * "LIB ADD <name> TX2 <id> <period> <group> <unit> <state> [<dimLevel>]"
+ * or "LIB DEL <name>"
+ * The waveform is encoded once, when the code is saved
+ */
+void CLI::onLibrary (const Command& command) {
+  ParseResult result = command.expect(1, Command::MAX_TOKENS);
+  if (result != PARSE_OK) {
+    command.printTerseError(result, reply());
+    return;
+  }
+  if (!codeLibrary.isReady()) {
+    reply().println(F("ERR NO LIB"));
+    return;
+  }
+  if (command.count() == 1) {
+    unsigned int position = 0;
+    LibraryCode code;
+    while (codeLibrary.next(position, code)) {
+      output.print(F("LIB ")); output.print(code.name); output.print(F(" "));
+      logDataLine(output, code.frame);
+      output.flush(reply());
+    }
+    reply().print(F("OK LIB ")); reply().print(codeLibrary.count());
+    reply().print(F(" ")); reply().println(codeLibrary.available());
+    return;
+  }
+
+  const Token& action = command.token(1);
+  const Token& name = command.token(2);
+  if (command.count() < 3 || name.length > CodeLibrary::MAX_NAME) {
+    reply().print(F("ERR ARGS ")); reply().println(command.count() < 3 ? action.str : name.str);
+    return;
+  }
+  // Writing (or compacting) would stall the transmit task
+  if (isTransmitting()) {
+    reply().println(F("ERR BUSY"));
+    return;
+  }
+  if (action.equals("DEL")) {
+    result = command.expect(3, 3);
+    if (result != PARSE_OK) {
+      command.printTerseError(result, reply());
+      return;
+    }
+    if (!codeLibrary.remove(name.str)) {
+      reply().println(F("ERR NOT FOUND"));
+      return;
+    }
+    reply().println(F("OK LIB"));
+    return;
+  }
+
+  // The waveform is prepared in the transmit job (not queued)
+  Waveform& waveform = transmitJob.waveform;
+  Frame frame = lastFrame;
+  unsigned int first = 0;
+  bool encoded = false;
+  if (action.equals("SAVE")) {
+    result = command.expect(3, 4);
+    const bool isRaw = command.count() == 4 && command.token(3).equals("RAW");
+    if (result == PARSE_OK && command.count() == 4 && !isRaw) {
+      reply().print(F("ERR ARGS ")); reply().println(command.token(3).str);
+      return;
+    }
+    if (result != PARSE_OK) {
+      command.printTerseError(result, reply());
+      return;
+    }
+    if (frame.decoder == FRAME_TYPE2) {
+      encoded = !isRaw && encodeWaveform(waveform, createData(frame.period, frame.address(), frame.groupBit(),
+        frame.unit(), frame.switchType(), frame.dimLevelPresent(), frame.dimLevel()));
+    } else if (frame.decoder == FRAME_TYPE1 && (isRaw || frame.bitLength > 32)) {
+      // Frames longer than 32 bits can only be replayed from their timings
+      encoded = (frame.flags & FRAME_FLAG_RAW) && lastType1Raw.count > 0 && lastType1Raw.count <= WAVEFORM_MAX_LEVELS;
+      for (unsigned int i = 0; encoded && i < lastType1Raw.count; i++) {
+        waveform.durations[i] = lastType1Raw.timings[i];
+      }
+      waveform.count = lastType1Raw.count;
+      waveform.inverted = false;
+      // timings[0] is the sync (gap) before the frame: play it last
+      first = 1;
+    } else if (frame.decoder == FRAME_TYPE1) {
+      encoded = encodeWaveform(waveform, createData(frame.payload[0], frame.protocol, frame.period, frame.bitLength));
+    }
+    if (!encoded) {
+      reply().println(F("ERR NO SIGNAL"));
+      return;
+    }
+  } else if (action.equals("ADD") && command.token(3).equals("TX1")) {
+    Type1Data data;
+    result = command.expect(8, 8);
+    if (result == PARSE_OK) {
+      result = parseType1SendCommand(command, 4, data);
+    }
+    if (result != PARSE_OK) {
+      command.printTerseError(result, reply());
+      return;
+    }
+    frame = createFrame(data);
+    encoded = encodeWaveform(waveform, data);
+  } else if (action.equals("ADD") && command.token(3).equals("TX2")) {
+    Type2Data data;
+    unsigned long switchType = Type2Data::off;
+    result = command.number(8, Type2Data::off, Type2Data::dim, switchType);
+    const bool dimLevelPresent = switchType == Type2Data::dim;
+    if (result == PARSE_OK) {
+      result = command.expect(dimLevelPresent ? 10 : 9, dimLevelPresent ? 10 : 9);
+    }
+    if (result == PARSE_OK) {
+      result = parseType2SendCommand(command, 4, dimLevelPresent, data);
+    }
+    if (result != PARSE_OK) {
+      command.printTerseError(result, reply());
+      return;
+    }
+    frame = createFrame(data);
+    encoded = encodeWaveform(waveform, data);
+  } else {
+    reply().print(F("ERR ARGS ")); reply().println(command.count() > 3 && action.equals("ADD") ? command.token(3).str : action.str);
+    return;
+  }
+  if (!encoded) {
+    reply().println(F("ERR ARGS"));
+    return;
+  }
+
+  frame.timestamp = millis();
+  frame.flags = (frame.flags & FRAME_FLAG_DIM_LEVEL) | (first ? FRAME_FLAG_RAW : 0);
+  frame.rawSlot = 0;
+  const unsigned int repeats = frame.decoder == FRAME_TYPE1 ? TYPE1_REPEAT_TRANSMIT : TYPE2_REPEAT_TRANSMIT;
+  if (!codeLibrary.save(name.str, frame, waveform, first, repeats)) {
+    reply().println(F("ERR FULL"));
+    return;
+  }
+  reply().println(F("OK LIB"));
+}
+
+/**
+ * Send a code of the library: "SEND <name> [<repeat>]"
+ * Its waveform is read from flash as it was saved: nothing to parse or encode
+ */
+void CLI::onSendCode (const Command& command) {
+  ParseResult result = command.expect(2, 3);
+  if (result != PARSE_OK) {
+    command.printTerseError(result, reply());
+    return;
+  }
+  if (transmitRepeater.isRunning()) {
+    reply().println(F("ERR BUSY"));
+    return;
+  }
+  LibraryCode code;
+  if (!codeLibrary.find(command.token(1).str, code)) {
+    reply().println(F("ERR NOT FOUND"));
+    return;
+  }
+  unsigned long repeat = code.repeats;
+  if (command.count() > 2) {
+    result = command.number(2, 1, 255, repeat);
+    if (result != PARSE_OK) {
+      command.printTerseError(result, reply());
+      return;
+    }
   }
+
+  loopStats.begin(SECTION_TRANSMIT);
+  bool loaded = codeLibrary.load(code, transmitJob.waveform);
+  loopStats.end();
+  transmitJob.first = code.first;
+  transmitJob.scale = 100;
+  transmitJob.repeats = repeat;
+  if (!loaded || !transmitQueue.push(transmitJob)) {
+    reply().println(F("ERR BUSY"));
+    return;
+  }
+  // Echoes may be decoded during the whole transmission
+  echoFilter.remember(code.frame, transmitDuration(transmitJob));
+  reply().println(F("OK SEND"));
+}
+
+/**
+ * Called when the transmitter repeater is stopped
+ */
+void onTransmitStopped (unsigned long count) {
+  Serial.print("Stopped. Signal has been sent "); Serial.print(count); Serial.println(" times");
+  refreshLedState();
+  CLI::printPromptPrefix();
+}
+
+/**
+ * Start the receiver of the currentType
+ */
+void startReceiver () {
+  startDecoding(
+    CLI::currentType == OLD_STYLE || CLI::currentType == ALL_TYPES,
+    CLI::currentType == NEW_STYLE || CLI::currentType == ALL_TYPES
+  );
+}
+
+/**
+ * Stop the receiver of the currentType
+ */
+void stopReceiver () {
+  stopDecoding();
+}
+
+/**
+ * Stop the receiver of the currentType, if it is listening
+ */
+void stopCurrentReceiver () {
+  if (CLI::currentType == NONE_TYPE) {
+    return;
+  }
+  if (CLI::currentMode == RECEIVE_MODE || RECEIVE_WHILE_TRANSMITTING) {
+    stopReceiver();
+  }
+}
+
+/**
+ * Start the receiver based on currentType
+ */
+void startReceiveMode () {
+  startReceiver();
   refreshLedState();
   Serial.println(F("Listening..."));
 }
@@ -241,11 +1180,8 @@ void startReceiveMode () {
  * Start the transmitter based on currentType
  */
 void startTransmitMode () {
-  if (CLI::currentType == OLD_STYLE) {
-    rcSwitch.enableTransmit(digitalPinToInterrupt(TX_PIN));
-  } else {
-    // No need to setup NewRemoteSwitch...
-    // See sendType2Data function below
+  if (RECEIVE_WHILE_TRANSMITTING) {
+    startReceiver();
   }
   refreshLedState();
   Serial.println(F("Waiting for send command..."));
@@ -255,6 +1191,7 @@ void startTransmitMode () {
  * Stop current receiver or transmitter and back to previous menu
  */
 void stopAndBack () {
+  CLI::terseOutput = false;
   switch (CLI::currentMode) {
     case NONE_MODE:
       // Nothing...
@@ -264,11 +1201,7 @@ void stopAndBack () {
       if (CLI::currentType == NONE_TYPE) {
         CLI::currentMode = NONE_MODE;
       } else {
-        if (CLI::currentType == OLD_STYLE) {
-          rcSwitch.disableReceive();
-        } else if (CLI::currentType == NEW_STYLE) {
-          NewRemoteReceiver::deinit();
-        }
+        stopReceiver();
         Serial.println(F("Receiver stopped"));
         CLI::currentType = NONE_TYPE;
       }
@@ -279,12 +1212,11 @@ void stopAndBack () {
       if (CLI::currentType == NONE_TYPE) {
         CLI::currentMode = NONE_MODE;
       } else {
-        // "Old" style? disable transmit
-        if (CLI::currentType == OLD_STYLE) {
-          rcSwitch.disableTransmit();
-        }
         // Reset current type only if transmitRepeater is not running
         if (!transmitRepeater.isRunning()) {
+          if (RECEIVE_WHILE_TRANSMITTING) {
+            stopReceiver();
+          }
           CLI::currentType = NONE_TYPE;
         }
       }
@@ -293,35 +1225,15 @@ void stopAndBack () {
   }
 }
 
-/**
- * The callback function to pass to NewRemoteSwitch::init method.
- * Called every time a signal is decoded by NewRemoteSwitch library
- */
-void nrsInitCallback (unsigned int period, unsigned long address, unsigned long groupBit, unsigned long unit, unsigned long switchType, boolean dimLevelPresent, byte dimLevel) {
-  t2Data = createData(
-    period,
-    address,
-    groupBit,
-    unit,
-    switchType,
-    dimLevelPresent,
-    dimLevel
-  );
-  type2DataAvailable = true;
-}
-
 /**
  * Create and return a Type1Data object
  */
-Type1Data createData (unsigned long decimal, unsigned int protocol, unsigned int delay, unsigned int length, unsigned int* raw) {
+Type1Data createData (unsigned long decimal, unsigned int protocol, unsigned int delay, unsigned int length) {
   Type1Data data;
   data.decimal = decimal;
   data.protocol = protocol;
   data.delay = delay;
   data.length = length;
-  data.raw = raw;
-  data.bin = dec2binWzerofill(decimal, length);
-  data.triState = bin2tristate(data.bin);
   return data;
 }
 
@@ -357,100 +1269,167 @@ Type2Data createData (unsigned int period, unsigned long address, unsigned long
 /**
  * Command syntax: <decimal> <protocol> <delay> <length>
  * Example: 5592332 1 350 24
+ *
+ * Arguments are read from the token "first" (1 for "TX1 ...")
  */
-Type1Data parseType1SendCommand (String input) {
-  String tokens[4] = { "", "", "", "" };
-  int i = 0;
-  while (input.length() > 0 && i < 4) {
-    int index = input.indexOf(' ');
-    if (index == -1) {
-      tokens[i++] = input;
-      break;
-    } else {
-      tokens[i++] = input.substring(0, index);
-      input = input.substring(index + 1);
-    }
+ParseResult parseType1SendCommand (const Command& command, unsigned int first, Type1Data& data) {
+  unsigned long decimal, protocol, delay, length;
+  ParseResult result = command.number(first + 1, 1, RCSwitch::getProtocolCount(), protocol);
+  if (result == PARSE_OK) result = command.number(first + 2, 0, 0xFFFF, delay);
+  if (result == PARSE_OK) result = command.number(first + 3, 1, 32, length);
+  // The code must fit in the bit length
+  if (result == PARSE_OK) result = command.number(first, 0, length < 32 ? (1UL << length) - 1 : 0xFFFFFFFF, decimal);
+  if (result != PARSE_OK) {
+    return result;
   }
 
-  Type1Data data = createData(
-    strtoul(tokens[0].c_str(), NULL, 10), // decimal
-    tokens[1].toInt(), // protocol
-    tokens[2].toInt(), // delay
-    tokens[3].toInt(), // length
-    nullptr // raw
+  data = createData(
+    decimal,
+    protocol,
+    delay,
+    length
   );
 
-  return data;
+  return PARSE_OK;
 }
 
 /**
- * Send (type 1) data with rc-switch
+ * Send (type 1) data, encoded with the RCSwitch protocol
+ *
+ * @param repeat Number of frames
+ * @return false if the data can't be encoded or the transmit queue is full
  */
-void sendType1Data (Type1Data data) {
-  // Configure transmitter
-  rcSwitch.setProtocol(data.protocol);
-  rcSwitch.setPulseLength(data.delay);
-  // Send signals
-  rcSwitch.send(data.decimal, data.length);
+bool sendType1Data (Type1Data data, unsigned int repeat) {
+  loopStats.begin(SECTION_TRANSMIT);
+  bool encoded = encodeWaveform(transmitJob.waveform, data);
+  loopStats.end();
+  if (!encoded) {
+    return false;
+  }
+  transmitJob.first = 0;
+  transmitJob.scale = 100;
+  transmitJob.repeats = repeat;
+  if (!transmitQueue.push(transmitJob)) {
+    return false;
+  }
+  // Echoes may be decoded during the whole transmission
+  echoFilter.remember(createFrame(data), transmitDuration(transmitJob));
+  return true;
 }
 
 /**
- * <address> <period> <group> <unit> <state> [<dimLevel>]
+ * Command syntax: RAW [<scale>] [I]
+ * Example: RAW 105 I
+ *
+ * Replays the timings of the last signal decoded by RCSwitch, from a
+ * snapshot. A changeCount of 0 means there is nothing to replay.
  */
-Type2Data parseType2SendCommand (String input) {
-  String tokens[6] = { "", "", "", "", "", "" };
-  int i = 0;
-  // Split the input into substrings
-  while (input.length() > 0) {
-    int index = input.indexOf(' ');
-    if (index == -1) { // No space found
-      tokens[i++] = input;
-      break;
+ParseResult parseRawReplayCommand (const Command& command, RawReplayData& data) {
+  // Snapshot: new signals are decoded during the 10 repetitions (about 20 s),
+  // each one overwrites lastType1Raw
+  replayedRaw = lastType1Raw;
+  replayedFrame = lastType1Frame;
+  data.raw = replayedRaw.timings;
+  // timings[0] (sync) + 2 timings per bit + the last high pulse before sync
+  data.changeCount = replayedRaw.count;
+  data.scale = 100;
+  data.inverted = false;
+
+  ParseResult result = command.expect(1, 3);
+  // Skip "RAW"
+  for (unsigned int i = 1; result == PARSE_OK && i < command.count(); i++) {
+    if (command.token(i).equals("I")) {
+      data.inverted = true;
     } else {
-      tokens[i++] = input.substring(0, index);
-      input = input.substring(index+1);
+      unsigned long scale;
+      result = command.number(i, 1, 1000, scale);
+      data.scale = scale;
     }
   }
 
-  bool dimLevelPresent = (tokens[5] && tokens[5].length() > 0);
+  return result;
+}
+
+/**
+ * Replay (type 1) raw timings
+ *
+ * @return false if there are more timings than a waveform holds
+ *   (WAVEFORM_MAX_LEVELS), or if the transmit queue is full
+ */
+bool sendRawData (RawReplayData data) {
+  if (data.changeCount > WAVEFORM_MAX_LEVELS) {
+    return false;
+  }
+  // The job is queued by value: the transmit task plays its own copy
+  for (unsigned int i = 0; i < data.changeCount; i++) {
+    transmitJob.waveform.durations[i] = data.raw[i];
+  }
+  transmitJob.waveform.count = data.changeCount;
+  transmitJob.waveform.inverted = data.inverted;
+  // timings[0] is the sync (gap) before the frame: play it last
+  transmitJob.first = 1;
+  transmitJob.scale = data.scale;
+  transmitJob.repeats = TYPE1_REPEAT_TRANSMIT;
+  if (!transmitQueue.push(transmitJob)) {
+    return false;
+  }
+  // Same signal as the captured one
+  echoFilter.remember(replayedFrame, transmitDuration(transmitJob));
+  return true;
+}
 
-  Type2Data data = createData(
-    tokens[1].toInt(), // period
-    tokens[0].toInt(), // address
-    tokens[2].toInt(), // groupbit
-    tokens[3].toInt(), // unit
-    tokens[4].toInt(), // switchType
+/**
+ * <address> <period> <group> <unit> <state> [<dimLevel>]
+ *
+ * Arguments are read from the token "first" (1 for "TX2 ...")
+ */
+ParseResult parseType2SendCommand (const Command& command, unsigned int first, bool dimLevelPresent, Type2Data& data) {
+  unsigned long address, period, groupBit, unit, switchType;
+  unsigned long dimLevel = 0;
+  // 26 bits address
+  ParseResult result = command.number(first, 0, 0x3FFFFFF, address);
+  if (result == PARSE_OK) result = command.number(first + 1, 1, 0xFFFF, period);
+  if (result == PARSE_OK) result = command.number(first + 2, 0, 1, groupBit);
+  if (result == PARSE_OK) result = command.number(first + 3, 0, 15, unit);
+  if (result == PARSE_OK) result = command.number(first + 4, Type2Data::off, Type2Data::dim, switchType);
+  if (result == PARSE_OK && dimLevelPresent) result = command.number(first + 5, 0, 15, dimLevel);
+  if (result != PARSE_OK) {
+    return result;
+  }
+
+  data = createData(
+    period,
+    address,
+    groupBit,
+    unit,
+    switchType,
     dimLevelPresent,
-    dimLevelPresent ? tokens[5].toInt() : 0 // dimLevel
+    dimLevel
   );
 
-  return data;
+  return PARSE_OK;
 }
 
 /**
- * Send (type 2) data with NewRemoteTransmitter
+ * Send (type 2) data, encoded as NewRemoteTransmitter does
+ *
+ * @param repeat Number of frames
+ * @return false if the data can't be encoded or the transmit queue is full
  */
-void sendType2Data (Type2Data data) {
-  // Create a new transmitter with the received address and period, use a digital pin as output pin
-  NewRemoteTransmitter transmitter(data.address, TX_PIN, data.period);
-
-  if (data.switchType == Type2Data::dim ||
-    (data.switchType == Type2Data::on && data.dimLevelPresent)) {
-    // Dimmer signal received
-    if (data.groupBit) {
-      transmitter.sendGroupDim(data.dimLevel);
-    } else {
-      transmitter.sendDim(data.unit, data.dimLevel);
-    }
-  } else {
-    // On/Off signal
-    bool isOn = data.switchType == Type2Data::on;
-    if (data.groupBit) {
-      // Send to the group
-      transmitter.sendGroup(isOn);
-    } else {
-      // Send to a single unit
-      transmitter.sendUnit(data.unit, isOn);
-    }
+bool sendType2Data (Type2Data data, unsigned int repeat) {
+  loopStats.begin(SECTION_TRANSMIT);
+  bool encoded = encodeWaveform(transmitJob.waveform, data);
+  loopStats.end();
+  if (!encoded) {
+    return false;
+  }
+  transmitJob.first = 0;
+  transmitJob.scale = 100;
+  transmitJob.repeats = repeat;
+  if (!transmitQueue.push(transmitJob)) {
+    return false;
   }
+  // Echoes may be decoded during the whole transmission
+  echoFilter.remember(createFrame(data), transmitDuration(transmitJob));
+  return true;
 }
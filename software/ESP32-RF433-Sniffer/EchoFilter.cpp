@@ -0,0 +1,92 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#include "EchoFilter.h"
+#include "HeapFree.h"
+
+/**
+ * Code of a signal: type 1 code (folded to 64 bits) or type 2 address
+ */
+static uint64_t signalCode (const Frame& frame) {
+  if (frame.decoder == FRAME_TYPE2) {
+    return frame.address();
+  }
+  uint64_t code = frame.low64();
+  for (unsigned int i = 2; i < FRAME_PAYLOAD_WORDS; i++) {
+    code ^= (uint64_t)frame.payload[i] << (i % 2 * 32);
+  }
+  return code;
+}
+
+/**
+ * Detail of a signal. Type 1: bit length (the protocol is not part of the
+ * signature: the same waveform may be decoded with another one).
+ * Type 2: unit, group bit and on/off. Dim commands are decoded as "dim" or
+ * "on" depending on the receiver, so both count as "on".
+ */
+static unsigned long signalDetail (const Frame& frame) {
+  if (frame.decoder == FRAME_TYPE1) {
+    return frame.bitLength;
+  }
+  bool isOn = frame.switchType() != Type2Data::off;
+  return (unsigned long)frame.unit() | ((unsigned long)frame.groupBit() << 4) | ((unsigned long)isOn << 5);
+}
+
+// EchoFilter class constructor
+EchoFilter::EchoFilter (unsigned long window, TimerWheel& timers) : _window(window), _timers(timers) {
+  memset(_entries, 0, sizeof(_entries));
+}
+
+void EchoFilter::remember (const Frame& frame, unsigned long duration) {
+  _remember(frame.decoder, signalCode(frame), signalDetail(frame), duration);
+}
+
+bool EchoFilter::isEcho (const Frame& frame) {
+  return _match(frame.decoder, signalCode(frame), signalDetail(frame));
+}
+
+void EchoFilter::_remember (uint8_t type, uint64_t code, unsigned long detail, unsigned long duration) {
+  // Refresh the entry if this signal is already remembered
+  for (unsigned int i = 0; i < SIZE; i++) {
+    Entry& entry = _entries[i];
+    if (entry.type == type && entry.code == code && entry.detail == detail) {
+      _expireAfterWindow(i, duration);
+      return;
+    }
+  }
+  // Otherwise replace the oldest one
+  _timers.cancel(_entries[_next].timer);
+  _entries[_next] = { type, code, detail, NO_TIMER };
+  _expireAfterWindow(_next, duration);
+  _next = (_next + 1) % SIZE;
+}
+
+void EchoFilter::_expireAfterWindow (unsigned int index, unsigned long duration) {
+  Entry& entry = _entries[index];
+  _timers.cancel(entry.timer);
+  entry.timer = _timers.schedule([this, index]() {
+    _entries[index].type = 0;
+    _entries[index].timer = NO_TIMER;
+  }, _window + duration);
+  // No timer left: expired now, rather than matching real signals forever
+  if (entry.timer == NO_TIMER) {
+    entry.type = 0;
+  }
+}
+
+bool EchoFilter::_match (uint8_t type, uint64_t code, unsigned long detail) {
+  // Expired entries are freed by their timer
+  for (unsigned int i = 0; i < SIZE; i++) {
+    const Entry& entry = _entries[i];
+    if (entry.type == type && entry.code == code && entry.detail == detail) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,77 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef ECHO_FILTER_H
+#define ECHO_FILTER_H
+
+#include <Arduino.h>
+#include "Data.h"
+#include "TimerWheel.h"
+
+/**
+ * EchoFilter class
+ *
+ * Remembers the signals we have just sent, so that the receiver (which keeps
+ * listening while transmitting) can recognize our own transmissions among
+ * the decoded signals.
+ */
+class EchoFilter {
+  public:
+    /**
+     * Constructor
+     *
+     * @param window How long a sent signal is remembered after its transmission (in ms)
+     * @param timers The timer wheel forgetting the signals
+     */
+    EchoFilter (unsigned long window, TimerWheel& timers);
+
+    /**
+     * Remember a sent signal
+     *
+     * @param frame The sent signal
+     * @param duration The transmission duration, added to the window (in ms). Default: 0
+     */
+    void remember (const Frame& frame, unsigned long duration = 0);
+
+    /**
+     * To know if a decoded signal matches one we have sent within the window
+     *
+     * @param frame The decoded signal
+     */
+    bool isEcho (const Frame& frame);
+
+  private:
+    /**
+     * A remembered signal
+     */
+    struct Entry {
+      // FRAME_TYPE1, FRAME_TYPE2, 0: free
+      uint8_t type;
+      uint64_t code;
+      unsigned long detail;
+      // Forgets the entry at the end of the window
+      TimerId timer;
+    };
+
+    /**
+     * Number of signals remembered at the same time
+     */
+    static const unsigned int SIZE = 4;
+
+    Entry _entries[SIZE];
+    unsigned int _next = 0;
+    unsigned long _window;
+    TimerWheel& _timers;
+
+    void _remember (uint8_t type, uint64_t code, unsigned long detail, unsigned long duration);
+    void _expireAfterWindow (unsigned int index, unsigned long duration);
+    bool _match (uint8_t type, uint64_t code, unsigned long detail);
+};
+
+#endif
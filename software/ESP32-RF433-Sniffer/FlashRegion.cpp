@@ -0,0 +1,124 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#include "FlashRegion.h"
+#include "HeapFree.h"
+
+unsigned long FlashRegion::size () const {
+  return _size;
+}
+
+bool FlashRegion::_contains (unsigned long address, unsigned long length) const {
+  return address <= _size && length <= _size - address;
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+
+bool FlashRegion::begin (const char* name, unsigned long offset, unsigned long size) {
+  _partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, name);
+  if (_partition == nullptr || _partition->size < offset + size) {
+    _partition = nullptr;
+    return false;
+  }
+  _offset = offset;
+  _size = size;
+  return true;
+}
+
+bool FlashRegion::read (unsigned long address, void* buffer, unsigned int length) {
+  return _partition && _contains(address, length) &&
+    esp_partition_read(_partition, _offset + address, buffer, length) == ESP_OK;
+}
+
+bool FlashRegion::write (unsigned long address, const void* buffer, unsigned int length) {
+  return _partition && _contains(address, length) &&
+    esp_partition_write(_partition, _offset + address, buffer, length) == ESP_OK;
+}
+
+bool FlashRegion::erase (unsigned long address, unsigned long length) {
+  return _partition && _contains(address, length) &&
+    esp_partition_erase_range(_partition, _offset + address, length) == ESP_OK;
+}
+
+#else
+
+// Host build: a plain file, created erased
+
+bool FlashRegion::begin (const char* name, unsigned long offset, unsigned long size) {
+  _file = fopen(name, "r+b");
+  if (_file == nullptr) {
+    _file = fopen(name, "w+b");
+  }
+  if (_file == nullptr) {
+    return false;
+  }
+  // Unbuffered: several regions may share the file
+  setvbuf(_file, nullptr, _IONBF, 0);
+  // Erased up to the region end
+  fseek(_file, 0, SEEK_END);
+  unsigned long length = ftell(_file);
+  while (length < offset + size) {
+    fputc(0xFF, _file);
+    length++;
+  }
+  fflush(_file);
+  _offset = offset;
+  _size = size;
+  return true;
+}
+
+bool FlashRegion::read (unsigned long address, void* buffer, unsigned int length) {
+  if (!_file || !_contains(address, length)) {
+    return false;
+  }
+  fseek(_file, _offset + address, SEEK_SET);
+  return fread(buffer, 1, length, _file) == length;
+}
+
+bool FlashRegion::write (unsigned long address, const void* buffer, unsigned int length) {
+  if (!_file || !_contains(address, length)) {
+    return false;
+  }
+  // As NOR flash: bits only go from 1 to 0
+  const uint8_t* bytes = (const uint8_t*)buffer;
+  uint8_t chunk[64];
+  while (length > 0) {
+    const unsigned int count = length < sizeof(chunk) ? length : sizeof(chunk);
+    fseek(_file, _offset + address, SEEK_SET);
+    if (fread(chunk, 1, count, _file) != count) {
+      return false;
+    }
+    for (unsigned int i = 0; i < count; i++) {
+      chunk[i] &= bytes[i];
+    }
+    fseek(_file, _offset + address, SEEK_SET);
+    if (fwrite(chunk, 1, count, _file) != count) {
+      return false;
+    }
+    address += count;
+    bytes += count;
+    length -= count;
+  }
+  fflush(_file);
+  return true;
+}
+
+bool FlashRegion::erase (unsigned long address, unsigned long length) {
+  if (!_file || !_contains(address, length) || address % SECTOR_SIZE != 0 || length % SECTOR_SIZE != 0) {
+    return false;
+  }
+  fseek(_file, _offset + address, SEEK_SET);
+  for (unsigned long i = 0; i < length; i++) {
+    fputc(0xFF, _file);
+  }
+  fflush(_file);
+  return true;
+}
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef FLASH_REGION_H
+#define FLASH_REGION_H
+
+#include <Arduino.h>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_partition.h>
+#else
+#include <stdio.h>
+#endif
+
+/**
+ * FlashRegion class
+ *
+ * A region of NOR flash: erased by sectors (all bytes to 0xFF), written by
+ * bytes (bits can only go from 1 to 0). Nothing is allocated: reads and
+ * writes go straight to the flash.
+ *
+ * On the ESP32, it is a range of a data partition (by label). On a host
+ * build, it is a range of a plain file that behaves the same way, so that
+ * what is stored in flash can be tested and benchmarked on a computer.
+ * Addresses are relative to the start of the region.
+ */
+class FlashRegion {
+  public:
+    /**
+     * Erase unit (bytes)
+     */
+    static const unsigned int SECTOR_SIZE = 4096;
+    /**
+     * Program unit (bytes): writing a whole page costs a single program
+     * operation
+     */
+    static const unsigned int PAGE_SIZE = 256;
+
+    /**
+     * Open the region ("size" bytes from "offset" in the storage)
+     *
+     * @param name The partition label (ESP32) or the file path (host build)
+     * @param offset The region start in the storage (multiple of SECTOR_SIZE)
+     * @param size The region size, in bytes (multiple of SECTOR_SIZE)
+     * @return false if the storage is not found or too small
+     */
+    bool begin (const char* name, unsigned long offset, unsigned long size);
+
+    /**
+     * Region size (0 if not opened)
+     */
+    unsigned long size () const;
+
+    /**
+     * Read bytes
+     *
+     * @param address The offset in the region
+     * @param buffer Where to read them
+     * @param length The number of bytes
+     */
+    bool read (unsigned long address, void* buffer, unsigned int length);
+
+    /**
+     * Write bytes (over erased bytes)
+     *
+     * @param address The offset in the region
+     * @param buffer The bytes
+     * @param length The number of bytes
+     */
+    bool write (unsigned long address, const void* buffer, unsigned int length);
+
+    /**
+     * Erase whole sectors
+     *
+     * @param address The offset in the region (multiple of SECTOR_SIZE)
+     * @param length The number of bytes (multiple of SECTOR_SIZE)
+     */
+    bool erase (unsigned long address, unsigned long length);
+
+  private:
+#ifdef ARDUINO_ARCH_ESP32
+    const esp_partition_t* _partition = nullptr;
+#else
+    FILE* _file = nullptr;
+#endif
+    unsigned long _offset = 0;
+    unsigned long _size = 0;
+
+    /**
+     * To know if a range is in the region
+     */
+    bool _contains (unsigned long address, unsigned long length) const;
+};
+
+#endif
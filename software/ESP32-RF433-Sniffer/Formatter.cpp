@@ -0,0 +1,129 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#include <limits>
+#include "Formatter.h"
+#include "HeapFree.h"
+
+// "00" to "99": two digits per division
+static const char DIGIT_PAIRS[] =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+void Formatter::print (const char* text) {
+  _append(text, strlen(text));
+}
+
+void Formatter::print (const __FlashStringHelper* text) {
+  // Flash is memory mapped on ESP32
+  print(reinterpret_cast<const char*>(text));
+}
+
+void Formatter::print (char c) {
+  _append(&c, 1);
+}
+
+void Formatter::write (const char* bytes, unsigned int length) {
+  _append(bytes, length);
+}
+
+void Formatter::print (unsigned long value) {
+  // Written backwards, from the last digits (20 on a 64 bits host)
+  char digits[std::numeric_limits<unsigned long>::digits10 + 1];
+  char* p = digits + sizeof(digits);
+  while (value >= 100) {
+    const char* pair = DIGIT_PAIRS + (value % 100) * 2;
+    value /= 100;
+    *--p = pair[1];
+    *--p = pair[0];
+  }
+  if (value >= 10) {
+    const char* pair = DIGIT_PAIRS + value * 2;
+    *--p = pair[1];
+    *--p = pair[0];
+  } else {
+    *--p = '0' + value;
+  }
+  _append(p, digits + sizeof(digits) - p);
+}
+
+void Formatter::print (unsigned int value) {
+  print((unsigned long)value);
+}
+
+void Formatter::print (long value) {
+  if (value < 0) {
+    print('-');
+    print(0UL - (unsigned long)value);
+  } else {
+    print((unsigned long)value);
+  }
+}
+
+void Formatter::print (int value) {
+  print((long)value);
+}
+
+void Formatter::println () {
+  _append("\r\n", 2);
+}
+
+const char* Formatter::data () const {
+  return _buffer;
+}
+
+unsigned int Formatter::length () const {
+  return _length;
+}
+
+bool Formatter::overflow () const {
+  return _overflow;
+}
+
+void Formatter::beginOptional () {
+  _optionalStart = _length;
+  _optionalEnd = _length;
+}
+
+void Formatter::endOptional () {
+  _optionalEnd = _length;
+}
+
+unsigned int Formatter::optionalStart () const {
+  return _optionalStart;
+}
+
+unsigned int Formatter::optionalEnd () const {
+  return _optionalEnd;
+}
+
+void Formatter::clear () {
+  _length = 0;
+  _overflow = false;
+  _optionalStart = 0;
+  _optionalEnd = 0;
+}
+
+size_t Formatter::flush (Print& out) {
+  size_t written = _length > 0 ? out.write((const uint8_t*)_buffer, _length) : 0;
+  clear();
+  return written;
+}
+
+void Formatter::_append (const char* text, unsigned int length) {
+  if (length > SIZE - _length) {
+    length = SIZE - _length;
+    _overflow = true;
+  }
+  memcpy(_buffer + _length, text, length);
+  _length += length;
+}
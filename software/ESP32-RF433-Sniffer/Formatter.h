@@ -0,0 +1,110 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef FORMATTER_H
+#define FORMATTER_H
+
+#include <Arduino.h>
+#include <RCSwitch.h>
+
+/**
+ * Formatter class
+ *
+ * Renders text in a fixed buffer with the same print/println functions as
+ * Serial, then writes it in one call (one UART driver call instead of one
+ * per value). Numbers are converted two digits at a time with a table.
+ * No allocation: when the buffer is full, the text is truncated.
+ */
+class Formatter {
+  public:
+    /**
+     * Buffer size: fits a verbose type 1 frame with its raw timings (up to
+     * 6 characters per timing, for the longest frame)
+     */
+    static const unsigned int SIZE = 512 + RCSWITCH_MAX_CHANGES * 6;
+
+    /**
+     * Append text
+     */
+    void print (const char* text);
+    void print (const __FlashStringHelper* text);
+    void print (char c);
+    /**
+     * Append bytes (binary output)
+     */
+    void write (const char* bytes, unsigned int length);
+    /**
+     * Append a number (decimal)
+     */
+    void print (unsigned long value);
+    void print (unsigned int value);
+    void print (long value);
+    void print (int value);
+
+    /**
+     * Append a line ending ("\r\n", as Serial.println)
+     */
+    void println ();
+    /**
+     * Append a value and a line ending
+     */
+    template<typename T> void println (T value) {
+      print(value);
+      println();
+    }
+
+    /**
+     * The rendered text (not null-terminated)
+     */
+    const char* data () const;
+    /**
+     * Length of the rendered text
+     */
+    unsigned int length () const;
+    /**
+     * If text has been truncated since last clear
+     */
+    bool overflow () const;
+
+    /**
+     * Start/end of the optional section (e.g. raw timings), that an output
+     * queue may drop when full. One per frame.
+     */
+    void beginOptional ();
+    void endOptional ();
+    /**
+     * Offsets of the optional section (equal: none)
+     */
+    unsigned int optionalStart () const;
+    unsigned int optionalEnd () const;
+
+    /**
+     * Clear the buffer
+     */
+    void clear ();
+
+    /**
+     * Write the rendered text in one call, then clear the buffer
+     *
+     * @param out The output (Serial)
+     * @return The number of bytes written
+     */
+    size_t flush (Print& out);
+
+  private:
+    char _buffer[SIZE];
+    unsigned int _length = 0;
+    bool _overflow = false;
+    unsigned int _optionalStart = 0;
+    unsigned int _optionalEnd = 0;
+
+    void _append (const char* text, unsigned int length);
+};
+
+#endif
@@ -0,0 +1,231 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef GPIO_H
+#define GPIO_H
+
+#include <Arduino.h>
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+#endif
+
+// GPIO access policies (HAL)
+//
+// A policy provides, for a pin known at compile time:
+// - setup<PIN>() : configure the pin as output
+// - high<PIN>() / low<PIN>() : drive the pin
+// - now() : current time (in microseconds)
+// - waitUntil(deadline) : wait until now() reaches deadline
+// - SLEEP_MIN : shortest level (in microseconds) whose wait sleeps instead of
+//   busy waiting, 0 if the policy never sleeps
+
+#if defined(ESP32)
+/**
+ * ESP32 policy: writes the GPIO set/clear registers directly (a single store per edge)
+ */
+struct Esp32GpioHal {
+  // Long waits (e.g. the sync gap of a frame) sleep whole ticks, and wake up
+  // SLEEP_MARGIN before the deadline at least, to busy wait the rest: the
+  // lower priority tasks of the core (and its idle task, which feeds the
+  // watchdog) run during a transmission, without delaying any edge
+  static constexpr unsigned long SLEEP_TICK = portTICK_PERIOD_MS * 1000UL;
+  static constexpr unsigned long SLEEP_MARGIN = 300;
+  static constexpr unsigned long SLEEP_MIN = SLEEP_TICK + 2 * SLEEP_MARGIN;
+
+  template <uint8_t PIN>
+  static inline void setup () {
+    pinMode(PIN, OUTPUT);
+  }
+
+  template <uint8_t PIN>
+  static inline void high () {
+    if constexpr (PIN < 32) {
+      REG_WRITE(GPIO_OUT_W1TS_REG, 1UL << PIN);
+    } else {
+      REG_WRITE(GPIO_OUT1_W1TS_REG, 1UL << (PIN - 32));
+    }
+  }
+
+  template <uint8_t PIN>
+  static inline void low () {
+    if constexpr (PIN < 32) {
+      REG_WRITE(GPIO_OUT_W1TC_REG, 1UL << PIN);
+    } else {
+      REG_WRITE(GPIO_OUT1_W1TC_REG, 1UL << (PIN - 32));
+    }
+  }
+
+  static inline unsigned long now () {
+    return micros();
+  }
+
+  static inline void waitUntil (unsigned long deadline) {
+    long remaining = (long)(deadline - micros());
+    if (remaining >= (long)(SLEEP_TICK + SLEEP_MARGIN)) {
+      // Sleeps n ticks at most
+      vTaskDelay((remaining - SLEEP_MARGIN) / SLEEP_TICK);
+      remaining = (long)(deadline - micros());
+    }
+    if (remaining > 0) {
+      delayMicroseconds(remaining);
+    }
+  }
+};
+#endif
+
+/**
+ * Portable policy, through digitalWrite
+ */
+struct ArduinoGpioHal {
+  // Busy waits only (delay() does not let other tasks run on every platform)
+  static constexpr unsigned long SLEEP_MIN = 0;
+
+  template <uint8_t PIN>
+  static inline void setup () {
+    pinMode(PIN, OUTPUT);
+  }
+
+  template <uint8_t PIN>
+  static inline void high () {
+    digitalWrite(PIN, HIGH);
+  }
+
+  template <uint8_t PIN>
+  static inline void low () {
+    digitalWrite(PIN, LOW);
+  }
+
+  static inline unsigned long now () {
+    return micros();
+  }
+
+  static inline void waitUntil (unsigned long deadline) {
+    long remaining = (long)(deadline - micros());
+    if (remaining > 0) {
+      delayMicroseconds(remaining);
+    }
+  }
+};
+
+/**
+ * Host shim policy: records the level changes instead of driving a pin,
+ * on a virtual clock (waitUntil() returns immediately).
+ * Levels are recorded as seen on the pin, i.e. after OutputPin polarity.
+ *
+ * @tparam CAPACITY Maximum number of recorded edges
+ */
+template <unsigned int CAPACITY>
+struct TraceGpioHal {
+  // Never sleeps: waits only move the virtual clock
+  static constexpr unsigned long SLEEP_MIN = 0;
+  // Virtual clock (in microseconds)
+  static inline unsigned long clock = 0;
+  // Timestamp of each recorded edge
+  static inline unsigned long edges[CAPACITY];
+  // Level set by each recorded edge
+  static inline bool levels[CAPACITY];
+  // Number of recorded edges
+  static inline unsigned int count = 0;
+  // Current level of the pin (idle low)
+  static inline bool level = false;
+  // Edges dropped because the trace was full
+  static inline unsigned int overflows = 0;
+
+  /**
+   * Clear the trace (the clock keeps running)
+   */
+  static void clear () {
+    count = 0;
+    overflows = 0;
+  }
+
+  template <uint8_t PIN>
+  static inline void setup () {
+    // Nothing to configure
+  }
+
+  template <uint8_t PIN>
+  static inline void high () {
+    record(true);
+  }
+
+  template <uint8_t PIN>
+  static inline void low () {
+    record(false);
+  }
+
+  static inline unsigned long now () {
+    return clock;
+  }
+
+  static inline void waitUntil (unsigned long deadline) {
+    if ((long)(deadline - clock) > 0) {
+      clock = deadline;
+    }
+  }
+
+  static inline void record (bool newLevel) {
+    // Only level changes are edges
+    if (newLevel == level) {
+      return;
+    }
+    level = newLevel;
+    if (count == CAPACITY) {
+      overflows++;
+      return;
+    }
+    edges[count] = clock;
+    levels[count] = newLevel;
+    count++;
+  }
+};
+
+#if defined(ESP32)
+typedef Esp32GpioHal DefaultGpioHal;
+#else
+typedef ArduinoGpioHal DefaultGpioHal;
+#endif
+
+/**
+ * Output pin known at compile time
+ *
+ * @tparam PIN GPIO pin number
+ * @tparam INVERTED If true, the pin is low when active (e.g. inverting driver stage)
+ * @tparam HAL The GPIO access policy
+ */
+template <uint8_t PIN, bool INVERTED = false, class HAL = DefaultGpioHal>
+struct OutputPin {
+  typedef HAL Hal;
+
+  /**
+   * Configure the pin as output, inactive
+   */
+  static inline void begin () {
+    HAL::template setup<PIN>();
+    write(false);
+  }
+
+  /**
+   * Set the pin active or inactive
+   *
+   * @param active The logical level
+   */
+  static inline void write (bool active) {
+    if (active != INVERTED) {
+      HAL::template high<PIN>();
+    } else {
+      HAL::template low<PIN>();
+    }
+  }
+};
+
+#endif
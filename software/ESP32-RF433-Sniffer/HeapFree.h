@@ -0,0 +1,22 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef HEAP_FREE_H
+#define HEAP_FREE_H
+
+#include "Config.h"
+
+// Heap-free build (see Config.h): any use of the allocator below is a compile
+// error. Included last by every sketch source, after the headers that are
+// allowed to allocate (system headers, libraries, placement new).
+#if HEAP_FREE_BUILD
+#pragma GCC poison new delete malloc calloc realloc free strdup String
+#endif
+
+#endif
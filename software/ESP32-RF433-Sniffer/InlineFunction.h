@@ -0,0 +1,85 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef INLINE_FUNCTION_H
+#define INLINE_FUNCTION_H
+
+#include <Arduino.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Default capacity of an InlineFunction (in bytes): a Type2Data captured by value
+ */
+const unsigned int INLINE_FUNCTION_CAPACITY = 32;
+
+template <class Signature, unsigned int CAPACITY = INLINE_FUNCTION_CAPACITY>
+class InlineFunction;
+
+/**
+ * InlineFunction class
+ *
+ * Callable (function pointer or lambda) stored inline, in CAPACITY bytes:
+ * never allocates. Captures must fit in CAPACITY and be trivially copyable
+ * (values, pointers, "this"), which is checked at compile time.
+ * Calling it is a single indirect call.
+ */
+template <class R, class... Args, unsigned int CAPACITY>
+class InlineFunction<R(Args...), CAPACITY> {
+  public:
+    /**
+     * Empty callable
+     */
+    InlineFunction () {}
+    InlineFunction (std::nullptr_t) {}
+
+    /**
+     * Store a callable
+     *
+     * @param callable The function pointer or lambda
+     */
+    template <class F, class = typename std::enable_if<!std::is_same<typename std::decay<F>::type, InlineFunction>::value>::type>
+    InlineFunction (F&& callable) {
+      typedef typename std::decay<F>::type Callable;
+      static_assert(sizeof(Callable) <= CAPACITY, "InlineFunction: captures too large (see INLINE_FUNCTION_CAPACITY)");
+      static_assert(alignof(Callable) <= 8, "InlineFunction: captures alignment not supported");
+      static_assert(std::is_trivially_copyable<Callable>::value && std::is_trivially_destructible<Callable>::value,
+        "InlineFunction: captures must be trivially copyable (values, pointers)");
+      new (_storage) Callable(std::forward<F>(callable));
+      _invoke = [](const void* storage, Args... args) -> R {
+        return (*(Callable*)storage)(std::forward<Args>(args)...);
+      };
+    }
+
+    InlineFunction& operator= (std::nullptr_t) {
+      _invoke = nullptr;
+      return *this;
+    }
+
+    /**
+     * If a callable is stored
+     */
+    explicit operator bool () const {
+      return _invoke != nullptr;
+    }
+
+    /**
+     * Call it (must not be empty)
+     */
+    R operator() (Args... args) const {
+      return _invoke(_storage, std::forward<Args>(args)...);
+    }
+
+  private:
+    alignas(8) uint8_t _storage[CAPACITY];
+    R (*_invoke)(const void* storage, Args... args) = nullptr;
+};
+
+#endif
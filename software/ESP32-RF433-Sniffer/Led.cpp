@@ -10,21 +10,15 @@
 #include <Arduino.h>
 #include "Led.h"
 #include "Config.h"
+#include "HeapFree.h"
 
 // Led class constructor
-Led::Led(RGBCC* rgbLed) : _rgbLed(rgbLed) {
+Led::Led(RGBCC* rgbLed, TimerWheel& timers) : _rgbLed(rgbLed), _timers(timers) {
   // ...
 }
 
 void Led::update() {
   _rgbLed->update();
-
-  if (_timerActive && (millis() - _timerStart >= _duration)) {
-    _timerActive = false;
-    if (_callback) {
-      _callback();
-    }
-  }
 }
 
 void Led::mainMenuState () {
@@ -62,9 +56,8 @@ void Led::receivingState () {
   _rgbLed->blink(25, 25, 8);
 }
 
-void Led::setTimeout (std::function<void()> callback, unsigned long duration) {
-  _timerStart = millis();
-  _duration = duration;
-  _callback = callback;
-  _timerActive = true;
+TimerId Led::setTimeout (InlineFunction<void()> callback, unsigned long duration) {
+  _timers.cancel(_timeout);
+  _timeout = _timers.schedule(callback, duration);
+  return _timeout;
 }
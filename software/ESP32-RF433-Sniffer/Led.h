@@ -10,9 +10,10 @@
 #ifndef LED_H
 #define LED_H
 
-#include <functional>
+#include "InlineFunction.h"
 #include <jled.h>
 #include "RGBCC.h"
+#include "TimerWheel.h"
 
 /**
  * Led class
@@ -23,11 +24,12 @@ class Led {
      * Constructor
      *
      * @param rgbLed The instance of RGBCC
+     * @param timers The timer wheel running the timeouts
      */
-    Led (RGBCC* rgbLed);
+    Led (RGBCC* rgbLed, TimerWheel& timers);
 
     /**
-     * Wrapper for RGBCC.update() and timeout management.
+     * Wrapper for RGBCC.update().
      * Must be called in the "loop".
      */
     void update ();
@@ -62,20 +64,19 @@ class Led {
     void receivingState ();
 
     /**
-     * Do something after the given duration in a non-blocking way
+     * Do something after the given duration in a non-blocking way.
+     * A single timeout is pending: it replaces the previous one.
      *
      * @param callback The callback to execute after the given duration
      * @param duration The duration (in ms)
+     * @return The timer id, or NO_TIMER if no timer is left
      */
-    void setTimeout (std::function<void()> callback, unsigned long duration);
+    TimerId setTimeout (InlineFunction<void()> callback, unsigned long duration);
 
   private:
     RGBCC* _rgbLed;
-
-    unsigned long _timerStart = 0;
-    unsigned long _duration = 0;
-    bool _timerActive = false;
-    std::function<void()> _callback = nullptr;
+    TimerWheel& _timers;
+    TimerId _timeout = NO_TIMER;
 };
 
 #endif
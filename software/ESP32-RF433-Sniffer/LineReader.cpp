@@ -0,0 +1,64 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#include "LineReader.h"
+#include "HeapFree.h"
+
+bool LineReader::read (Stream& stream) {
+  // Previous line has been returned: start a new one
+  if (_complete) {
+    _length = 0;
+    _overflow = false;
+    _complete = false;
+  }
+
+  while (stream.available() > 0) {
+    int c = stream.read();
+    if (c < 0) {
+      break;
+    }
+
+    if (c == '\n' && _afterCR) {
+      // LF of a CR LF pair
+      _afterCR = false;
+      continue;
+    }
+    _afterCR = (c == '\r');
+
+    if (c == '\r' || c == '\n') {
+      _buffer[_length] = '\0';
+      _complete = true;
+      return true;
+    } else if (c == '\b' || c == 0x7F) {
+      // Backspace / DEL
+      if (_length > 0) {
+        _length--;
+      }
+    } else if (_length < SIZE) {
+      _buffer[_length++] = (char)c;
+    } else {
+      // Too long: keep the beginning, drop the rest until end of line
+      _overflow = true;
+    }
+  }
+
+  return false;
+}
+
+char* LineReader::line () {
+  return _buffer;
+}
+
+unsigned int LineReader::length () {
+  return _length;
+}
+
+bool LineReader::overflow () {
+  return _overflow;
+}
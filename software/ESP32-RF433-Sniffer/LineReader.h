@@ -0,0 +1,61 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef LINE_READER_H
+#define LINE_READER_H
+
+#include <Arduino.h>
+
+/**
+ * LineReader class
+ *
+ * Assembles lines from a stream without ever waiting: each call consumes
+ * the bytes already received and tells if a line is complete. Lines end
+ * with CR, LF or CR LF. Backspace removes the last character.
+ */
+class LineReader {
+  public:
+    /**
+     * Maximum line length (without terminator)
+     */
+    static const unsigned int SIZE = 128;
+
+    /**
+     * Read the available bytes, until the end of a line
+     *
+     * @param stream The stream to read (e.g. Serial)
+     * @return true if a line is complete (see line() and overflow())
+     */
+    bool read (Stream& stream);
+
+    /**
+     * The last complete line (null terminated). Valid until next read()
+     */
+    char* line ();
+
+    /**
+     * The last complete line length
+     */
+    unsigned int length ();
+
+    /**
+     * To know if the last complete line was too long (its end is lost)
+     */
+    bool overflow ();
+
+  private:
+    char _buffer[SIZE + 1];
+    unsigned int _length = 0;
+    bool _complete = false;
+    bool _overflow = false;
+    // Last terminator was CR: ignore the LF that may follow
+    bool _afterCR = false;
+};
+
+#endif
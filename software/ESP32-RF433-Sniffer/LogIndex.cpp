@@ -0,0 +1,267 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#include "LogIndex.h"
+#include "HeapFree.h"
+
+// LogIndex class constructor
+LogIndex::LogIndex (CaptureLog& log) : _log(log) {
+  // ...
+}
+
+bool LogIndex::begin () {
+  _ready = _log.isReady() && _log.sectors() <= MAX_SECTORS;
+  memset(_summaries, 0, sizeof(_summaries));
+  _talkerCount = 0;
+  if (!_ready) {
+    return false;
+  }
+  // Oldest record first, as they were appended
+  LogCursor cursor;
+  LogEntry entry;
+  _log.first(cursor);
+  while (_log.next(cursor, entry, nullptr)) {
+    _add(entry);
+  }
+  return true;
+}
+
+bool LogIndex::isReady () const {
+  return _ready;
+}
+
+bool LogIndex::append (const Frame& frame, const RawCapture* raw) {
+  // Records waiting in the log first, in order
+  update();
+  if (!_log.append(frame, raw)) {
+    return false;
+  }
+  // Indexed now if written (not waiting)
+  if (_ready && _log.pending() == 0) {
+    LogEntry entry;
+    entry.frame = frame;
+    entry.boot = _log.boot();
+    entry.address = _log.lastAddress();
+    _add(entry);
+  }
+  return true;
+}
+
+void LogIndex::update () {
+  LogEntry entry;
+  while (_log.writePending(entry)) {
+    if (_ready) {
+      _add(entry);
+    }
+  }
+}
+
+bool LogIndex::clear () {
+  if (!_log.clear()) {
+    return false;
+  }
+  memset(_summaries, 0, sizeof(_summaries));
+  _talkerCount = 0;
+  return true;
+}
+
+void LogIndex::start (LogQuery& query) {
+  // Oldest sector first: the one after the newest, around the ring
+  query.sector = _log.sectors() > 0 ? (_log.head() + 1) % _log.sectors() : 0;
+  query.sectorsLeft = _ready ? _log.sectors() : 0;
+  // No sector opened yet
+  memset(&query.cursor, 0, sizeof(LogCursor));
+}
+
+bool LogIndex::next (LogQuery& query, LogEntry& entry, RawCapture* raw) {
+  while (true) {
+    // Records of the sector being read
+    while (_log.next(query.cursor, entry, raw)) {
+      if (_matches(query, entry)) {
+        return true;
+      }
+    }
+    // Next sector that may hold matching records
+    if (query.sectorsLeft == 0) {
+      return false;
+    }
+    const unsigned int sector = query.sector;
+    query.sector = (query.sector + 1) % _log.sectors();
+    query.sectorsLeft--;
+    if (_mayMatch(query, sector)) {
+      _log.seek(query.cursor, sector);
+      _sectorsRead++;
+    } else {
+      _sectorsSkipped++;
+    }
+  }
+}
+
+bool LogIndex::last (uint32_t key, LogEntry& entry) {
+  if (!_ready) {
+    return false;
+  }
+  // A top talker: its last record is known
+  for (unsigned int i = 0; i < _talkerCount; i++) {
+    if (_talkers[i].key == key) {
+      entry = _talkers[i].last;
+      return true;
+    }
+  }
+  // Newest sector first: the last match of the first sector holding one
+  LogQuery query;
+  query.clear();
+  query.byCode = true;
+  query.key = key;
+  const unsigned int sectors = _log.sectors();
+  unsigned int sector = _log.head();
+  for (unsigned int n = 0; n < sectors; n++) {
+    if (_mayMatch(query, sector)) {
+      _sectorsRead++;
+      bool found = false;
+      LogEntry record;
+      _log.seek(query.cursor, sector);
+      while (_log.next(query.cursor, record, nullptr)) {
+        if (_matches(query, record)) {
+          entry = record;
+          found = true;
+        }
+      }
+      if (found) {
+        return true;
+      }
+    } else {
+      _sectorsSkipped++;
+    }
+    sector = (sector + sectors - 1) % sectors;
+  }
+  return false;
+}
+
+unsigned int LogIndex::talkers () const {
+  return _talkerCount;
+}
+
+const LogTalker& LogIndex::talker (unsigned int rank) const {
+  return _talkers[rank];
+}
+
+unsigned long LogIndex::sectorsRead () const {
+  return _sectorsRead;
+}
+
+unsigned long LogIndex::sectorsSkipped () const {
+  return _sectorsSkipped;
+}
+
+uint32_t LogIndex::key (const Frame& frame) {
+  if (frame.decoder == FRAME_TYPE2) {
+    return key(FRAME_TYPE2, frame.address());
+  }
+  return _hash(frame.decoder, frame.payload);
+}
+
+uint32_t LogIndex::key (uint8_t decoder, uint32_t code) {
+  const uint32_t words[FRAME_PAYLOAD_WORDS] = { code };
+  return _hash(decoder, words);
+}
+
+void LogIndex::_add (const LogEntry& entry) {
+  const unsigned int sector = entry.address / FlashRegion::SECTOR_SIZE;
+  if (sector >= MAX_SECTORS) {
+    return;
+  }
+  SectorSummary& summary = _summaries[sector];
+  if (entry.address % FlashRegion::SECTOR_SIZE == CaptureLog::HEADER_SIZE) {
+    // First record: the sector has been started again
+    memset(&summary, 0, sizeof(SectorSummary));
+    summary.boot = entry.boot;
+  }
+  if (summary.records < 0xFFFF) {
+    summary.records++;
+  }
+  summary.lastTime = entry.frame.timestamp;
+  summary.protocols |= 1UL << (entry.frame.protocol % 32);
+  const uint32_t code = key(entry.frame);
+  for (unsigned int n = 0; n < 2; n++) {
+    const unsigned int bit = _bit(code, n);
+    summary.codes[bit / 32] |= 1UL << (bit % 32);
+  }
+  _count(code, entry);
+}
+
+void LogIndex::_count (uint32_t key, const LogEntry& entry) {
+  unsigned int rank = 0;
+  while (rank < _talkerCount && _talkers[rank].key != key) {
+    rank++;
+  }
+  if (rank == _talkerCount) {
+    if (_talkerCount < TALKERS) {
+      // New talker, least frequent (all counts are at least 1)
+      _talkers[_talkerCount].count = 0;
+      _talkerCount++;
+    } else {
+      // Replaces the least frequent one, and takes its count
+      rank = TALKERS - 1;
+    }
+    _talkers[rank].key = key;
+  }
+  _talkers[rank].count++;
+  _talkers[rank].last = entry;
+  // Still sorted: moved up past the talkers it now outnumbers
+  while (rank > 0 && _talkers[rank - 1].count < _talkers[rank].count) {
+    const LogTalker swapped = _talkers[rank - 1];
+    _talkers[rank - 1] = _talkers[rank];
+    _talkers[rank] = swapped;
+    rank--;
+  }
+}
+
+bool LogIndex::_mayMatch (const LogQuery& query, unsigned int sector) const {
+  if (sector >= MAX_SECTORS) {
+    // Not indexed
+    return true;
+  }
+  const SectorSummary& summary = _summaries[sector];
+  if (summary.records == 0) {
+    return false;
+  }
+  if (query.byProtocol && !(summary.protocols & (1UL << (query.protocol % 32)))) {
+    return false;
+  }
+  if (query.byTime && (summary.boot != query.boot || summary.lastTime < query.since)) {
+    return false;
+  }
+  for (unsigned int n = 0; query.byCode && n < 2; n++) {
+    const unsigned int bit = _bit(query.key, n);
+    if (!(summary.codes[bit / 32] & (1UL << (bit % 32)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LogIndex::_matches (const LogQuery& query, const LogEntry& entry) {
+  return (!query.byProtocol || entry.frame.protocol == query.protocol) &&
+    (!query.byTime || (entry.boot == query.boot && entry.frame.timestamp >= query.since)) &&
+    (!query.byCode || key(entry.frame) == query.key);
+}
+
+uint32_t LogIndex::_hash (uint8_t decoder, const uint32_t* code) {
+  uint32_t hash = (2166136261UL ^ decoder) * 16777619UL;
+  const uint8_t* bytes = (const uint8_t*)code;
+  for (unsigned int i = 0; i < FRAME_PAYLOAD_WORDS * 4; i++) {
+    hash = (hash ^ bytes[i]) * 16777619UL;
+  }
+  return hash;
+}
+
+unsigned int LogIndex::_bit (uint32_t key, unsigned int n) {
+  return (key >> (n * 16)) & 0xFF;
+}
@@ -0,0 +1,229 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef LOG_INDEX_H
+#define LOG_INDEX_H
+
+#include <Arduino.h>
+#include "Data.h"
+#include "CaptureLog.h"
+
+// Capture log index ("LOG LAST", "LOG PROTO" and "LOG TOP" commands):
+// summaries of the log sectors and of the most frequent codes, kept in RAM
+// and updated on each append, so that a query only reads the sectors that may
+// hold what it looks for. Records are then read one at a time: nothing is
+// loaded in RAM.
+//
+// Sector summary (a sector is a time bucket: records of a single boot, in
+// time order):
+//   boot, time of the last record, number of records
+//   protocols : bit "protocol % 32" set for each record (type 2: protocol 0)
+//   codes     : Bloom filter of the code keys (2 bits of 256 per key)
+// A summary is reset when the first record of its sector is indexed (the
+// sector has been erased and started again).
+//
+// Code key: hash of the decoder and the payload. For type 2, the address
+// only: all the units and commands of a remote are the same code.
+//
+// Top talkers: the TALKERS most frequent code keys, sorted by count, with the
+// last record of each ("space saving": a new key replaces the least frequent
+// one and takes its count + 1, so that a count is an upper bound).
+//
+// The index is built when the log is opened (the whole log is read once).
+
+/**
+ * A frequent code
+ */
+struct LogTalker {
+  // Code key (see LogIndex::key)
+  uint32_t key;
+  // Records of this code (upper bound)
+  uint32_t count;
+  // Its last record (it may have been erased from the log since)
+  LogEntry last;
+};
+
+/**
+ * A query over the log (see LogIndex::start)
+ */
+struct LogQuery {
+  // Records of a protocol (type 2: protocol 0)
+  bool byProtocol;
+  uint8_t protocol;
+  // Records of a code key (see LogIndex::key)
+  bool byCode;
+  uint32_t key;
+  // Records of a boot, from a time (millis since that boot)
+  bool byTime;
+  uint32_t boot;
+  uint32_t since;
+
+  // Sector being read, sectors left to read
+  unsigned int sector;
+  unsigned int sectorsLeft;
+  LogCursor cursor;
+
+  // Clear query (no filter)
+  void clear() {
+    memset(this, 0, sizeof(LogQuery));
+  }
+};
+
+/**
+ * LogIndex class
+ *
+ * Secondary indexes of the capture log (see above). Records are appended
+ * through it, so that they are indexed. Nothing is allocated.
+ */
+class LogIndex {
+  public:
+    /**
+     * Maximum number of sectors of the log
+     */
+    static const unsigned int MAX_SECTORS = 64;
+    /**
+     * Number of top talkers
+     */
+    static const unsigned int TALKERS = 16;
+
+    /**
+     * Constructor
+     *
+     * @param log The indexed log
+     */
+    LogIndex (CaptureLog& log);
+
+    /**
+     * Build the index (the log must be opened)
+     *
+     * @return false if the log is not available or too large
+     */
+    bool begin ();
+
+    /**
+     * To know if the index is available
+     */
+    bool isReady () const;
+
+    /**
+     * Append a decoded signal to the log, and index it (once written, see
+     * update)
+     *
+     * @param frame The decoded signal
+     * @param raw Its raw timings (type 1), or nullptr
+     * @return false if it could not be written
+     */
+    bool append (const Frame& frame, const RawCapture* raw);
+
+    /**
+     * Write and index the records waiting in the log (see
+     * CaptureLog::pending), to be called from the "loop"
+     */
+    void update ();
+
+    /**
+     * Erase the whole log and its index
+     */
+    bool clear ();
+
+    /**
+     * Start a query: matching records are read from the oldest
+     *
+     * @param query The query (filters set)
+     */
+    void start (LogQuery& query);
+
+    /**
+     * Read the next matching record
+     *
+     * @param query The query
+     * @param entry The record
+     * @param raw Its raw timings (count 0 if none), or nullptr to skip them
+     * @return false when there is no more record
+     */
+    bool next (LogQuery& query, LogEntry& entry, RawCapture* raw);
+
+    /**
+     * Find the last record of a code
+     *
+     * @param key The code key
+     * @param entry The record
+     * @return false if the code has never been seen
+     */
+    bool last (uint32_t key, LogEntry& entry);
+
+    /**
+     * Top talkers, the most frequent first
+     */
+    unsigned int talkers () const;
+    const LogTalker& talker (unsigned int rank) const;
+
+    /**
+     * Counters since boot: sectors read and skipped by queries
+     */
+    unsigned long sectorsRead () const;
+    unsigned long sectorsSkipped () const;
+
+    /**
+     * Code key of a frame
+     */
+    static uint32_t key (const Frame& frame);
+
+    /**
+     * Code key of a type 1 code (32 bits at most) or of a type 2 address
+     *
+     * @param decoder FRAME_TYPE1 or FRAME_TYPE2
+     * @param code The code or the address
+     */
+    static uint32_t key (uint8_t decoder, uint32_t code);
+
+  private:
+    struct SectorSummary {
+      uint32_t boot;
+      uint32_t lastTime;
+      uint32_t protocols;
+      uint32_t codes[8];
+      uint16_t records;
+    };
+
+    CaptureLog& _log;
+    bool _ready = false;
+    SectorSummary _summaries[MAX_SECTORS];
+    LogTalker _talkers[TALKERS];
+    unsigned int _talkerCount = 0;
+    unsigned long _sectorsRead = 0;
+    unsigned long _sectorsSkipped = 0;
+
+    /**
+     * Index a record of the log
+     */
+    void _add (const LogEntry& entry);
+    /**
+     * Count a record in the top talkers
+     */
+    void _count (uint32_t key, const LogEntry& entry);
+    /**
+     * To know if a sector may hold records of a query (from its summary)
+     */
+    bool _mayMatch (const LogQuery& query, unsigned int sector) const;
+    /**
+     * To know if a record matches a query
+     */
+    static bool _matches (const LogQuery& query, const LogEntry& entry);
+    /**
+     * Hash of a decoder and a code (FNV-1a)
+     */
+    static uint32_t _hash (uint8_t decoder, const uint32_t* code);
+    /**
+     * Bits of a code key in a Bloom filter
+     */
+    static unsigned int _bit (uint32_t key, unsigned int n);
+};
+
+#endif
@@ -0,0 +1,259 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef OUTPUT_QUEUE_H
+#define OUTPUT_QUEUE_H
+
+#include <Arduino.h>
+#include "Formatter.h"
+
+/**
+ * What to do when a frame doesn't fit in the output queue
+ */
+enum OutputPolicy {
+  // Drop the oldest frames to make room
+  OUTPUT_DROP_OLDEST,
+  // Drop the raw section (timings) of the new frame, then the frame itself
+  OUTPUT_DROP_RAW,
+  // Drop a frame identical to the last queued one (same key), then the new frame
+  OUTPUT_COALESCE
+};
+
+/**
+ * Text replacing a dropped raw section
+ */
+const char OUTPUT_DROPPED_RAW[] = "(dropped)";
+
+/**
+ * OutputQueue class
+ *
+ * Output queue in front of the serial port: frames (rendered by a
+ * Formatter) are copied in a ring of SIZE bytes, and written as the
+ * serial port can take them, without ever blocking the producer.
+ * Up to MAX_FRAMES frames are queued. When a frame doesn't fit, the policy
+ * applies and dropped frames and bytes are counted.
+ */
+template <unsigned int SIZE, unsigned int MAX_FRAMES>
+class OutputQueue {
+  public:
+    /**
+     * Constructor
+     *
+     * @param policy What to do when a frame doesn't fit
+     */
+    OutputQueue (OutputPolicy policy) : _policy(policy) {}
+
+    /**
+     * Queue a frame, then clear it
+     *
+     * @param frame The rendered frame
+     * @param key Identifies the frame content for OUTPUT_COALESCE (0: never coalesced)
+     * @return false if the frame has been dropped (or coalesced)
+     */
+    bool push (Formatter& frame, uint32_t key = 0) {
+      unsigned int length = frame.length();
+      if (length == 0) {
+        return true;
+      }
+
+      // Same as the last queued frame, not being written yet
+      if (_policy == OUTPUT_COALESCE && key != 0 && _count > 0 &&
+          _frames[_last()].key == key && !(_count == 1 && _sent > 0)) {
+        _coalesced++;
+        frame.clear();
+        return false;
+      }
+
+      bool strip = false;
+      if (!_fits(length)) {
+        if (_policy == OUTPUT_DROP_OLDEST) {
+          // A frame being written is completed: drop the next one
+          unsigned int oldest = _sent > 0 ? 1 : 0;
+          while (_count > oldest && !_fits(length)) {
+            _drop(oldest);
+          }
+        } else if (_policy == OUTPUT_DROP_RAW && frame.optionalEnd() > frame.optionalStart()) {
+          strip = true;
+          length = length - (frame.optionalEnd() - frame.optionalStart()) + strlen(OUTPUT_DROPPED_RAW);
+        }
+      }
+      if (!_fits(length)) {
+        _droppedFrames++;
+        _droppedBytes += frame.length();
+        frame.clear();
+        return false;
+      }
+
+      if (strip) {
+        _strippedFrames++;
+        _droppedBytes += frame.length() - length;
+        _copy(frame.data(), frame.optionalStart());
+        _copy(OUTPUT_DROPPED_RAW, strlen(OUTPUT_DROPPED_RAW));
+        _copy(frame.data() + frame.optionalEnd(), frame.length() - frame.optionalEnd());
+      } else {
+        _copy(frame.data(), length);
+      }
+      _frames[(_first + _count) % MAX_FRAMES] = { (uint16_t)length, key };
+      _count++;
+      frame.clear();
+      return true;
+    }
+
+    /**
+     * Write what the output can take without blocking
+     *
+     * @param out The output (Serial)
+     */
+    void drain (Print& out) {
+      while (_count > 0) {
+        int available = out.availableForWrite();
+        if (available <= 0) {
+          return;
+        }
+        _writeFirst(out, available);
+      }
+    }
+
+    /**
+     * Write all queued frames, waiting for the output (before a command reply)
+     *
+     * @param out The output (Serial)
+     */
+    void drainAll (Print& out) {
+      while (_count > 0) {
+        _writeFirst(out, SIZE);
+      }
+    }
+
+    /**
+     * Number of queued bytes
+     */
+    unsigned int used () const { return _used; }
+    /**
+     * Number of queued frames
+     */
+    unsigned int count () const { return _count; }
+    /**
+     * Number of frames dropped (they didn't fit)
+     */
+    unsigned long droppedFrames () const { return _droppedFrames; }
+    /**
+     * Number of bytes dropped (frames and raw sections)
+     */
+    unsigned long droppedBytes () const { return _droppedBytes; }
+    /**
+     * Number of frames queued without their raw section
+     */
+    unsigned long strippedFrames () const { return _strippedFrames; }
+    /**
+     * Number of frames dropped as duplicates
+     */
+    unsigned long coalescedFrames () const { return _coalesced; }
+
+    /**
+     * The policy applied when a frame doesn't fit
+     */
+    OutputPolicy policy () const { return _policy; }
+
+    /**
+     * Clear the counters
+     */
+    void resetCounters () {
+      _droppedFrames = 0;
+      _droppedBytes = 0;
+      _strippedFrames = 0;
+      _coalesced = 0;
+    }
+
+  private:
+    struct QueuedFrame {
+      uint16_t length;
+      uint32_t key;
+    };
+
+    OutputPolicy _policy;
+    char _data[SIZE];
+    // First byte to write and number of queued bytes
+    unsigned int _head = 0;
+    unsigned int _used = 0;
+    QueuedFrame _frames[MAX_FRAMES];
+    unsigned int _first = 0;
+    unsigned int _count = 0;
+    // Bytes of the first frame already written
+    unsigned int _sent = 0;
+
+    unsigned long _droppedFrames = 0;
+    unsigned long _droppedBytes = 0;
+    unsigned long _strippedFrames = 0;
+    unsigned long _coalesced = 0;
+
+    unsigned int _last () const {
+      return (_first + _count - 1) % MAX_FRAMES;
+    }
+
+    bool _fits (unsigned int length) const {
+      return _count < MAX_FRAMES && length <= SIZE - _used;
+    }
+
+    void _copy (const char* bytes, unsigned int length) {
+      unsigned int tail = (_head + _used) % SIZE;
+      unsigned int contiguous = min(length, SIZE - tail);
+      memcpy(_data + tail, bytes, contiguous);
+      memcpy(_data, bytes + contiguous, length - contiguous);
+      _used += length;
+    }
+
+    void _popFirst (unsigned int remaining) {
+      _head = (_head + remaining) % SIZE;
+      _used -= remaining;
+      _first = (_first + 1) % MAX_FRAMES;
+      _count--;
+      _sent = 0;
+    }
+
+    /**
+     * Drop the frame at "index" (0: first, 1: the next one)
+     */
+    void _drop (unsigned int index) {
+      _droppedFrames++;
+      if (index == 0) {
+        _droppedBytes += _frames[_first].length;
+        _popFirst(_frames[_first].length);
+        return;
+      }
+      // Move the following frames over the dropped one
+      unsigned int start = (_head + _frames[_first].length - _sent) % SIZE;
+      unsigned int length = _frames[(_first + 1) % MAX_FRAMES].length;
+      unsigned int following = _used - (_frames[_first].length - _sent) - length;
+      for (unsigned int i = 0; i < following; i++) {
+        _data[(start + i) % SIZE] = _data[(start + length + i) % SIZE];
+      }
+      for (unsigned int i = 1; i + 1 < _count; i++) {
+        _frames[(_first + i) % MAX_FRAMES] = _frames[(_first + i + 1) % MAX_FRAMES];
+      }
+      _used -= length;
+      _count--;
+      _droppedBytes += length;
+    }
+
+    void _writeFirst (Print& out, unsigned int available) {
+      unsigned int remaining = _frames[_first].length - _sent;
+      unsigned int chunk = min(min(remaining, available), SIZE - _head);
+      out.write((const uint8_t*)_data + _head, chunk);
+      if (chunk == remaining) {
+        _popFirst(remaining);
+      } else {
+        _head = (_head + chunk) % SIZE;
+        _used -= chunk;
+        _sent += chunk;
+      }
+    }
+};
+
+#endif
@@ -9,12 +9,13 @@
 
 #include <Arduino.h>
 #include "RGBCC.h"
+#include "HeapFree.h"
 
 // See JLed sources for the "forever" value of num_repetitions (kRepeatForever)
 static const uint16_t REPEAT_FOREVER = 65535;
 
 // RGBCC class constructor
-RGBCC::RGBCC (unsigned int rPin, unsigned int gPin, unsigned int bPin) {
+RGBCC::RGBCC (unsigned int rPin, unsigned int gPin, unsigned int bPin) : _ledR(rPin), _ledG(gPin), _ledB(bPin) {
   // Set GPIO pin numbers
   _rPin = rPin;
   _gPin = gPin;
@@ -25,27 +26,22 @@ RGBCC::RGBCC (unsigned int rPin, unsigned int gPin, unsigned int bPin) {
   _gValue = 0;
   _bValue = 0;
 
-  // Create JLed instances
-  _ledR = new JLed(_rPin);
-  _ledG = new JLed(_gPin);
-  _ledB = new JLed(_bPin);
-
   // Turn off immediatly
-  _ledR->Off();
-  _ledG->Off();
-  _ledB->Off();
+  _ledR.Off();
+  _ledG.Off();
+  _ledB.Off();
 }
 
 void RGBCC::breathe (unsigned long duration) {
-  _ledR->Breathe(duration).MaxBrightness(_rValue).Forever();
-  _ledG->Breathe(duration).MaxBrightness(_gValue).Forever();
-  _ledB->Breathe(duration).MaxBrightness(_bValue).Forever();
+  _ledR.Breathe(duration).MaxBrightness(_rValue).Forever();
+  _ledG.Breathe(duration).MaxBrightness(_gValue).Forever();
+  _ledB.Breathe(duration).MaxBrightness(_bValue).Forever();
 }
 
 void RGBCC::blink (unsigned long durationOn, unsigned long durationOff, long repeat) {
-  _ledR->Blink(durationOn, durationOff).MaxBrightness(_rValue).Repeat(repeat < 0 ? REPEAT_FOREVER : repeat);
-  _ledG->Blink(durationOn, durationOff).MaxBrightness(_gValue).Repeat(repeat < 0 ? REPEAT_FOREVER : repeat);
-  _ledB->Blink(durationOn, durationOff).MaxBrightness(_bValue).Repeat(repeat < 0 ? REPEAT_FOREVER : repeat);
+  _ledR.Blink(durationOn, durationOff).MaxBrightness(_rValue).Repeat(repeat < 0 ? REPEAT_FOREVER : repeat);
+  _ledG.Blink(durationOn, durationOff).MaxBrightness(_gValue).Repeat(repeat < 0 ? REPEAT_FOREVER : repeat);
+  _ledB.Blink(durationOn, durationOff).MaxBrightness(_bValue).Repeat(repeat < 0 ? REPEAT_FOREVER : repeat);
 }
 
 void RGBCC::on (float intensity) {
@@ -56,9 +52,9 @@ void RGBCC::on (float intensity) {
   unsigned int finalG = (unsigned int)(_gValue * factor);
   unsigned int finalB = (unsigned int)(_bValue * factor);
 
-  _ledR->On().MaxBrightness(finalR);
-  _ledG->On().MaxBrightness(finalG);
-  _ledB->On().MaxBrightness(finalB);
+  _ledR.On().MaxBrightness(finalR);
+  _ledG.On().MaxBrightness(finalG);
+  _ledB.On().MaxBrightness(finalB);
 }
 
 void RGBCC::color (unsigned int r, unsigned int g, unsigned int b) {
@@ -74,7 +70,7 @@ void RGBCC::color (RGBColor color) {
 }
 
 void RGBCC::update () {
-  _ledR->Update();
-  _ledG->Update();
-  _ledB->Update();
+  _ledR.Update();
+  _ledG.Update();
+  _ledB.Update();
 }
\ No newline at end of file
@@ -91,15 +91,15 @@ class RGBCC {
     /**
      * The JLed object for led red pin
      */
-    JLed* _ledR;
+    JLed _ledR;
     /**
      * The JLed object for led green pin
      */
-    JLed* _ledG;
+    JLed _ledG;
     /**
      * The JLed object for led blue pin
      */
-    JLed* _ledB;
+    JLed _ledB;
     /**
      * Red color value
      */
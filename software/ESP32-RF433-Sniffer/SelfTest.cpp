@@ -0,0 +1,324 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#include <RCSwitch.h>
+#include <NewRemoteReceiver.h>
+#include "SelfTest.h"
+#include "Data.h"
+#include "Waveform.h"
+#include "Transmitter.h"
+#include "Command.h"
+#include "LineReader.h"
+#include "Utils.h"
+#include "Formatter.h"
+#include "CaptureLog.h"
+#include "HeapFree.h"
+
+// Frames are repeated 3 times: both decoders need 2 of them to validate a code
+static const unsigned int LOOPBACK_REPEATS = 3;
+// Maximum jitter applied to each edge, in percent of the base pulse length
+static const unsigned int LOOPBACK_MAX_JITTER = 20;
+// Probability (in percent) that a frame loses one of its pulses
+static const unsigned int LOOPBACK_DROPOUT_RATE = 10;
+// Silence between two frames bursts (in microseconds)
+static const unsigned long LOOPBACK_IDLE = 100000;
+
+// Traced "pin": the transmitter output goes to memory
+typedef TraceGpioHal<WAVEFORM_MAX_LEVELS * LOOPBACK_REPEATS> LoopbackTrace;
+typedef Transmitter<OutputPin<0, false, LoopbackTrace>> LoopbackTransmitter;
+
+// Last type 2 code decoded during the test
+static NewRemoteCode loopbackType2Code;
+static bool loopbackType2Available = false;
+
+/**
+ * xorshift32 pseudo-random generator, to get the same frames on every platform
+ */
+static uint32_t loopbackRandom (uint32_t& state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+/**
+ * Random number in [min, max]
+ */
+static uint32_t loopbackRandom (uint32_t& state, uint32_t min, uint32_t max) {
+  return min + loopbackRandom(state) % (max - min + 1);
+}
+
+static void loopbackType2Callback (NewRemoteCode code) {
+  loopbackType2Code = code;
+  loopbackType2Available = true;
+}
+
+/**
+ * Feed the recorded trace to a decoder, with jitter (in microseconds) and
+ * an optional dropout
+ *
+ * @return The number of edges fed
+ */
+static unsigned int feedTrace (void (*handleEdge)(unsigned long), uint32_t& rng, unsigned int basePulse, unsigned int jitter, bool dropout) {
+  const unsigned int count = LoopbackTrace::count;
+  // A dropout loses a pulse: its two edges disappear
+  const unsigned int dropped = dropout && count > 2 ? loopbackRandom(rng, 0, count - 2) : count;
+  unsigned long last = 0;
+  unsigned int fed = 0;
+  for (unsigned int i = 0; i < count; i++) {
+    if (i == dropped || i == dropped + 1) {
+      continue;
+    }
+    unsigned long time = LoopbackTrace::edges[i];
+    if (jitter > 0) {
+      time = time - jitter + loopbackRandom(rng, 0, 2 * jitter);
+    }
+    // Edges keep their order
+    if (fed > 0 && (long)(time - last) <= 0) {
+      time = last + 1;
+    }
+    handleEdge(time);
+    last = time;
+    fed++;
+  }
+  // Closing pulse, like noise after the burst: ends its last level.
+  // NewRemoteReceiver measures a level one edge late, hence 2 edges.
+  handleEdge(LoopbackTrace::clock);
+  handleEdge(LoopbackTrace::clock + basePulse);
+  LoopbackTrace::clock += basePulse;
+  return fed + 2;
+}
+
+void runLoopbackTest (LoopbackResult& result, unsigned long iterations, unsigned long seed) {
+  const int numProto = min(RCSwitch::getProtocolCount(), LOOPBACK_MAX_TARGETS - 1);
+  // Type 1 protocols, then type 2
+  const int numTargets = numProto + 1;
+  memset(&result, 0, sizeof(LoopbackResult));
+  result.targets = numTargets;
+
+  uint32_t rng = seed ? seed : 1;
+  Waveform waveform;
+
+  // Receivers are fed directly with edges: no interrupt
+  RCSwitch rcSwitch = RCSwitch();
+  NewRemoteReceiver::init(-1, 2, loopbackType2Callback);
+
+  const unsigned long startedAt = micros();
+  for (unsigned long n = 0; n < iterations; n++) {
+    const int target = n % numTargets;
+    const bool dropout = loopbackRandom(rng, 1, 100) <= LOOPBACK_DROPOUT_RATE;
+    unsigned int basePulse;
+    bool ok = false;
+
+    LoopbackTrace::clock += LOOPBACK_IDLE;
+    LoopbackTrace::clear();
+
+    if (target < numProto) {
+      // Type 1: random code, bit length and pulse length (+/- 15%)
+      const RCSwitch::Protocol protocol = RCSwitch::getProtocol(target + 1);
+      Type1Data data;
+      data.clear();
+      data.protocol = target + 1;
+      data.length = loopbackRandom(rng, 4, 32);
+      data.decimal = loopbackRandom(rng) & (0xFFFFFFFFUL >> (32 - data.length));
+      if (data.decimal == 0) {
+        // 0 is never reported by RCSwitch
+        data.decimal = 1;
+      }
+      data.delay = protocol.pulseLength * loopbackRandom(rng, 85, 115) / 100;
+      basePulse = data.delay;
+
+      encodeWaveform(waveform, data);
+      LoopbackTransmitter::play(waveform, LOOPBACK_REPEATS);
+      result.edges += feedTrace(RCSwitch::handleEdge, rng, basePulse, basePulse * loopbackRandom(rng, 0, LOOPBACK_MAX_JITTER) / 100, dropout);
+
+      ok = rcSwitch.available() &&
+        rcSwitch.getReceivedValue() == data.decimal &&
+        rcSwitch.getReceivedBitlength() == data.length;
+      rcSwitch.resetAvailable();
+    } else {
+      // Type 2: random address, unit, group, state, dim level and period
+      Type2Data data;
+      data.clear();
+      data.period = loopbackRandom(rng, 200, 320);
+      data.address = loopbackRandom(rng) & 0x3FFFFFF;
+      data.groupBit = loopbackRandom(rng, 0, 1);
+      data.unit = data.groupBit ? 0 : loopbackRandom(rng, 0, 15);
+      data.switchType = (Type2Data::SwitchType)loopbackRandom(rng, 0, 2);
+      data.dimLevelPresent = data.switchType == Type2Data::dim;
+      data.dimLevel = data.dimLevelPresent ? loopbackRandom(rng, 0, 15) : 0;
+      basePulse = data.period;
+
+      encodeWaveform(waveform, data);
+      loopbackType2Available = false;
+      LoopbackTransmitter::play(waveform, LOOPBACK_REPEATS);
+      result.edges += feedTrace(NewRemoteReceiver::handleEdge, rng, basePulse, basePulse * loopbackRandom(rng, 0, LOOPBACK_MAX_JITTER) / 100, dropout);
+
+      ok = loopbackType2Available &&
+        loopbackType2Code.address == data.address &&
+        loopbackType2Code.unit == data.unit &&
+        loopbackType2Code.groupBit == data.groupBit &&
+        loopbackType2Code.switchType == data.switchType &&
+        loopbackType2Code.dimLevel == data.dimLevel;
+    }
+
+    result.attempts[target]++;
+    if (ok) {
+      result.decoded[target]++;
+    }
+  }
+  result.elapsed = micros() - startedAt;
+
+  NewRemoteReceiver::deinit();
+}
+
+void printLoopbackResult (const LoopbackResult& result) {
+  const int numProto = result.targets - 1;
+  const unsigned long* attempts = result.attempts;
+  const unsigned long* decoded = result.decoded;
+  unsigned long totalAttempts = 0;
+  unsigned long totalDecoded = 0;
+  Serial.println(F("------------ LOOPBACK TEST -------------"));
+  Serial.println(F("Protocol    Frames   Decoded   Rate"));
+  for (int target = 0; target < result.targets; target++) {
+    if (target < numProto) {
+      Serial.print(F("Type 1 #")); Serial.print(target + 1);
+      Serial.print(target + 1 < 10 ? F("     ") : F("    "));
+    } else {
+      Serial.print(F("Type 2        "));
+    }
+    Serial.print(attempts[target]); Serial.print(F("\t"));
+    Serial.print(decoded[target]); Serial.print(F("\t"));
+    Serial.print(attempts[target] ? 100.0f * decoded[target] / attempts[target] : 0.0f, 1); Serial.println(F(" %"));
+    totalAttempts += attempts[target];
+    totalDecoded += decoded[target];
+  }
+  Serial.println(F("----------------------------------------"));
+  Serial.print(F("Total       : ")); Serial.print(totalDecoded); Serial.print(F(" / ")); Serial.print(totalAttempts);
+  Serial.print(F(" (")); Serial.print(totalAttempts ? 100.0f * totalDecoded / totalAttempts : 0.0f, 1); Serial.println(F(" %)"));
+  Serial.print(F("Throughput  : "));
+  Serial.print(result.elapsed ? (float)totalAttempts * 1000000.0f / result.elapsed : 0.0f, 0); Serial.print(F(" frames/s, "));
+  Serial.print(result.elapsed ? (float)result.edges * 1000000.0f / result.elapsed : 0.0f, 0); Serial.println(F(" edges/s"));
+  Serial.println(F("----------------------------------------"));
+}
+
+void benchmarkCommands (BenchmarkResult& result) {
+  // Typical commands: type 1, type 2 with dim level, raw replay, invalid number
+  static const char* const lines[] = {
+    "5592332 1 350 24",
+    "12345678 260 0 1 2 15",
+    "raw 105 i",
+    "5592332 1 35O 24"
+  };
+  const unsigned int numLines = sizeof(lines) / sizeof(lines[0]);
+  char line[LineReader::SIZE + 1];
+  Command command;
+  result.tokens = 0;
+  result.errors = 0;
+
+  const unsigned long startedAt = micros();
+  for (unsigned long n = 0; n < result.iterations; n++) {
+    // Copy as the line reader would: parsing is done in place
+    strcpy(line, lines[n % numLines]);
+    command.parse(line);
+    result.tokens += command.count();
+    for (unsigned int i = 0; i < command.count(); i++) {
+      unsigned long value;
+      if (command.number(i, 0, 0xFFFFFFFF, value) == PARSE_OK) {
+        result.checksum += value;
+      } else if (!command.token(i).equals("RAW") && !command.token(i).equals("I")) {
+        result.errors++;
+      }
+    }
+  }
+  result.parseElapsed = micros() - startedAt;
+}
+
+void benchmarkFormatting (BenchmarkResult& result) {
+  // Decoded signals output: a 24 bits type 1 frame with its raw timings
+  // (protocol 1), then a type 2 frame with dim level
+  Type1Data data1;
+  data1.clear();
+  data1.decimal = 5592332;
+  data1.length = 24;
+  data1.delay = 350;
+  data1.protocol = 1;
+  Frame t1 = createFrame(data1);
+  t1.flags |= FRAME_FLAG_RAW;
+  RawCapture raw;
+  raw.count = data1.length * 2 + 2;
+  raw.timings[0] = 10850;
+  for (unsigned int i = 0; i < data1.length; i++) {
+    const bool bit = (data1.decimal >> (data1.length - 1 - i)) & 1;
+    raw.timings[1 + i * 2] = bit ? 1050 : 350;
+    raw.timings[2 + i * 2] = bit ? 350 : 1050;
+  }
+  raw.timings[raw.count - 1] = 350;
+  Type2Data data2;
+  data2.clear();
+  data2.address = 12345678;
+  data2.period = 260;
+  data2.unit = 1;
+  data2.switchType = Type2Data::dim;
+  data2.dimLevelPresent = true;
+  data2.dimLevel = 15;
+  const Frame t2 = createFrame(data2);
+
+  static Formatter formatter;
+  result.bytes = 0;
+  const unsigned long formatStartedAt = micros();
+  for (unsigned long n = 0; n < result.iterations; n++) {
+    formatter.clear();
+    if (n % 2 == 0) {
+      logData(formatter, t1, &raw);
+    } else {
+      logData(formatter, t2, nullptr);
+    }
+    result.bytes += formatter.length();
+    // Keeps the work from being optimized away
+    result.checksum += formatter.data()[formatter.length() - 3];
+  }
+  result.formatElapsed = micros() - formatStartedAt;
+
+  // Capture log records of the same frames (encoding only, no flash write)
+  static uint8_t record[CaptureLog::MAX_RECORD_SIZE];
+  result.recordBytes = 0;
+  const unsigned long encodeStartedAt = micros();
+  for (unsigned long n = 0; n < result.iterations; n++) {
+    const unsigned int size = n % 2 == 0 ? CaptureLog::encode(record, t1, n, &raw) : CaptureLog::encode(record, t2, n, nullptr);
+    result.recordBytes += size;
+    result.checksum += record[size - 1];
+  }
+  result.encodeElapsed = micros() - encodeStartedAt;
+}
+
+void runBenchmark (unsigned long iterations) {
+  BenchmarkResult result;
+  memset(&result, 0, sizeof(BenchmarkResult));
+  result.iterations = iterations;
+  benchmarkCommands(result);
+  benchmarkFormatting(result);
+
+  Serial.println(F("-------------- BENCHMARK ---------------"));
+  Serial.print(F("Commands    : ")); Serial.print(iterations);
+  Serial.print(F(" (")); Serial.print(result.tokens); Serial.print(F(" tokens, "));
+  Serial.print(result.errors); Serial.println(F(" errors)"));
+  Serial.print(F("Duration    : ")); Serial.print(result.parseElapsed); Serial.println(F(" us"));
+  Serial.print(F("Parsing     : "));
+  Serial.print(result.parseElapsed ? (float)iterations * 1000000.0f / result.parseElapsed : 0.0f, 0); Serial.println(F(" commands/s"));
+  Serial.print(F("Formatting  : "));
+  Serial.print(result.formatElapsed ? (float)iterations * 1000000.0f / result.formatElapsed : 0.0f, 0); Serial.print(F(" frames/s, "));
+  Serial.print(result.formatElapsed ? (float)result.bytes * 1000000.0f / result.formatElapsed : 0.0f, 0); Serial.println(F(" bytes/s"));
+  Serial.print(F("Log records : "));
+  Serial.print(result.encodeElapsed ? (float)iterations * 1000000.0f / result.encodeElapsed : 0.0f, 0); Serial.print(F(" frames/s, "));
+  Serial.print(iterations ? (float)result.recordBytes / iterations : 0.0f, 1); Serial.println(F(" bytes/frame"));
+  // Printed so that the work can't be optimized away
+  Serial.print(F("Checksum    : ")); Serial.println(result.checksum);
+  Serial.println(F("----------------------------------------"));
+}
@@ -0,0 +1,99 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef SELF_TEST_H
+#define SELF_TEST_H
+
+#include <Arduino.h>
+
+// Maximum number of tested protocols (type 1 protocols + type 2)
+const int LOOPBACK_MAX_TARGETS = 16;
+
+/**
+ * Result of a loopback test
+ */
+struct LoopbackResult {
+  // Tested protocols: type 1 protocols 1 to targets - 1, then type 2
+  int targets;
+  // Frames played and decoded (with the right code), per protocol
+  unsigned long attempts[LOOPBACK_MAX_TARGETS];
+  unsigned long decoded[LOOPBACK_MAX_TARGETS];
+  // Edges fed to the decoders
+  unsigned long edges;
+  // Duration of the test (in microseconds)
+  unsigned long elapsed;
+};
+
+/**
+ * Encode-to-decode loopback test.
+ *
+ * Random type 1 (every RCSwitch protocol) and type 2 frames are encoded and
+ * played on a traced pin (no radio involved). The trace, with random jitter
+ * and dropped pulses, is fed to the RCSwitch and NewRemoteReceiver edge
+ * handlers. Also built on the host (see software/test).
+ *
+ * The receivers must be stopped (their state is shared with the test).
+ *
+ * @param result The decode counts per protocol
+ * @param iterations The number of frames to test
+ * @param seed The random seed (same seed, same frames)
+ */
+void runLoopbackTest (LoopbackResult& result, unsigned long iterations, unsigned long seed = 1);
+
+/**
+ * Print the decode success rate per protocol and the throughput of a
+ * loopback test
+ */
+void printLoopbackResult (const LoopbackResult& result);
+
+/**
+ * Result of a benchmark
+ */
+struct BenchmarkResult {
+  // Commands parsed, frames formatted and encoded
+  unsigned long iterations;
+  // Command parsing: tokens, invalid numbers, duration (in microseconds)
+  unsigned long tokens;
+  unsigned long errors;
+  unsigned long parseElapsed;
+  // Decoded signals output: bytes, duration (in microseconds)
+  unsigned long bytes;
+  unsigned long formatElapsed;
+  // Capture log records: bytes, duration (in microseconds)
+  unsigned long recordBytes;
+  unsigned long encodeElapsed;
+  // Sum of the results, so that the work can't be optimized away
+  unsigned long checksum;
+};
+
+/**
+ * Benchmark of the command parsing (split + numbers), as done for each
+ * received line. Also run on the host (see software/test)
+ *
+ * @param result The result (iterations set)
+ */
+void benchmarkCommands (BenchmarkResult& result);
+
+/**
+ * Benchmark of the decoded signals formatting (see Formatter) and of the
+ * capture log records encoding
+ *
+ * @param result The result (iterations set)
+ */
+void benchmarkFormatting (BenchmarkResult& result);
+
+/**
+ * Run both benchmarks and print the number of commands parsed and frames
+ * formatted per second ("BENCH" command)
+ *
+ * @param iterations The number of commands to parse (and frames to format)
+ */
+void runBenchmark (unsigned long iterations);
+
+#endif
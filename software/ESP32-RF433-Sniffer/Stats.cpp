@@ -0,0 +1,195 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#include "Stats.h"
+#include "HeapFree.h"
+
+// Section names, in StatsSection order
+static const char* const SECTION_NAMES[SECTION_COUNT] = {
+  "led",
+  "timers",
+  "serial input",
+  "command",
+  "output",
+  "transmit",
+  "capture log"
+};
+
+/**
+ * Histogram bucket of a duration: number of significant bits
+ */
+static unsigned int bucketOf (unsigned long duration) {
+  unsigned int bucket = 0;
+  while (duration > 0 && bucket < LoopStats::BUCKETS - 1) {
+    duration >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+// LoopStats class constructor
+LoopStats::LoopStats (unsigned long stallThreshold, TimerWheel& timers) : _stallThreshold(stallThreshold), _timers(timers) {
+  reset();
+  _sample();
+}
+
+void LoopStats::beginLoop () {
+  memset(_iteration, 0, sizeof(_iteration));
+  _depth = 0;
+  _loopStartedAt = cycleCount();
+}
+
+void LoopStats::endLoop () {
+  unsigned long duration = (cycleCount() - _loopStartedAt) / cyclesPerMicrosecond();
+  // No timer was left for the next sample: tried again (a late sample
+  // covers the whole time since the previous one)
+  if (_sampleTimer == NO_TIMER) {
+    _scheduleSample();
+  }
+
+  _loops++;
+  _histogram[bucketOf(duration)]++;
+  if (duration > _maxLoop) {
+    _maxLoop = duration;
+  }
+
+  uint8_t longest = SECTION_COUNT;
+  uint32_t longestCycles = 0;
+  for (unsigned int i = 0; i < SECTION_COUNT; i++) {
+    unsigned long own = _iteration[i] / cyclesPerMicrosecond();
+    _sectionTotal[i] += own;
+    if (own > _sectionMax[i]) {
+      _sectionMax[i] = own;
+    }
+    if (_iteration[i] > longestCycles) {
+      longestCycles = _iteration[i];
+      longest = i;
+    }
+  }
+
+  if (duration < _stallThreshold) {
+    return;
+  }
+  // Keep the longest stalls: replace the shortest one
+  unsigned int shortest = 0;
+  for (unsigned int i = 1; i < STALLS; i++) {
+    if (_stalls[i].duration < _stalls[shortest].duration) {
+      shortest = i;
+    }
+  }
+  if (duration > _stalls[shortest].duration) {
+    _stalls[shortest] = { duration, millis(), longest };
+  }
+}
+
+void LoopStats::begin (StatsSection section) {
+  if (_depth == MAX_DEPTH) {
+    return;
+  }
+  _open[_depth++] = { (uint8_t)section, cycleCount(), 0 };
+}
+
+void LoopStats::end () {
+  if (_depth == 0) {
+    return;
+  }
+  const OpenSection& open = _open[--_depth];
+  uint32_t total = cycleCount() - open.startedAt;
+  _iteration[open.section] += total - open.nested;
+  if (_depth > 0) {
+    _open[_depth - 1].nested += total;
+  }
+}
+
+unsigned long LoopStats::loops () const {
+  return _loops;
+}
+
+unsigned long LoopStats::loopRate () const {
+  return _loopRate;
+}
+
+unsigned long LoopStats::maxLoop () const {
+  return _maxLoop;
+}
+
+void LoopStats::reset () {
+  _resetAt = millis();
+  _loops = 0;
+  _sampledLoops = 0;
+  _maxLoop = 0;
+  memset(_histogram, 0, sizeof(_histogram));
+  memset(_sectionMax, 0, sizeof(_sectionMax));
+  memset(_sectionTotal, 0, sizeof(_sectionTotal));
+  for (unsigned int i = 0; i < STALLS; i++) {
+    _stalls[i] = { 0, 0, SECTION_COUNT };
+  }
+}
+
+void LoopStats::_sample () {
+  // Per second, also when sampled late (see endLoop)
+  const unsigned long now = millis();
+  const unsigned long elapsed = now - _sampledAt;
+  _loopRate = elapsed > 0 ? (unsigned long long)(_loops - _sampledLoops) * 1000 / elapsed : 0;
+  _sampledLoops = _loops;
+  _sampledAt = now;
+  _scheduleSample();
+}
+
+void LoopStats::_scheduleSample () {
+  _sampleTimer = _timers.schedule([this]() {
+    _sampleTimer = NO_TIMER;
+    _sample();
+  }, 1000);
+}
+
+void LoopStats::print () {
+  Serial.println(F("---------------- STATS -----------------"));
+  Serial.print(F("Since       : ")); Serial.print((millis() - _resetAt) / 1000); Serial.println(F(" s"));
+  Serial.print(F("Loops       : ")); Serial.print(_loops);
+  Serial.print(F(" (")); Serial.print(_loopRate); Serial.println(F(" /s)"));
+  Serial.print(F("Max loop    : ")); Serial.print(_maxLoop); Serial.println(F(" us"));
+  Serial.println(F("Loop time (us)        Count"));
+  for (unsigned int i = 0; i < BUCKETS; i++) {
+    if (_histogram[i] == 0) {
+      continue;
+    }
+    unsigned long low = i == 0 ? 0 : 1UL << (i - 1);
+    Serial.print(F("  ")); Serial.print(low);
+    if (i == BUCKETS - 1) {
+      Serial.print(F(" or more"));
+    } else if (i > 1) {
+      Serial.print(F(" - ")); Serial.print((1UL << i) - 1);
+    }
+    Serial.print(F("\t: ")); Serial.println(_histogram[i]);
+  }
+  Serial.println(F("Section           Max (us)   Total (ms)"));
+  for (unsigned int i = 0; i < SECTION_COUNT; i++) {
+    Serial.print(F("  ")); Serial.print(SECTION_NAMES[i]);
+    for (size_t n = strlen(SECTION_NAMES[i]); n < 14; n++) {
+      Serial.print(' ');
+    }
+    Serial.print(F(": ")); Serial.print(_sectionMax[i]);
+    Serial.print(F("\t")); Serial.println((unsigned long)(_sectionTotal[i] / 1000));
+  }
+  Serial.print(F("Stalls (>= ")); Serial.print(_stallThreshold / 1000); Serial.println(F(" ms):"));
+  bool none = true;
+  for (unsigned int i = 0; i < STALLS; i++) {
+    if (_stalls[i].duration == 0) {
+      continue;
+    }
+    none = false;
+    Serial.print(F("  ")); Serial.print(_stalls[i].duration / 1000); Serial.print(F(" ms at "));
+    Serial.print(_stalls[i].at / 1000); Serial.print(F(" s, in "));
+    Serial.println(_stalls[i].section < SECTION_COUNT ? SECTION_NAMES[_stalls[i].section] : "-");
+  }
+  if (none) {
+    Serial.println(F("  -"));
+  }
+}
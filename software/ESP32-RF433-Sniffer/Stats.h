@@ -0,0 +1,165 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <Arduino.h>
+#include "TimerWheel.h"
+
+/**
+ * Cycle counter (CPU cycles on ESP32, microseconds elsewhere)
+ */
+inline uint32_t cycleCount () {
+#if defined(ESP32)
+  return ESP.getCycleCount();
+#else
+  return micros();
+#endif
+}
+
+/**
+ * Number of cycleCount() ticks per microsecond
+ */
+inline uint32_t cyclesPerMicrosecond () {
+#if defined(ESP32)
+  return ESP.getCpuFreqMHz();
+#else
+  return 1;
+#endif
+}
+
+/**
+ * Instrumented sections of the "loop"
+ */
+enum StatsSection {
+  SECTION_LED,
+  SECTION_TIMERS,
+  SECTION_SERIAL_INPUT,
+  SECTION_COMMAND,
+  SECTION_OUTPUT,
+  SECTION_TRANSMIT,
+  SECTION_LOG,
+  SECTION_COUNT
+};
+
+/**
+ * LoopStats class
+ *
+ * Measures each "loop" iteration and the sections it is made of, with the
+ * cycle counter. Keeps a histogram of the iteration durations (buckets of
+ * powers of 2 microseconds), the maximum duration of each section and the
+ * longest stalls with the section that took most of the time.
+ *
+ * Sections can be nested: a section only counts its own time (without its
+ * nested sections).
+ */
+class LoopStats {
+  public:
+    /**
+     * Number of histogram buckets: [0], [1], [2..3], [4..7]... [2^22..]
+     */
+    static const unsigned int BUCKETS = 24;
+    /**
+     * Number of stalls kept (the longest ones)
+     */
+    static const unsigned int STALLS = 4;
+
+    /**
+     * Constructor
+     *
+     * @param stallThreshold A loop iteration longer than this is a stall (in microseconds)
+     * @param timers The timer wheel sampling the loop rate
+     */
+    LoopStats (unsigned long stallThreshold, TimerWheel& timers);
+
+    /**
+     * Start of a "loop" iteration
+     */
+    void beginLoop ();
+    /**
+     * End of a "loop" iteration
+     */
+    void endLoop ();
+
+    /**
+     * Start of a section
+     *
+     * @param section The section
+     */
+    void begin (StatsSection section);
+    /**
+     * End of the current section
+     */
+    void end ();
+
+    /**
+     * Number of iterations, iterations per second and longest one (in microseconds)
+     */
+    unsigned long loops () const;
+    unsigned long loopRate () const;
+    unsigned long maxLoop () const;
+
+    /**
+     * Clear all stats
+     */
+    void reset ();
+
+    /**
+     * Print the stats on serial
+     */
+    void print ();
+
+  private:
+    static const unsigned int MAX_DEPTH = 4;
+
+    struct Stall {
+      // Duration (in microseconds)
+      unsigned long duration;
+      // When it ended (millis)
+      unsigned long at;
+      // Section that took most of the time (SECTION_COUNT: none)
+      uint8_t section;
+    };
+
+    struct OpenSection {
+      uint8_t section;
+      uint32_t startedAt;
+      // Cycles spent in nested sections
+      uint32_t nested;
+    };
+
+    unsigned long _stallThreshold;
+    TimerWheel& _timers;
+
+    uint32_t _loopStartedAt = 0;
+    OpenSection _open[MAX_DEPTH];
+    unsigned int _depth = 0;
+    // Own cycles of each section in the current iteration
+    uint32_t _iteration[SECTION_COUNT];
+
+    unsigned long _resetAt = 0;
+    unsigned long _loops = 0;
+    unsigned long _histogram[BUCKETS];
+    unsigned long _maxLoop = 0;
+    unsigned long _sectionMax[SECTION_COUNT];
+    unsigned long long _sectionTotal[SECTION_COUNT];
+    Stall _stalls[STALLS];
+
+    // Loops per second, sampled every second
+    TimerId _sampleTimer = NO_TIMER;
+    unsigned long _sampledAt = 0;
+    unsigned long _sampledLoops = 0;
+    unsigned long _loopRate = 0;
+
+    void _sample ();
+    void _scheduleSample ();
+};
+
+#endif
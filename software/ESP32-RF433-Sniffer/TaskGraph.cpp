@@ -0,0 +1,224 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#include <NewRemoteReceiver.h>
+#include "TaskGraph.h"
+#include "Gpio.h"
+#include "Transmitter.h"
+#include "HeapFree.h"
+
+Queue<unsigned long, EDGE_QUEUE_SIZE> edgeQueue;
+Queue<Frame, FRAME_QUEUE_SIZE> frameQueue;
+
+// Raw timings of the type 1 frames. Slots for the queued frames, the frame
+// handled by the "loop" and the one being captured: a slot is never
+// overwritten before its frame is handled (the capture only moves to the next
+// slot once its frame is queued).
+static const unsigned int RAW_CAPTURE_SLOTS = FRAME_QUEUE_SIZE + 2;
+static_assert(RAW_CAPTURE_SLOTS <= 256, "Frame::rawSlot is 8 bits");
+static RawCapture rawCaptures[RAW_CAPTURE_SLOTS];
+static unsigned int nextRawSlot = 0;
+Queue<TransmitJob, TRANSMIT_QUEUE_SIZE> transmitQueue;
+
+// Transmitter on TX_PIN (direct GPIO register writes)
+typedef OutputPin<TX_PIN> TransmitPin;
+static Transmitter<TransmitPin> transmitter;
+
+// Tasks stacks and control blocks (static)
+static Task<4096> decodeTaskStorage;
+static Task<4096> transmitTaskStorage;
+
+static RCSwitch* type1Receiver = nullptr;
+// Decoders fed by the decode task
+static volatile bool decodeType1 = false;
+static volatile bool decodeType2 = false;
+// A job is being played (set before it leaves the queue)
+static volatile bool playing = false;
+
+/**
+ * RX pin interrupt: only timestamps the edge
+ */
+static void IRAM_ATTR onReceiverEdge () {
+  edgeQueue.pushFromISR(micros());
+}
+
+/**
+ * NewRemoteReceiver callback (called by the decode task)
+ */
+static void onType2Decoded (NewRemoteCode code) {
+  Type2Data data;
+  static_cast<NewRemoteCode&>(data) = code;
+  Frame frame = createFrame(data);
+  frame.timestamp = millis();
+  frame.source = FRAME_SOURCE_RADIO;
+  frameQueue.push(frame);
+}
+
+/**
+ * Publish the type 1 code decoded by RCSwitch, if any
+ */
+static void publishType1 () {
+  if (!type1Receiver->available()) {
+    return;
+  }
+  Type1Data data;
+  data.decimal = type1Receiver->getReceivedValue();
+  data.length = type1Receiver->getReceivedBitlength();
+  data.delay = type1Receiver->getReceivedDelay();
+  data.protocol = type1Receiver->getReceivedProtocol();
+  Frame frame = createFrame(data);
+  frame.timestamp = millis();
+  frame.source = FRAME_SOURCE_RADIO;
+  // Frames longer than 32 bits
+  const uint32_t* words = type1Receiver->getReceivedWords();
+  for (unsigned int i = 1; i < RCSWITCH_MAX_WORDS; i++) {
+    frame.payload[i] = words[i];
+  }
+
+  // timings[0] (sync) + 2 timings per bit + the last high pulse before sync
+  RawCapture& raw = rawCaptures[nextRawSlot];
+  const unsigned int* timings = type1Receiver->getReceivedRawdata();
+  raw.count = min(data.length * 2 + 2, (unsigned int)RCSWITCH_MAX_CHANGES);
+  for (unsigned int i = 0; i < raw.count; i++) {
+    raw.timings[i] = min(timings[i], 0xFFFFU);
+  }
+  frame.flags |= FRAME_FLAG_RAW;
+  frame.rawSlot = nextRawSlot;
+
+  // Dropped frame (queue full): its slot is reused by the next capture
+  if (frameQueue.push(frame)) {
+    nextRawSlot = (nextRawSlot + 1) % RAW_CAPTURE_SLOTS;
+  }
+  type1Receiver->resetAvailable();
+}
+
+static void decodeTask (void* parameters) {
+  unsigned long time;
+  for (;;) {
+    if (!edgeQueue.pop(time, WAIT_FOREVER)) {
+      continue;
+    }
+    if (decodeType1) {
+      RCSwitch::handleEdge(time);
+      publishType1();
+    }
+    if (decodeType2) {
+      NewRemoteReceiver::handleEdge(time);
+    }
+  }
+}
+
+// Repeats played without rest when the transmitter can't sleep: at least 3,
+// so that RCSwitch still sees two equal sync gaps (a rest stretches the gap
+// after the last one)
+static const unsigned int TRANSMIT_MIN_BURST = 3;
+
+/**
+ * To know if the transmitter sleeps while playing a job (one of its levels
+ * is long enough, see Gpio.h)
+ */
+static bool sleepsWhilePlaying (const TransmitJob& job) {
+  const unsigned long sleepMin = TransmitPin::Hal::SLEEP_MIN;
+  for (unsigned int i = 0; sleepMin > 0 && i < job.waveform.count; i++) {
+    if ((unsigned long)job.waveform.durations[i] * job.scale / 100 >= sleepMin) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Duration of a frame of a job (in microseconds)
+ */
+static unsigned long frameDuration (const TransmitJob& job) {
+  unsigned long frame = 0;
+  for (unsigned int i = 0; i < job.waveform.count; i++) {
+    frame += job.waveform.durations[i];
+  }
+  return frame * job.scale / 100;
+}
+
+static void transmitTask (void* parameters) {
+  static TransmitJob job;
+  transmitter.begin();
+  for (;;) {
+    // Playing before the job leaves the queue: never seen idle in between
+    if (!transmitQueue.peek(job, WAIT_FOREVER)) {
+      continue;
+    }
+    playing = true;
+    transmitQueue.pop(job, 0);
+    if (sleepsWhilePlaying(job)) {
+      transmitter.play(job.waveform.durations, job.waveform.count, job.first, job.waveform.inverted, job.scale, job.repeats);
+    } else {
+      // Short levels only (or busy waits): a tick of rest between bursts of
+      // repeats, never busy for much longer than TRANSMIT_MAX_BUSY
+      const unsigned int burst = max(TRANSMIT_MIN_BURST, (unsigned int)(TRANSMIT_MAX_BUSY * 1000UL / max(frameDuration(job), 1UL)));
+      for (unsigned int r = 0; r < job.repeats; r += burst) {
+        if (r > 0) {
+          delay(1);
+        }
+        transmitter.play(job.waveform.durations, job.waveform.count, job.first, job.waveform.inverted, job.scale, min(burst, job.repeats - r));
+      }
+    }
+    playing = false;
+  }
+}
+
+const RawCapture* rawCapture (const Frame& frame) {
+  if (!(frame.flags & FRAME_FLAG_RAW) || frame.rawSlot >= RAW_CAPTURE_SLOTS) {
+    return nullptr;
+  }
+  return &rawCaptures[frame.rawSlot];
+}
+
+void startTaskGraph (RCSwitch& receiver) {
+  type1Receiver = &receiver;
+  decodeTaskStorage.start("decode", decodeTask, DECODE_TASK_PRIORITY, DECODE_TASK_CORE);
+  transmitTaskStorage.start("transmit", transmitTask, TRANSMIT_TASK_PRIORITY, TRANSMIT_TASK_CORE);
+}
+
+void startDecoding (bool type1, bool type2) {
+  if (type1) {
+    // Resets the last code (its interrupt handler is replaced below)
+    type1Receiver->enableReceive(digitalPinToInterrupt(RX_PIN));
+  }
+  if (type2) {
+    // No interrupt: edges come from the decode task
+    NewRemoteReceiver::init(-1, 2, onType2Decoded);
+  }
+  decodeType1 = type1;
+  decodeType2 = type2;
+  // A single handler for both decoders
+  attachInterrupt(digitalPinToInterrupt(RX_PIN), onReceiverEdge, CHANGE);
+}
+
+void stopDecoding () {
+  detachInterrupt(digitalPinToInterrupt(RX_PIN));
+  if (decodeType1) {
+    type1Receiver->disableReceive();
+  }
+  if (decodeType2) {
+    NewRemoteReceiver::deinit();
+  }
+  decodeType1 = false;
+  decodeType2 = false;
+}
+
+bool isTransmitting () {
+  // The queue first: a job leaves it once playing is set (see transmitTask)
+  if (transmitQueue.count() > 0) {
+    return true;
+  }
+  return playing;
+}
+
+unsigned long transmitDuration (const TransmitJob& job) {
+  return frameDuration(job) * job.repeats / 1000;
+}
@@ -0,0 +1,90 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include <Arduino.h>
+#include <RCSwitch.h>
+#include "Config.h"
+#include "Data.h"
+#include "Tasks.h"
+#include "Waveform.h"
+
+// Task graph:
+//
+//   RX pin interrupt --edgeQueue--> decode task --frameQueue--> "loop"
+//   "loop" --transmitQueue--> transmit task --> TX pin
+//
+// The interrupt only timestamps edges. The decode task feeds them to the
+// RCSwitch and NewRemoteReceiver decoders and publishes Frame records (raw
+// timings are kept aside, see rawCapture()). The "loop" (CLI, serial output, led) never blocks the decoding,
+// and sending a signal never blocks the "loop".
+
+/**
+ * A signal to send
+ */
+struct TransmitJob {
+  Waveform waveform;
+  // Index of the first level to play (see Transmitter::play)
+  unsigned int first;
+  // Time scaling in percent
+  unsigned int scale;
+  // Number of times the frame is played
+  unsigned int repeats;
+};
+
+// RX pin interrupt > decode task: edge timestamps (micros)
+extern Queue<unsigned long, EDGE_QUEUE_SIZE> edgeQueue;
+// Decode task > "loop": decoded signals
+extern Queue<Frame, FRAME_QUEUE_SIZE> frameQueue;
+// "loop" > transmit task: signals to send
+extern Queue<TransmitJob, TRANSMIT_QUEUE_SIZE> transmitQueue;
+
+/**
+ * Raw timings of a decoded frame
+ *
+ * Valid until FRAME_QUEUE_SIZE other frames have been popped: copy them
+ * to keep them.
+ *
+ * @return nullptr if the frame has no raw timings
+ */
+const RawCapture* rawCapture (const Frame& frame);
+
+/**
+ * Start the decode and transmit tasks
+ *
+ * @param receiver The RCSwitch instance used to receive
+ */
+void startTaskGraph (RCSwitch& receiver);
+
+/**
+ * Start decoding the edges of the RX pin
+ *
+ * @param type1 Decode type 1 (RCSwitch)
+ * @param type2 Decode type 2 (NewRemoteReceiver)
+ */
+void startDecoding (bool type1, bool type2);
+
+/**
+ * Stop decoding the edges of the RX pin
+ */
+void stopDecoding ();
+
+/**
+ * To know if a signal is being sent or waiting to be sent
+ */
+bool isTransmitting ();
+
+/**
+ * Duration of a job (in ms)
+ */
+unsigned long transmitDuration (const TransmitJob& job);
+
+#endif
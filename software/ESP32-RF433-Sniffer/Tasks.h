@@ -0,0 +1,191 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef TASKS_H
+#define TASKS_H
+
+#include <Arduino.h>
+
+// Task and queue primitives:
+// - ESP32: static FreeRTOS tasks pinned to a core, static FreeRTOS queues
+//   (nothing is allocated on the heap)
+// - other platforms (e.g. Linux): std::thread and a mutex/condition queue,
+//   so that the same task graph can be run and stress-tested on a host
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+#endif
+
+/**
+ * Queue::pop() and Queue::peek() timeout to wait until an item is available
+ */
+const unsigned long WAIT_FOREVER = 0xFFFFFFFF;
+
+/**
+ * Bounded queue of SIZE items, copied by value (T must be trivially copyable).
+ * push() never waits: when the queue is full, the item is dropped and counted.
+ * peek() copies the oldest item, and leaves it in the queue.
+ */
+template <class T, unsigned int SIZE>
+class Queue {
+  public:
+#if defined(ESP32)
+    Queue () {
+      _handle = xQueueCreateStatic(SIZE, sizeof(T), _storage, &_queue);
+    }
+
+    bool push (const T& item) {
+      if (xQueueSend(_handle, &item, 0) != pdTRUE) {
+        _dropped++;
+        return false;
+      }
+      return true;
+    }
+
+    IRAM_ATTR bool pushFromISR (const T& item) {
+      BaseType_t woken = pdFALSE;
+      if (xQueueSendFromISR(_handle, &item, &woken) != pdTRUE) {
+        _dropped++;
+        return false;
+      }
+      if (woken) {
+        portYIELD_FROM_ISR();
+      }
+      return true;
+    }
+
+    bool pop (T& item, unsigned long timeout) {
+      TickType_t ticks = timeout == WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeout);
+      return xQueueReceive(_handle, &item, ticks) == pdTRUE;
+    }
+
+    bool peek (T& item, unsigned long timeout) {
+      TickType_t ticks = timeout == WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeout);
+      return xQueuePeek(_handle, &item, ticks) == pdTRUE;
+    }
+
+    unsigned int count () {
+      return uxQueueMessagesWaiting(_handle);
+    }
+#else
+    bool push (const T& item) {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_count == SIZE) {
+          _dropped++;
+          return false;
+        }
+        _items[(_head + _count) % SIZE] = item;
+        _count++;
+      }
+      _available.notify_one();
+      return true;
+    }
+
+    bool pushFromISR (const T& item) {
+      return push(item);
+    }
+
+    bool pop (T& item, unsigned long timeout) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      if (!_wait(lock, timeout)) {
+        return false;
+      }
+      item = _items[_head];
+      _head = (_head + 1) % SIZE;
+      _count--;
+      return true;
+    }
+
+    bool peek (T& item, unsigned long timeout) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      if (!_wait(lock, timeout)) {
+        return false;
+      }
+      item = _items[_head];
+      return true;
+    }
+
+    unsigned int count () {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _count;
+    }
+#endif
+
+    /**
+     * Number of items dropped because the queue was full
+     */
+    unsigned long dropped () {
+      return _dropped;
+    }
+
+  private:
+#if defined(ESP32)
+    StaticQueue_t _queue;
+    uint8_t _storage[SIZE * sizeof(T)];
+    QueueHandle_t _handle;
+#else
+    std::mutex _mutex;
+    std::condition_variable _available;
+    T _items[SIZE];
+    unsigned int _head = 0;
+    unsigned int _count = 0;
+
+    bool _wait (std::unique_lock<std::mutex>& lock, unsigned long timeout) {
+      auto ready = [this]() { return _count > 0; };
+      if (timeout == WAIT_FOREVER) {
+        _available.wait(lock, ready);
+        return true;
+      }
+      return _available.wait_for(lock, std::chrono::milliseconds(timeout), ready);
+    }
+#endif
+    volatile unsigned long _dropped = 0;
+};
+
+/**
+ * A task running forever, with a static stack of STACK_SIZE bytes (ESP32 only)
+ */
+template <unsigned int STACK_SIZE>
+class Task {
+  public:
+    /**
+     * Start the task
+     *
+     * @param name The task name
+     * @param function The task function (must never return)
+     * @param priority The priority (ESP32 only, "loop" priority is 1)
+     * @param core The core the task is pinned to (ESP32 only)
+     */
+    void start (const char* name, void (*function)(void*), unsigned int priority, int core) {
+#if defined(ESP32)
+      xTaskCreateStaticPinnedToCore(function, name, STACK_SIZE / sizeof(StackType_t), nullptr, priority, _stack, &_task, core);
+#else
+      std::thread(function, nullptr).detach();
+#endif
+    }
+
+  private:
+#if defined(ESP32)
+    StaticTask_t _task;
+    StackType_t _stack[STACK_SIZE / sizeof(StackType_t)];
+#endif
+};
+
+#endif
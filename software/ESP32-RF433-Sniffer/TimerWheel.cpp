@@ -0,0 +1,147 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#include "TimerWheel.h"
+#include "HeapFree.h"
+
+// TimerWheel class constructor
+TimerWheel::TimerWheel () {
+  for (unsigned int i = 0; i < SLOTS; i++) {
+    _slots[i] = NONE;
+  }
+  // All nodes in the free list (linked with "next")
+  for (unsigned int i = 0; i < POOL_SIZE; i++) {
+    _nodes[i].generation = 0;
+    _nodes[i].active = false;
+    _nodes[i].prev = NONE;
+    _nodes[i].next = i + 1 < POOL_SIZE ? i + 1 : NONE;
+  }
+  _free = 0;
+  _now = millis();
+}
+
+TimerId TimerWheel::schedule (InlineFunction<void()> callback, unsigned long duration) {
+  if (_free == NONE) {
+    return NO_TIMER;
+  }
+
+  uint8_t index = _free;
+  Node& node = _nodes[index];
+  _free = node.next;
+
+  node.callback = callback;
+  node.expiresAt = millis() + duration;
+  // Never in the tick being processed
+  if ((long)(node.expiresAt - _now) <= 0) {
+    node.expiresAt = _now + 1;
+  }
+  node.active = true;
+
+  // Push at the head of its slot
+  unsigned int slot = node.expiresAt & (SLOTS - 1);
+  node.prev = NONE;
+  node.next = _slots[slot];
+  if (node.next != NONE) {
+    _nodes[node.next].prev = index;
+  }
+  _slots[slot] = index;
+  _pending++;
+
+  return ((TimerId)node.generation << 8) | (index + 1);
+}
+
+bool TimerWheel::cancel (TimerId id) {
+  int index = _find(id);
+  if (index < 0) {
+    return false;
+  }
+  _unlink(index);
+  _release(index);
+  return true;
+}
+
+bool TimerWheel::isPending (TimerId id) {
+  return _find(id) >= 0;
+}
+
+unsigned int TimerWheel::pending () {
+  return _pending;
+}
+
+void TimerWheel::update () {
+  unsigned long target = millis();
+  if (target - _now >= SLOTS) {
+    // Late by a whole turn: every slot may hold expired timers
+    _now = target;
+    for (unsigned int slot = 0; slot < SLOTS; slot++) {
+      _expireSlot(slot);
+    }
+    return;
+  }
+  while (_now != target) {
+    _now++;
+    _expireSlot(_now & (SLOTS - 1));
+  }
+}
+
+int TimerWheel::_find (TimerId id) {
+  unsigned int index = (id & 0xFF) - 1;
+  if (id == NO_TIMER || index >= POOL_SIZE) {
+    return -1;
+  }
+  const Node& node = _nodes[index];
+  if (!node.active || node.generation != (uint16_t)(id >> 8)) {
+    return -1;
+  }
+  return index;
+}
+
+void TimerWheel::_unlink (uint8_t index) {
+  Node& node = _nodes[index];
+  if (node.prev != NONE) {
+    _nodes[node.prev].next = node.next;
+  } else {
+    _slots[node.expiresAt & (SLOTS - 1)] = node.next;
+  }
+  if (node.next != NONE) {
+    _nodes[node.next].prev = node.prev;
+  }
+}
+
+void TimerWheel::_release (uint8_t index) {
+  Node& node = _nodes[index];
+  node.callback = nullptr;
+  node.active = false;
+  node.generation++;
+  node.prev = NONE;
+  node.next = _free;
+  _free = index;
+  _pending--;
+}
+
+void TimerWheel::_expireSlot (unsigned int slot) {
+  uint8_t index = _slots[slot];
+  while (index != NONE) {
+    Node& node = _nodes[index];
+    if ((long)(node.expiresAt - _now) > 0) {
+      // Later turn of the wheel
+      index = node.next;
+      continue;
+    }
+    // Release before calling: the callback may schedule or cancel timers
+    InlineFunction<void()> callback = node.callback;
+    _unlink(index);
+    _release(index);
+    if (callback) {
+      callback();
+    }
+    // The list may have changed: start again from the head
+    index = _slots[slot];
+  }
+}
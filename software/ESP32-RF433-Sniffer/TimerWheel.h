@@ -0,0 +1,108 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <Arduino.h>
+#include "InlineFunction.h"
+
+/**
+ * Identifies a scheduled timer. 0 is never a valid timer.
+ */
+typedef uint32_t TimerId;
+const TimerId NO_TIMER = 0;
+
+/**
+ * TimerWheel class
+ *
+ * Hashed timer wheel with 1 ms ticks: a timer is stored in the slot of its
+ * expiration tick (modulo the number of slots), in a doubly linked list.
+ * Timer nodes come from a fixed pool and callbacks are stored inline:
+ * schedule and cancel are O(1) and never allocate.
+ */
+class TimerWheel {
+  public:
+    /**
+     * Number of slots (power of 2)
+     */
+    static const unsigned int SLOTS = 64;
+    /**
+     * Maximum number of pending timers
+     */
+    static const unsigned int POOL_SIZE = 16;
+
+    /**
+     * Constructor
+     */
+    TimerWheel ();
+
+    /**
+     * Execute a callback once, after the given duration (non-blocking)
+     *
+     * @param callback The callback to execute
+     * @param duration The duration (in ms)
+     * @return The timer id, or NO_TIMER if the pool is full
+     */
+    TimerId schedule (InlineFunction<void()> callback, unsigned long duration);
+
+    /**
+     * Cancel a pending timer. Does nothing if it has already expired.
+     *
+     * @param id The timer id
+     * @return true if the timer was pending
+     */
+    bool cancel (TimerId id);
+
+    /**
+     * To know if a timer is still pending
+     *
+     * @param id The timer id
+     */
+    bool isPending (TimerId id);
+
+    /**
+     * Number of pending timers
+     */
+    unsigned int pending ();
+
+    /**
+     * Execute the expired timers.
+     * Must be called in the "loop".
+     */
+    void update ();
+
+  private:
+    static const uint8_t NONE = 0xFF;
+
+    struct Node {
+      InlineFunction<void()> callback;
+      unsigned long expiresAt;
+      // Incremented when the node is released: old ids don't match anymore
+      uint16_t generation;
+      uint8_t prev;
+      uint8_t next;
+      bool active;
+    };
+
+    Node _nodes[POOL_SIZE];
+    // Head node of each slot
+    uint8_t _slots[SLOTS];
+    uint8_t _free;
+    unsigned int _pending = 0;
+    // Last processed tick
+    unsigned long _now;
+
+    int _find (TimerId id);
+    void _unlink (uint8_t index);
+    void _release (uint8_t index);
+    void _expireSlot (unsigned int slot);
+};
+
+#endif
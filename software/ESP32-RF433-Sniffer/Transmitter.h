@@ -0,0 +1,81 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef TRANSMITTER_H
+#define TRANSMITTER_H
+
+#include <Arduino.h>
+#include "Gpio.h"
+#include "Waveform.h"
+
+/**
+ * Transmitter class
+ *
+ * Plays waveforms on an output pin known at compile time. Every edge is
+ * scheduled against an absolute deadline counted from the start of the
+ * transmission, so the per-edge overhead does not add up over a frame.
+ * Long levels may sleep, depending on the GPIO policy (see Gpio.h).
+ *
+ * @tparam Pin The output pin (see OutputPin)
+ */
+template <class Pin>
+class Transmitter {
+  public:
+    /**
+     * Configure the output pin
+     */
+    static void begin () {
+      Pin::begin();
+    }
+
+    /**
+     * Play the durations of alternating levels, starting at index first
+     * and wrapping around (e.g. RCSwitch raw timings start at 1: timings[0] is the sync).
+     * The buffer is read in place.
+     *
+     * @param durations The durations (in microseconds)
+     * @param count The number of durations
+     * @param first Index of the first level to play. Default: 0
+     * @param inverted If true, the first level is low. Default: false
+     * @param scale Time scaling in percent. Default: 100
+     * @param repeats Number of times the frame is played. Default: 1
+     */
+    static void play (const unsigned int* durations, unsigned int count, unsigned int first = 0, bool inverted = false, unsigned int scale = 100, unsigned int repeats = 1) {
+      if (durations == nullptr || count == 0 || first >= count) {
+        return;
+      }
+      unsigned long deadline = Pin::Hal::now();
+      for (unsigned int r = 0; r < repeats; r++) {
+        bool active = !inverted;
+        unsigned int index = first;
+        for (unsigned int i = 0; i < count; i++) {
+          Pin::write(active);
+          deadline += scale == 100 ? durations[index] : (unsigned long)durations[index] * scale / 100;
+          active = !active;
+          if (++index == count) {
+            index = 0;
+          }
+          Pin::Hal::waitUntil(deadline);
+        }
+      }
+      Pin::write(false);
+    }
+
+    /**
+     * Play a waveform
+     *
+     * @param waveform The waveform
+     * @param repeats Number of times the frame is played. Default: 1
+     */
+    static void play (const Waveform& waveform, unsigned int repeats = 1) {
+      play(waveform.durations, waveform.count, 0, waveform.inverted, 100, repeats);
+    }
+};
+
+#endif
@@ -8,107 +8,243 @@
  */
 
 #include "Utils.h"
+#include "LineReader.h"
+#include "HeapFree.h"
 
-String readSerialCommand () {
-  if (Serial.available() > 0) {
-    // Read entire line
-    String input = Serial.readStringUntil('\n');
+// Serial line being received
+static LineReader serialLineReader;
 
-    // Clean entry and force uppercase
-    input.trim();
-    input.toUpperCase();
-
-    return input;
-  } else {
-    return "";
+char* readSerialCommand (Print& errors, bool terse) {
+  // Never blocks: only complete lines are returned
+  if (!serialLineReader.read(Serial)) {
+    return nullptr;
   }
-}
 
-const char* bin2tristate(const char* bin) {
-  static char returnValue[50];
-  int pos = 0;
-  int pos2 = 0;
-  while (bin[pos]!='\0' && bin[pos+1]!='\0') {
-    if (bin[pos]=='0' && bin[pos+1]=='0') {
-      returnValue[pos2] = '0';
-    } else if (bin[pos]=='1' && bin[pos+1]=='1') {
-      returnValue[pos2] = '1';
-    } else if (bin[pos]=='0' && bin[pos+1]=='1') {
-      returnValue[pos2] = 'F';
+  if (serialLineReader.overflow()) {
+    if (terse) {
+      errors.println(F("ERR TOO LONG"));
     } else {
-      return "not applicable";
+      errors.print(F("ERROR: Command too long (max ")); errors.print(LineReader::SIZE); errors.println(F(" characters)"));
     }
-    pos = pos+2;
-    pos2++;
+    return nullptr;
   }
-  returnValue[pos2] = '\0';
-  return returnValue;
-};
 
-char* dec2binWzerofill(unsigned long Dec, unsigned int bitLength) {
-  static char bin[64];
-  unsigned int i=0;
+  return serialLineReader.line();
+}
+
+// Binary of each nibble ("0000" to "1111")
+static const char BINARY_NIBBLES[] =
+  "0000000100100011010001010110011110001001101010111100110111101111";
+
+// Tri-state of each nibble (2 pairs of bits: 00: 0, 11: 1, 01: F, 10: invalid)
+static const char TRI_STATE_NIBBLES[] =
+  "000F0X01F0FFFXF1X0XFXXX1101F1X11";
 
-  while (Dec > 0) {
-    bin[32+i++] = ((Dec & 1) > 0) ? '1' : '0';
-    Dec = Dec >> 1;
+// Hexadecimal digits
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+/**
+ * 32 bits of a packed code, from bit "shift" (bits past the code are 0)
+ */
+static uint32_t bitsAt (const uint32_t* words, unsigned int bitLength, unsigned int shift) {
+  const unsigned int index = shift / 32;
+  const unsigned int offset = shift % 32;
+  uint32_t bits = words[index] >> offset;
+  if (offset > 0 && (index + 1) * 32 < bitLength) {
+    bits |= words[index + 1] << (32 - offset);
   }
+  return bits;
+}
 
-  for (unsigned int j = 0; j< bitLength; j++) {
-    if (j >= bitLength - i) {
-      bin[j] = bin[ 31 + i - (j - (bitLength - i)) ];
-    } else {
-      bin[j] = '0';
+void printCode (Formatter& out, const uint32_t* words, unsigned int bitLength) {
+  if (bitLength <= 32) {
+    out.print((unsigned long)words[0]);
+    return;
+  }
+  // 20 digits or "0x" and the hexadecimal digits
+  char text[FRAME_MAX_BITS / 4 + 20];
+  unsigned int length = sizeof(text);
+  if (bitLength <= 64) {
+    uint64_t value = words[0] | ((uint64_t)words[1] << 32);
+    do {
+      text[--length] = '0' + value % 10;
+      value /= 10;
+    } while (value > 0);
+  } else {
+    // Zero filled to the bit length
+    bitLength = min(bitLength, FRAME_MAX_BITS);
+    for (unsigned int shift = 0; shift < bitLength; shift += 4) {
+      text[--length] = HEX_DIGITS[(words[shift / 32] >> (shift % 32)) & 0xF];
     }
+    text[--length] = 'x';
+    text[--length] = '0';
   }
-  bin[bitLength] = '\0';
+  out.write(text + length, sizeof(text) - length);
+}
 
-  return bin;
-};
+void printBinary (Formatter& out, const uint32_t* words, unsigned int bitLength) {
+  char text[FRAME_MAX_BITS];
+  bitLength = min(bitLength, FRAME_MAX_BITS);
+  unsigned int length = 0;
+  // Leading bits, then 4 bits per lookup (never across two words)
+  const unsigned int head = bitLength % 4;
+  if (head > 0) {
+    memcpy(text, BINARY_NIBBLES + (bitsAt(words, bitLength, bitLength - head) & 0xF) * 4 + 4 - head, head);
+    length = head;
+  }
+  for (int shift = bitLength - head - 4; shift >= 0; shift -= 4) {
+    memcpy(text + length, BINARY_NIBBLES + ((words[shift / 32] >> (shift % 32)) & 0xF) * 4, 4);
+    length += 4;
+  }
+  out.write(text, length);
+}
 
-void logData (Type1Data data) {
-  Serial.print(F("Decimal     : ")); Serial.print(data.decimal); Serial.print(F(" (")); Serial.print(data.length); Serial.println(F("Bit)"));
-  Serial.print(F("Binary      : ")); Serial.println(data.bin);
-  Serial.print(F("Tri-State   : ")); Serial.println(data.triState);
-  Serial.print(F("PulseLength : ")); Serial.print(data.delay); Serial.println(F(" microseconds"));
-  Serial.print(F("Protocol    : ")); Serial.println(data.protocol);
-  Serial.print(F("Raw data    : "));
-  if (data.raw) {
-    for (unsigned int i=0; i<= data.length*2; i++) {
-      Serial.print(data.raw[i]);
-      Serial.print(",");
+void printTriState (Formatter& out, const uint32_t* words, unsigned int bitLength) {
+  // Pairs start from the MSB: an odd last bit is ignored
+  bitLength = min(bitLength, FRAME_MAX_BITS);
+  const unsigned int odd = bitLength % 2;
+  const unsigned int pairs = bitLength / 2;
+  char text[FRAME_MAX_BITS / 2];
+  unsigned int length = 0;
+  // Leading pair, then 2 pairs per lookup
+  if (pairs % 2) {
+    text[length++] = TRI_STATE_NIBBLES[(bitsAt(words, bitLength, odd + pairs * 2 - 2) & 0x3) * 2 + 1];
+  }
+  for (int shift = pairs * 2 - pairs % 2 * 2 - 4; shift >= 0; shift -= 4) {
+    memcpy(text + length, TRI_STATE_NIBBLES + (bitsAt(words, bitLength, odd + shift) & 0xF) * 2, 2);
+    length += 2;
+  }
+  // "10" pairs are rendered as X
+  if (memchr(text, 'X', length)) {
+    out.print(F("not applicable"));
+    return;
+  }
+  out.write(text, length);
+}
+
+void logData (Formatter& out, const Frame& frame, const RawCapture* raw) {
+  if (frame.decoder == FRAME_TYPE1) {
+    out.print(F("Decimal     : ")); printCode(out, frame.payload, frame.bitLength); out.print(F(" (")); out.print(frame.bitLength); out.println(F("Bit)"));
+    // Rendered from the integer, only here
+    out.print(F("Binary      : ")); printBinary(out, frame.payload, frame.bitLength); out.println();
+    out.print(F("Tri-State   : ")); printTriState(out, frame.payload, frame.bitLength); out.println();
+    out.print(F("PulseLength : ")); out.print(frame.period); out.println(F(" microseconds"));
+    out.print(F("Protocol    : ")); out.println(frame.protocol);
+    out.print(F("Raw data    : "));
+    if (raw && raw->count > 0) {
+      // May be dropped by the output queue (see OUTPUT_POLICY)
+      out.beginOptional();
+      // The last timing is the pulse before the sync: not printed
+      for (unsigned int i=0; i + 1 < raw->count; i++) {
+        out.print(raw->timings[i]);
+        out.print(',');
+      }
+      out.endOptional();
+    } else {
+      out.print(F("-"));
     }
+    out.println();
   } else {
-    Serial.print(F("-"));
+    out.print(F("ID         : ")); out.println(frame.address());
+    out.print(F("Period     : ")); out.print(frame.period); out.println(F(" microseconds"));
+    out.print(F("Unit       : ")); out.println(frame.unit());
+    out.print(F("GroupBit   : ")); out.println(frame.groupBit());
+    out.print(F("State      : ")); out.println(frame.switchType() ? "ON" : "OFF");
+    out.print(F("DIM level  : ")); out.println(frame.dimLevel());
   }
-  Serial.println();
 };
 
-void logData (Type2Data data) {
-  Serial.print(F("ID         : ")); Serial.println(data.address);
-  Serial.print(F("Period     : ")); Serial.print(data.period); Serial.println(F(" microseconds"));
-  Serial.print(F("Unit       : ")); Serial.println(data.unit);
-  Serial.print(F("GroupBit   : ")); Serial.println(data.groupBit);
-  Serial.print(F("State      : ")); Serial.println(data.switchType ? "ON" : "OFF");
-  Serial.print(F("DIM level  : ")); Serial.println(data.dimLevel);
+void logData (Formatter& out, RawReplayData data) {
+  out.print(F("Raw data    : "));
+  for (unsigned int i = 0; i < data.changeCount; i++) {
+    out.print(data.raw[i]);
+    out.print(',');
+  }
+  out.println();
+  out.print(F("Scale       : ")); out.print(data.scale); out.println(F(" %"));
+  out.print(F("Inverted    : ")); out.println(data.inverted ? "YES" : "NO");
 };
 
-Repeater::Repeater () {
+void logDataLine (Formatter& out, const Frame& frame) {
+  if (frame.decoder == FRAME_TYPE1) {
+    out.print(F("RX1 ")); printCode(out, frame.payload, frame.bitLength);
+    out.print(F(" ")); out.print(frame.protocol);
+    out.print(F(" ")); out.print(frame.period);
+    out.print(F(" ")); out.print(frame.bitLength);
+  } else {
+    out.print(F("RX2 ")); out.print(frame.address());
+    out.print(F(" ")); out.print(frame.period);
+    out.print(F(" ")); out.print(frame.groupBit());
+    out.print(F(" ")); out.print(frame.unit());
+    out.print(F(" ")); out.print(frame.switchType());
+    if (frame.switchType() == Type2Data::dim) {
+      out.print(F(" ")); out.print(frame.dimLevel());
+    }
+  }
+  out.println(frame.isEcho() ? F(" ECHO") : F(""));
+}
+
+void logDataRecord (Formatter& out, RecordWriter& records, const Frame& frame, const RawCapture* raw) {
+  const uint8_t echo = frame.isEcho() ? RECORD_FLAG_ECHO : 0;
+  if (frame.decoder == FRAME_TYPE2) {
+    records.begin(RECORD_TYPE2, frame.timestamp);
+    records.put32(frame.address());
+    records.put16(frame.period);
+    records.put8(frame.unit());
+    records.put8(echo |
+      (frame.groupBit() ? RECORD_FLAG_GROUP : 0) |
+      (frame.dimLevelPresent() ? RECORD_FLAG_DIM_LEVEL : 0));
+    records.put8(frame.switchType());
+    records.put8(frame.dimLevel());
+    records.end(out);
+    return;
+  }
+  records.begin(RECORD_TYPE1, frame.timestamp);
+  records.put32(frame.payload[0]);
+  records.put8(frame.bitLength);
+  records.put8(frame.protocol);
+  records.put16(frame.period);
+  records.put8(echo);
+  // Frames longer than 32 bits: the next words
+  for (unsigned int i = 1; i * 32 < frame.bitLength && i < FRAME_PAYLOAD_WORDS; i++) {
+    records.put32(frame.payload[i]);
+  }
+  records.end(out);
+  if (raw && raw->count > 0) {
+    const unsigned int count = raw->count - 1;
+    records.begin(RECORD_RAW, frame.timestamp);
+    records.put16(count);
+    for (unsigned int i = 0; i < count; i++) {
+      records.put16(raw->timings[i]);
+    }
+    records.end(out);
+  }
+}
+
+Repeater::Repeater (TimerWheel& timers) : _timers(timers) {
   // ...
 }
 
-void Repeater::start (std::function<void(unsigned long count)> callback, unsigned long repeat, unsigned long delay) {
+void Repeater::start (InlineFunction<void(unsigned long count)> callback, unsigned long repeat, unsigned long delay) {
+  _timers.cancel(_timer);
   _callback = callback;
   _delay = delay;
   _numRepetitions = repeat;
   _repeatCount = 0;
   _startedAt = millis();
   _isRunning = true;
+  _scheduleNext();
 }
 
 void Repeater::stop () {
+  _timers.cancel(_timer);
+  _timer = NO_TIMER;
   if (_stopCallback) {
-    _stopCallback(_repeatCount);
+    InlineFunction<void(unsigned long count)> callback = _stopCallback;
+    if (_removeStopCallback) {
+      _stopCallback = nullptr;
+    }
+    callback(_repeatCount);
   }
   // Reset values
   _callback = nullptr;
@@ -122,30 +258,36 @@ bool Repeater::isRunning () {
   return _isRunning;
 }
 
-void Repeater::update () {
-  if (_isRunning) {
-    if (millis() - _startedAt >= (_delay * _repeatCount)) {
-      if (_callback) {
-        _callback(_repeatCount);
-      }
-      _repeatCount++;
-      // Stop if repeat limit has been reached
-      if (_repeatCount == _numRepetitions) {
-        stop();
-      }
-    }
+void Repeater::_scheduleNext () {
+  long remaining = (long)(_startedAt + _delay * _repeatCount - millis());
+  _timer = _timers.schedule([this]() {
+    _repeat();
+  }, remaining > 0 ? remaining : 0);
+  // No timer left: stopped, the stop callback reports the repeats done
+  if (_timer == NO_TIMER) {
+    stop();
   }
 }
 
-void Repeater::onStop (std::function<void(unsigned long count)> callback, bool remove) {
-  // Create new lambda function
-  _stopCallback = [this, callback, remove](unsigned long count) {
-    if (callback) {
-      callback(count);
-    }
+void Repeater::_repeat () {
+  _timer = NO_TIMER;
+  if (_callback) {
+    _callback(_repeatCount);
+  }
+  // The callback may have stopped the repeater
+  if (!_isRunning) {
+    return;
+  }
+  _repeatCount++;
+  // Stop if repeat limit has been reached
+  if (_repeatCount == _numRepetitions) {
+    stop();
+  } else {
+    _scheduleNext();
+  }
+}
 
-    if (remove) {
-      this->_stopCallback = nullptr;
-    }
-  };
+void Repeater::onStop (InlineFunction<void(unsigned long count)> callback, bool remove) {
+  _stopCallback = callback;
+  _removeStopCallback = remove;
 }
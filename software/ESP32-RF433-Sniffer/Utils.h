@@ -11,40 +11,88 @@
 #define UTILS_H
 
 #include <Arduino.h>
-#include <functional>
+#include "InlineFunction.h"
 #include "Data.h"
+#include "TimerWheel.h"
+#include "Formatter.h"
+#include "BinaryOutput.h"
 
 // Utils for Serial
 
-String readSerialCommand ();
+/**
+ * Read a command line from serial without blocking.
+ * Returns nullptr until a complete line is received. The line is valid
+ * until next call (see Command to split it in place).
+ *
+ * @param errors Where a line too long is reported
+ * @param terse Report it as a terse reply ("ERR TOO LONG", e.g. binary output)
+ */
+char* readSerialCommand (Print& errors, bool terse);
 
 // Utils for RCSwitch data
 
 /**
- * Convert binary to tristate.
- * See https://github.com/sui77/rc-switch/blob/master/examples/ReceiveDemo_Advanced/output.ino
+ * Print a code: in decimal up to 64 bits, in hexadecimal ("0x...", zero
+ * filled) above
+ * @param out The output buffer
+ * @param words The code, packed in 32 bits words (least significant first)
+ * @param bitLength The bit length
  */
-const char* bin2tristate(const char* bin);
+void printCode (Formatter& out, const uint32_t* words, unsigned int bitLength);
 
 /**
- * Convert decimal to binary with zero fill.
+ * Print a code in binary, zero filled to its bit length
+ * @param out The output buffer
+ * @param words The code, packed in 32 bits words (least significant first)
+ * @param bitLength The bit length
+ */
+void printBinary (Formatter& out, const uint32_t* words, unsigned int bitLength);
+
+/**
+ * Print a code in tri-state (00: 0, 11: 1, 01: F), or "not applicable"
+ * when a pair is 10. Pairs are read from the MSB.
  * See https://github.com/sui77/rc-switch/blob/master/examples/ReceiveDemo_Advanced/output.ino
+ * @param out The output buffer
+ * @param words The code, packed in 32 bits words (least significant first)
+ * @param bitLength The bit length
  */
-char* dec2binWzerofill(unsigned long Dec, unsigned int bitLength);
+void printTriState (Formatter& out, const uint32_t* words, unsigned int bitLength);
 
 // Common utils
 
 /**
- * Log the available data for type 1
- * @param data The data to log
+ * Log the available data of a decoded signal
+ * @param out The output buffer
+ * @param frame The decoded signal
+ * @param raw Its raw timings (type 1), or nullptr
  */
-void logData (Type1Data data);
+void logData (Formatter& out, const Frame& frame, const RawCapture* raw);
 
 /**
- * Log the available data for type 2
+ * Log the raw replay data
+ * @param out The output buffer
  * @param data The data to log
  */
-void logData (Type2Data data);
+void logData (Formatter& out, RawReplayData data);
+
+/**
+ * Log a decoded signal on one line, as a TX1/TX2 command would take it:
+ * "RX1 <decimal> <protocol> <delay> <length> [ECHO]"
+ * "RX2 <id> <period> <group> <unit> <state> [<dimLevel>] [ECHO]"
+ * @param out The output buffer
+ * @param frame The decoded signal
+ */
+void logDataLine (Formatter& out, const Frame& frame);
+
+/**
+ * Log a decoded signal as binary records: RECORD_TYPE1 then RECORD_RAW,
+ * or RECORD_TYPE2
+ * @param out The output buffer
+ * @param records The record writer
+ * @param frame The decoded signal
+ * @param raw Its raw timings (type 1), or nullptr
+ */
+void logDataRecord (Formatter& out, RecordWriter& records, const Frame& frame, const RawCapture* raw);
 
 /**
  * Repeater class
@@ -53,17 +101,20 @@ class Repeater {
   public:
     /**
      * Constructor
+     *
+     * @param timers The timer wheel running the repetitions
      */
-    Repeater ();
+    Repeater (TimerWheel& timers);
 
     /**
-     * Start the repetitions
+     * Start the repetitions (stopped as soon as no timer is left, see
+     * TimerWheel::schedule)
      *
      * @param callback The callback to execute at each repetition
      * @param repeat The number of repetitions. Default: 1
      * @param delay The delay between each repetition (in ms). Default: 1000
      */
-    void start (std::function<void(unsigned long count)> callback, unsigned long repeat = 1, unsigned long delay = 1000);
+    void start (InlineFunction<void(unsigned long count)> callback, unsigned long repeat = 1, unsigned long delay = 1000);
 
     /**
      * Stop the repeater
@@ -75,20 +126,23 @@ class Repeater {
      */
     bool isRunning ();
 
-    /**
-     * Must be called in the "loop".
-     */
-    void update ();
-
     /**
      * Apply a callback when repeater is stopped
      *
      * @param callback The callback to execute when the repeater is stopped
      * @param remove Auto-remove the callback when executed. Set to false for permanent callback. Default: true
      */
-    void onStop (std::function<void(unsigned long count)> callback, bool remove = true);
+    void onStop (InlineFunction<void(unsigned long count)> callback, bool remove = true);
 
   private:
+    /**
+     * The timer wheel running the repetitions
+     */
+    TimerWheel& _timers;
+    /**
+     * The timer of the next repetition
+     */
+    TimerId _timer = NO_TIMER;
     /**
      * Flag to know if the repeater is currently running
      */
@@ -112,11 +166,24 @@ class Repeater {
     /**
      * The callback to execute at each repetition
      */
-    std::function<void(unsigned long count)> _callback = nullptr;
+    InlineFunction<void(unsigned long count)> _callback = nullptr;
     /**
      * The callback to execute when repeater is stopped
      */
-    std::function<void(unsigned long count)> _stopCallback = nullptr;
+    InlineFunction<void(unsigned long count)> _stopCallback = nullptr;
+    /**
+     * Remove the stop callback when executed
+     */
+    bool _removeStopCallback = true;
+
+    /**
+     * Schedule the next repetition (relative to the start: no drift)
+     */
+    void _scheduleNext ();
+    /**
+     * Execute a repetition
+     */
+    void _repeat ();
 };
 
 #endif
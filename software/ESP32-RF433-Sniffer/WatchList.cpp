@@ -0,0 +1,150 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#include "WatchList.h"
+#include "HeapFree.h"
+
+// Field names, in WatchField order
+static const char* const FIELD_NAMES[WATCH_FIELD_COUNT] = {
+  "PROTO",
+  "CODE",
+  "LEN",
+  "ADDR",
+  "UNIT"
+};
+
+unsigned int WatchList::_slot (WatchField field, uint32_t value) {
+  // Fibonacci hashing, the field in the high bits. 32 bits product whatever
+  // the width of unsigned long: the same slots on the host and on the ESP32
+  const uint32_t hash = (value ^ ((uint32_t)field << 28)) * (uint32_t)2654435761U;
+  return hash >> 26 & (SLOTS - 1);
+}
+
+int WatchList::_find (WatchField field, uint32_t value) const {
+  // Linear probing: at most MAX_ENTRIES slots in use, so a free slot is found
+  for (unsigned int i = _slot(field, value); _entries[i].mode != WATCH_NONE; i = (i + 1) & (SLOTS - 1)) {
+    if (_entries[i].field == field && _entries[i].value == value) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+WatchMode WatchList::_lookup (WatchField field, uint32_t value) const {
+  int i = _find(field, value);
+  return i < 0 ? WATCH_NONE : (WatchMode)_entries[i].mode;
+}
+
+bool WatchList::add (WatchField field, uint32_t value, WatchMode mode) {
+  int found = _find(field, value);
+  if (found >= 0) {
+    _includes -= _entries[found].mode == WATCH_INCLUDE;
+    _includes += mode == WATCH_INCLUDE;
+    _entries[found].mode = mode;
+    return true;
+  }
+  if (_count == MAX_ENTRIES) {
+    return false;
+  }
+  unsigned int i = _slot(field, value);
+  while (_entries[i].mode != WATCH_NONE) {
+    i = (i + 1) & (SLOTS - 1);
+  }
+  _entries[i] = { value, (uint8_t)field, (uint8_t)mode };
+  _count++;
+  _includes += mode == WATCH_INCLUDE;
+  return true;
+}
+
+bool WatchList::remove (WatchField field, uint32_t value) {
+  int found = _find(field, value);
+  if (found < 0) {
+    return false;
+  }
+  _includes -= _entries[found].mode == WATCH_INCLUDE;
+  _count--;
+  // Backward shift: the following entries of the probe sequence move up,
+  // so that lookups never stop on the freed slot
+  unsigned int hole = found;
+  unsigned int i = hole;
+  while (true) {
+    i = (i + 1) & (SLOTS - 1);
+    if (_entries[i].mode == WATCH_NONE) {
+      break;
+    }
+    unsigned int home = _slot((WatchField)_entries[i].field, _entries[i].value);
+    // Entry i can move to the hole if its home slot is not in (hole, i]
+    if (((i - home) & (SLOTS - 1)) >= ((i - hole) & (SLOTS - 1))) {
+      _entries[hole] = _entries[i];
+      hole = i;
+    }
+  }
+  _entries[hole].mode = WATCH_NONE;
+  return true;
+}
+
+void WatchList::clear () {
+  memset(_entries, 0, sizeof(_entries));
+  _count = 0;
+  _includes = 0;
+}
+
+bool WatchList::accepts (const Frame& frame) {
+  if (_count == 0) {
+    return true;
+  }
+  WatchMode modes[3];
+  unsigned int numFields;
+  if (frame.decoder == FRAME_TYPE1) {
+    modes[0] = _lookup(WATCH_PROTOCOL, frame.protocol);
+    // Filtered codes are 32 bits long at most
+    modes[1] = frame.bitLength <= 32 ? _lookup(WATCH_CODE, frame.payload[0]) : WATCH_NONE;
+    modes[2] = _lookup(WATCH_LENGTH, frame.bitLength);
+    numFields = 3;
+  } else {
+    modes[0] = _lookup(WATCH_ADDRESS, frame.address());
+    modes[1] = _lookup(WATCH_UNIT, frame.unit());
+    numFields = 2;
+  }
+  bool included = _includes == 0;
+  for (unsigned int i = 0; i < numFields; i++) {
+    if (modes[i] == WATCH_EXCLUDE) {
+      included = false;
+      break;
+    }
+    included = included || modes[i] == WATCH_INCLUDE;
+  }
+  if (!included) {
+    _filtered++;
+  }
+  return included;
+}
+
+unsigned int WatchList::count () const {
+  return _count;
+}
+
+unsigned long WatchList::filtered () const {
+  return _filtered;
+}
+
+void WatchList::print (Print& out) const {
+  for (unsigned int i = 0; i < SLOTS; i++) {
+    if (_entries[i].mode == WATCH_NONE) {
+      continue;
+    }
+    out.print(_entries[i].mode == WATCH_INCLUDE ? F("FILTER INCLUDE ") : F("FILTER EXCLUDE "));
+    out.print(FIELD_NAMES[_entries[i].field]); out.print(F(" "));
+    out.println((unsigned long)_entries[i].value);
+  }
+}
+
+const char* WatchList::fieldName (WatchField field) {
+  return FIELD_NAMES[field];
+}
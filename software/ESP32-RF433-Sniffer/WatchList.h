@@ -0,0 +1,123 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef WATCH_LIST_H
+#define WATCH_LIST_H
+
+#include <Arduino.h>
+#include "Data.h"
+
+/**
+ * Filtered fields of a decoded signal
+ */
+enum WatchField {
+  // Type 1
+  WATCH_PROTOCOL,
+  // 32 bits at most: never matches a longer frame
+  WATCH_CODE,
+  WATCH_LENGTH,
+  // Type 2
+  WATCH_ADDRESS,
+  WATCH_UNIT,
+  WATCH_FIELD_COUNT
+};
+
+/**
+ * Include or exclude a value
+ */
+enum WatchMode {
+  WATCH_NONE,
+  WATCH_INCLUDE,
+  WATCH_EXCLUDE
+};
+
+/**
+ * WatchList class
+ *
+ * Include/exclude filters of the decoded signals, by field value, in an
+ * open addressing hash set (one lookup per field of a signal).
+ * A signal is accepted if it matches no excluded value and, when there are
+ * included values, if it matches at least one of them.
+ */
+class WatchList {
+  public:
+    /**
+     * Maximum number of filters (half of the hash set slots)
+     */
+    static const unsigned int MAX_ENTRIES = 32;
+
+    /**
+     * Add (or change) a filter
+     *
+     * @return false if the list is full
+     */
+    bool add (WatchField field, uint32_t value, WatchMode mode);
+
+    /**
+     * Remove a filter
+     *
+     * @return false if there was no filter for this value
+     */
+    bool remove (WatchField field, uint32_t value);
+
+    /**
+     * Remove all filters
+     */
+    void clear ();
+
+    /**
+     * If a decoded signal passes the filters (counts the others)
+     *
+     * @param frame The decoded signal
+     */
+    bool accepts (const Frame& frame);
+
+    /**
+     * Number of filters
+     */
+    unsigned int count () const;
+
+    /**
+     * Number of signals filtered out
+     */
+    unsigned long filtered () const;
+
+    /**
+     * Print the filters, one per line: "FILTER <INCLUDE|EXCLUDE> <field> <value>"
+     *
+     * @param out Where to print them
+     */
+    void print (Print& out) const;
+
+    /**
+     * Name of a field, as used by the "FILTER" command
+     */
+    static const char* fieldName (WatchField field);
+
+  private:
+    static const unsigned int SLOTS = MAX_ENTRIES * 2;
+
+    struct Entry {
+      uint32_t value;
+      uint8_t field;
+      // WATCH_NONE: free slot
+      uint8_t mode;
+    };
+
+    Entry _entries[SLOTS] = {};
+    unsigned int _count = 0;
+    unsigned int _includes = 0;
+    unsigned long _filtered = 0;
+
+    static unsigned int _slot (WatchField field, uint32_t value);
+    int _find (WatchField field, uint32_t value) const;
+    WatchMode _lookup (WatchField field, uint32_t value) const;
+};
+
+#endif
@@ -0,0 +1,87 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#include <RCSwitch.h>
+#include "Waveform.h"
+#include "HeapFree.h"
+
+/**
+ * Append a high-low pulse
+ */
+static void appendPulse (Waveform& waveform, unsigned int high, unsigned int low) {
+  waveform.durations[waveform.count++] = high;
+  waveform.durations[waveform.count++] = low;
+}
+
+/**
+ * Append a type 2 bit: '0' is (T,T,T,5T), '1' is (T,5T,T,T)
+ */
+static void appendType2Bit (Waveform& waveform, unsigned int period, bool isBitOne) {
+  if (isBitOne) {
+    appendPulse(waveform, period, period * 5);
+    appendPulse(waveform, period, period);
+  } else {
+    appendPulse(waveform, period, period);
+    appendPulse(waveform, period, period * 5);
+  }
+}
+
+bool encodeWaveform (Waveform& waveform, Type1Data data) {
+  if (data.length == 0 || data.length > 32 || 2 * data.length + 2 > WAVEFORM_MAX_LEVELS) {
+    return false;
+  }
+  const RCSwitch::Protocol protocol = RCSwitch::getProtocol(data.protocol);
+  const unsigned int pulseLength = data.delay > 0 ? data.delay : protocol.pulseLength;
+
+  waveform.count = 0;
+  waveform.inverted = protocol.invertedSignal;
+  // Bits are sent from MSB to LSB
+  for (int i = data.length - 1; i >= 0; i--) {
+    const RCSwitch::HighLow& pulses = (data.decimal & (1UL << i)) ? protocol.one : protocol.zero;
+    appendPulse(waveform, pulseLength * pulses.high, pulseLength * pulses.low);
+  }
+  appendPulse(waveform, pulseLength * protocol.syncFactor.high, pulseLength * protocol.syncFactor.low);
+  return true;
+}
+
+bool encodeWaveform (Waveform& waveform, Type2Data data) {
+  const unsigned int period = data.period;
+  const bool isDim = data.switchType == Type2Data::dim ||
+    (data.switchType == Type2Data::on && data.dimLevelPresent);
+
+  waveform.count = 0;
+  waveform.inverted = false;
+  // Start pulse: actually 10.5T instead of 10.44T. Close enough.
+  appendPulse(waveform, period, period * 10 + (period >> 1));
+  // Address
+  for (int i = 25; i >= 0; i--) {
+    appendType2Bit(waveform, period, (data.address >> i) & 1);
+  }
+  appendType2Bit(waveform, period, data.groupBit);
+  if (isDim) {
+    // Switch type 'dim': (T,T,T,T)
+    appendPulse(waveform, period, period);
+    appendPulse(waveform, period, period);
+  } else {
+    appendType2Bit(waveform, period, data.switchType == Type2Data::on);
+  }
+  // Unit (ignored for group commands)
+  const byte unit = data.groupBit ? 0 : data.unit;
+  for (int i = 3; i >= 0; i--) {
+    appendType2Bit(waveform, period, unit & (1 << i));
+  }
+  if (isDim) {
+    for (int i = 3; i >= 0; i--) {
+      appendType2Bit(waveform, period, data.dimLevel & (1 << i));
+    }
+  }
+  // Stop pulse
+  appendPulse(waveform, period, period * 40);
+  return true;
+}
@@ -0,0 +1,51 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#include <Arduino.h>
+#include "Data.h"
+
+// Maximum number of levels of a waveform: type 2 with dim level = start (2)
+// + 36 bits * 4 + stop (2), or the raw timings of the longest type 1 frame
+const unsigned int WAVEFORM_MAX_LEVELS = RCSWITCH_MAX_CHANGES > 148 ? RCSWITCH_MAX_CHANGES : 148;
+
+/**
+ * A frame, as the durations of alternating levels
+ */
+struct Waveform {
+  // Durations (in microseconds). The first level is high, unless inverted
+  unsigned int durations[WAVEFORM_MAX_LEVELS];
+  // Number of levels
+  unsigned int count;
+  // The first level is low (i.e. inverted RCSwitch protocols)
+  bool inverted;
+};
+
+/**
+ * Encode type 1 data (RCSwitch protocol): data bits, then sync
+ *
+ * @param waveform The waveform to fill
+ * @param data The data to encode
+ * @return false if the data can't be encoded
+ */
+bool encodeWaveform (Waveform& waveform, Type1Data data);
+
+/**
+ * Encode type 2 data (NewRemoteSwitch): start pulse, address, group bit,
+ * switch type, unit, [dim level], stop pulse
+ *
+ * @param waveform The waveform to fill
+ * @param data The data to encode
+ * @return false if the data can't be encoded
+ */
+bool encodeWaveform (Waveform& waveform, Type2Data data);
+
+#endif
@@ -63,6 +63,7 @@ void NewRemoteReceiver::init(int8_t interrupt, byte minRepeats, NewRemoteReceive
 	_interrupt = interrupt;
 	_minRepeats = minRepeats;
 	_callback = callback;
+	_isCallbackStruct = false;
 
 	enable();
 	if (_interrupt >= 0) {
@@ -100,6 +101,10 @@ void NewRemoteReceiver::deinit() {
 }
 
 void RECEIVE_ATTR NewRemoteReceiver::interruptHandler() {
+	handleEdge(micros());
+}
+
+void RECEIVE_ATTR NewRemoteReceiver::handleEdge(unsigned long time) {
 	// This method is written as compact code to keep it fast. While breaking up this method into more
 	// methods would certainly increase the readability, it would also be much slower to execute.
 	// Making calls to other methods is quite expensive on AVR. As These interrupt handlers are called
@@ -119,7 +124,7 @@ void RECEIVE_ATTR NewRemoteReceiver::interruptHandler() {
 
 	// Filter out too short pulses. This method works as a low pass filter.
 	edgeTimeStamp[1] = edgeTimeStamp[2];
-	edgeTimeStamp[2] = micros();
+	edgeTimeStamp[2] = time;
 
 	if (skip) {
 		skip = false;
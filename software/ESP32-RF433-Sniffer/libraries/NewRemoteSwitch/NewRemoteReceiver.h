@@ -30,16 +30,10 @@ struct NewRemoteCode {
 	byte dimLevel;				// Dim level [0..15]. Will be available if switchType is dim, on_with_dim or off_with_dim.
 };
 
-#if defined ESP8266 || defined ESP32
-#include <functional>
-#define CALLBACK_SIGNATUREH typedef std::function<void(unsigned int period, unsigned long address, unsigned long groupBit, unsigned long unit, unsigned long switchType, boolean dimLevelPresent, byte dimLevel)> NewRemoteReceiverCallBack
-// Type definition for callback function with NewRemoteCode struct as parameter
-#define CALLBACK_SIGNATURE_STRUCTH typedef std::function<void(NewRemoteCode receivedCode)> NewRemoteReceiverCallBackStruct
-#else
+// Plain function pointers: nothing is allocated, cheap to call from the decoder
 #define CALLBACK_SIGNATUREH typedef void (*NewRemoteReceiverCallBack)(unsigned int period, unsigned long address, unsigned long groupBit, unsigned long unit, unsigned long switchType, boolean dimLevelPresent, byte dimLevel)
 // Type definition for callback function with NewRemoteCode struct as parameter
 #define CALLBACK_SIGNATURE_STRUCTH typedef void(*NewRemoteReceiverCallBackStruct)(NewRemoteCode)
-#endif
 CALLBACK_SIGNATUREH;
 CALLBACK_SIGNATURE_STRUCTH;
 
@@ -117,6 +111,12 @@ class NewRemoteReceiver {
 		 */
 		static void interruptHandler();
 
+		/**
+		 * Called for a signal level change which occurred at <time> (micros()). Used by interruptHandler().
+		 * Can also be fed with edges from another source (e.g. a recorded signal), if init()'ed with interrupt < 0.
+		 */
+		static void handleEdge(unsigned long time);
+
 	private:
 
 		static int8_t _interrupt;					// Radio input interrupt
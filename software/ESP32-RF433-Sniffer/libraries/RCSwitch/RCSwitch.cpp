@@ -99,6 +99,8 @@ enum {
 
 #if not defined( RCSwitchDisableReceiving )
 volatile unsigned long RCSwitch::nReceivedValue = 0;
+uint32_t RCSwitch::nReceivedWords[RCSWITCH_MAX_WORDS];
+volatile bool RCSwitch::bReceivedAvailable = false;
 volatile unsigned int RCSwitch::nReceivedBitlength = 0;
 volatile unsigned int RCSwitch::nReceivedDelay = 0;
 volatile unsigned int RCSwitch::nReceivedProtocol = 0;
@@ -107,7 +109,9 @@ const unsigned int RCSwitch::nSeparationLimit = 4300;
 // separationLimit: minimum microseconds between received codes, closer codes are ignored.
 // according to discussion on issue #14 it might be more suitable to set the separation
 // limit to the same time as the 'low' part of the sync signal for the current protocol.
-unsigned int RCSwitch::timings[RCSWITCH_MAX_CHANGES];
+unsigned int RCSwitch::timingsBuffers[2][RCSWITCH_MAX_CHANGES];
+unsigned int* RCSwitch::timings = RCSwitch::timingsBuffers[0];
+unsigned int* RCSwitch::receivedTimings = RCSwitch::timingsBuffers[1];
 #endif
 
 RCSwitch::RCSwitch() {
@@ -118,6 +122,7 @@ RCSwitch::RCSwitch() {
   this->nReceiverInterrupt = -1;
   this->setReceiveTolerance(60);
   RCSwitch::nReceivedValue = 0;
+  RCSwitch::bReceivedAvailable = false;
   #endif
 }
 
@@ -132,16 +137,32 @@ void RCSwitch::setProtocol(Protocol protocol) {
   * Sets the protocol to send, from a list of predefined protocols
   */
 void RCSwitch::setProtocol(int nProtocol) {
+  this->protocol = getProtocol(nProtocol);
+}
+
+/**
+  * Returns one of the predefined protocols (protocol 1 if out of range)
+  */
+RCSwitch::Protocol RCSwitch::getProtocol(int nProtocol) {
   if (nProtocol < 1 || nProtocol > numProto) {
     nProtocol = 1;  // TODO: trigger an error, e.g. "bad protocol" ???
   }
 #if defined(ESP8266) || defined(ESP32)
-  this->protocol = proto[nProtocol-1];
+  return proto[nProtocol-1];
 #else
-  memcpy_P(&this->protocol, &proto[nProtocol-1], sizeof(Protocol));
+  Protocol protocol;
+  memcpy_P(&protocol, &proto[nProtocol-1], sizeof(Protocol));
+  return protocol;
 #endif
 }
 
+/**
+  * Returns the number of predefined protocols
+  */
+int RCSwitch::getProtocolCount() {
+  return numProto;
+}
+
 /**
   * Sets the protocol to send with pulse length in microseconds.
   */
@@ -553,8 +574,10 @@ void RCSwitch::enableReceive(int interrupt) {
 
 void RCSwitch::enableReceive() {
   if (this->nReceiverInterrupt != -1) {
+    // the last received code is no longer available, but its description
+    // (bit length, delay, protocol and timings) is kept, e.g. to replay it
     RCSwitch::nReceivedValue = 0;
-    RCSwitch::nReceivedBitlength = 0;
+    RCSwitch::bReceivedAvailable = false;
 #if defined(RaspberryPi) // Raspberry Pi
     wiringPiISR(this->nReceiverInterrupt, INT_EDGE_BOTH, &handleInterrupt);
 #else // Arduino
@@ -574,17 +597,30 @@ void RCSwitch::disableReceive() {
 }
 
 bool RCSwitch::available() {
-  return RCSwitch::nReceivedValue != 0;
+  return RCSwitch::bReceivedAvailable;
 }
 
 void RCSwitch::resetAvailable() {
   RCSwitch::nReceivedValue = 0;
+  RCSwitch::bReceivedAvailable = false;
 }
 
+/**
+ * The received code, or its 32 least significant bits for longer frames
+ * (see getReceivedWords)
+ */
 unsigned long RCSwitch::getReceivedValue() {
   return RCSwitch::nReceivedValue;
 }
 
+/**
+ * The received code, as getReceivedBitlength() bits packed in 32 bits
+ * words, least significant word first
+ */
+const uint32_t* RCSwitch::getReceivedWords() {
+  return RCSwitch::nReceivedWords;
+}
+
 unsigned int RCSwitch::getReceivedBitlength() {
   return RCSwitch::nReceivedBitlength;
 }
@@ -598,7 +634,7 @@ unsigned int RCSwitch::getReceivedProtocol() {
 }
 
 unsigned int* RCSwitch::getReceivedRawdata() {
-  return RCSwitch::timings;
+  return RCSwitch::receivedTimings;
 }
 
 /* helper function for the receiveProtocol method */
@@ -617,7 +653,11 @@ bool RECEIVE_ATTR RCSwitch::receiveProtocol(const int p, unsigned int changeCoun
     memcpy_P(&pro, &proto[p-1], sizeof(Protocol));
 #endif
 
-    unsigned long code = 0;
+    // Bits are received MSB first: complete 32 bits chunks, then the last bits
+    uint32_t chunks[RCSWITCH_MAX_WORDS];
+    unsigned int chunkCount = 0;
+    uint32_t code = 0;
+    unsigned int codeBits = 0;
     //Assuming the longer pulse length is the pulse captured in timings[0]
     const unsigned int syncLengthInPulses =  ((pro.syncFactor.low) > (pro.syncFactor.high)) ? (pro.syncFactor.low) : (pro.syncFactor.high);
     const unsigned int delay = RCSwitch::timings[0] / syncLengthInPulses;
@@ -643,6 +683,12 @@ bool RECEIVE_ATTR RCSwitch::receiveProtocol(const int p, unsigned int changeCoun
     const unsigned int firstDataTiming = (pro.invertedSignal) ? (2) : (1);
 
     for (unsigned int i = firstDataTiming; i < changeCount - 1; i += 2) {
+        if (codeBits == 32) {
+            chunks[chunkCount++] = code;
+            code = 0;
+            codeBits = 0;
+        }
+        codeBits++;
         code <<= 1;
         if (diff(RCSwitch::timings[i], delay * pro.zero.high) < delayTolerance &&
             diff(RCSwitch::timings[i + 1], delay * pro.zero.low) < delayTolerance) {
@@ -658,7 +704,27 @@ bool RECEIVE_ATTR RCSwitch::receiveProtocol(const int p, unsigned int changeCoun
     }
 
     if (changeCount > 7) {    // ignore very short transmissions: no device sends them, so this must be noise
-        RCSwitch::nReceivedValue = code;
+        // Least significant word first: the chunks are shifted by the last bits
+        bool nonZero = code != 0;
+        RCSwitch::nReceivedWords[0] = code;
+        for (unsigned int w = 1; w <= chunkCount; w++) {
+            const uint32_t chunk = chunks[chunkCount - w];
+            nonZero = nonZero || chunk != 0;
+            if (codeBits == 32) {
+                RCSwitch::nReceivedWords[w] = chunk;
+            } else {
+                RCSwitch::nReceivedWords[w - 1] |= chunk << codeBits;
+                if (w < RCSWITCH_MAX_WORDS) {
+                    RCSwitch::nReceivedWords[w] = chunk >> (32 - codeBits);
+                }
+            }
+        }
+        for (unsigned int w = chunkCount + 1; w < RCSWITCH_MAX_WORDS; w++) {
+            RCSwitch::nReceivedWords[w] = 0;
+        }
+        // A code of zeros is noise too
+        RCSwitch::bReceivedAvailable = nonZero;
+        RCSwitch::nReceivedValue = RCSwitch::nReceivedWords[0];
         RCSwitch::nReceivedBitlength = (changeCount - 1) / 2;
         RCSwitch::nReceivedDelay = delay;
         RCSwitch::nReceivedProtocol = p;
@@ -669,12 +735,21 @@ bool RECEIVE_ATTR RCSwitch::receiveProtocol(const int p, unsigned int changeCoun
 }
 
 void RECEIVE_ATTR RCSwitch::handleInterrupt() {
+  handleEdge(micros());
+}
+
+/**
+ * Process a signal level change which occurred at 'time' (in microseconds).
+ *
+ * Called by the interrupt handler. While receiving is disabled, it can also
+ * be fed with edges from another source, e.g. a recorded or simulated signal.
+ */
+void RECEIVE_ATTR RCSwitch::handleEdge(unsigned long time) {
 
   static unsigned int changeCount = 0;
   static unsigned long lastTime = 0;
   static unsigned int repeatCount = 0;
 
-  const long time = micros();
   const unsigned int duration = time - lastTime;
 
   if (duration > RCSwitch::nSeparationLimit) {
@@ -688,10 +763,17 @@ void RECEIVE_ATTR RCSwitch::handleInterrupt() {
       // with roughly the same gap between them).
       repeatCount++;
       if (repeatCount == 2) {
-        for(unsigned int i = 1; i <= numProto; i++) {
-          if (receiveProtocol(i, changeCount)) {
-            // receive succeeded for protocol i
-            break;
+        // keep the pending code (and its timings) untouched until resetAvailable()
+        if (!RCSwitch::bReceivedAvailable) {
+          for(unsigned int i = 1; i <= numProto; i++) {
+            if (receiveProtocol(i, changeCount)) {
+              // receive succeeded for protocol i: publish its timings and
+              // capture the next frame into the other buffer
+              unsigned int* received = RCSwitch::timings;
+              RCSwitch::timings = RCSwitch::receivedTimings;
+              RCSwitch::receivedTimings = received;
+              break;
+            }
           }
         }
         repeatCount = 0;
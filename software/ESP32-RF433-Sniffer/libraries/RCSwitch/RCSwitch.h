@@ -56,9 +56,19 @@
 #define RCSwitchDisableReceiving
 #endif
 
+// Longest received frame, in bits (32 in the original library). Sizes the
+// timing buffers: set it for the build (e.g. -DRCSWITCH_MAX_BITS=32) to
+// trade long frames for RAM.
+#ifndef RCSWITCH_MAX_BITS
+#define RCSWITCH_MAX_BITS 128
+#endif
+
 // Number of maximum high/Low changes per packet.
-// We can handle up to (unsigned long) => 32 bit * 2 H/L changes per bit + 2 for sync
-#define RCSWITCH_MAX_CHANGES 67
+// 2 H/L changes per bit + 2 for sync
+#define RCSWITCH_MAX_CHANGES (RCSWITCH_MAX_BITS * 2 + 2)
+
+// Received codes are stored as packed 32 bits words (least significant first)
+#define RCSWITCH_MAX_WORDS ((RCSWITCH_MAX_BITS + 31) / 32)
 
 class RCSwitch {
 
@@ -88,10 +98,13 @@ class RCSwitch {
     void resetAvailable();
 
     unsigned long getReceivedValue();
+    const uint32_t* getReceivedWords();
     unsigned int getReceivedBitlength();
     unsigned int getReceivedDelay();
     unsigned int getReceivedProtocol();
     unsigned int* getReceivedRawdata();
+
+    static void handleEdge(unsigned long time);
     #endif
   
     void enableTransmit(int nTransmitterPin);
@@ -147,6 +160,8 @@ class RCSwitch {
     void setProtocol(Protocol protocol);
     void setProtocol(int nProtocol);
     void setProtocol(int nProtocol, int nPulseLength);
+    static Protocol getProtocol(int nProtocol);
+    static int getProtocolCount();
 
   private:
     char* getCodeWordA(const char* sGroup, const char* sDevice, bool bStatus);
@@ -168,14 +183,24 @@ class RCSwitch {
     #if not defined( RCSwitchDisableReceiving )
     static int nReceiveTolerance;
     volatile static unsigned long nReceivedValue;
+    // The whole code: nReceivedValue is its least significant word
+    static uint32_t nReceivedWords[RCSWITCH_MAX_WORDS];
+    volatile static bool bReceivedAvailable;
     volatile static unsigned int nReceivedBitlength;
     volatile static unsigned int nReceivedDelay;
     volatile static unsigned int nReceivedProtocol;
     const static unsigned int nSeparationLimit;
     /* 
      * timings[0] contains sync timing, followed by a number of bits
+     *
+     * timings points to the buffer being filled by the interrupt handler,
+     * receivedTimings to the one holding the last decoded frame. They are
+     * swapped on each successful decode so the received frame is never
+     * overwritten while it is read.
      */
-    static unsigned int timings[RCSWITCH_MAX_CHANGES];
+    static unsigned int timingsBuffers[2][RCSWITCH_MAX_CHANGES];
+    static unsigned int* timings;
+    static unsigned int* receivedTimings;
     #endif
 
     
@@ -0,0 +1,38 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+// Host tests: each test is an executable, CHECK() reports a failed
+// condition and checkResult() is its exit code (0: passed)
+
+static unsigned long checkFailures = 0;
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      checkFailures++; \
+      fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+    } \
+  } while (0)
+
+/**
+ * Print the result of the test
+ *
+ * @return The exit code of the test
+ */
+static inline int checkResult (const char* name) {
+  printf("%s: %s (%lu failed)\n", name, checkFailures ? "FAILED" : "passed", checkFailures);
+  return checkFailures ? 1 : 0;
+}
+
+#endif
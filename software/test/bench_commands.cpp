@@ -0,0 +1,26 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+// Host benchmark of the command parsing (same commands as the "BENCH"
+// command): bench_commands [<iterations>]
+
+#include <Arduino.h>
+#include "SelfTest.h"
+
+int main (int argc, char** argv) {
+  BenchmarkResult result;
+  memset(&result, 0, sizeof(BenchmarkResult));
+  result.iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10000000;
+  benchmarkCommands(result);
+  printf("Commands    : %lu (%lu tokens, %lu errors)\n", result.iterations, result.tokens, result.errors);
+  printf("Duration    : %lu us\n", result.parseElapsed);
+  printf("Parsing     : %.0f commands/s\n", result.parseElapsed ? result.iterations * 1000000.0 / result.parseElapsed : 0.0);
+  printf("Checksum    : %lu\n", result.checksum);
+  return 0;
+}
@@ -0,0 +1,31 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+// Host benchmark of the decoded signals formatting and of the capture log
+// records encoding (same frames as the "BENCH" command):
+// bench_formatter [<iterations>]
+
+#include <Arduino.h>
+#include "SelfTest.h"
+
+int main (int argc, char** argv) {
+  BenchmarkResult result;
+  memset(&result, 0, sizeof(BenchmarkResult));
+  result.iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10000000;
+  benchmarkFormatting(result);
+  printf("Frames      : %lu\n", result.iterations);
+  printf("Formatting  : %.0f frames/s, %.0f bytes/s\n",
+    result.formatElapsed ? result.iterations * 1000000.0 / result.formatElapsed : 0.0,
+    result.formatElapsed ? result.bytes * 1000000.0 / result.formatElapsed : 0.0);
+  printf("Log records : %.0f frames/s, %.1f bytes/frame\n",
+    result.encodeElapsed ? result.iterations * 1000000.0 / result.encodeElapsed : 0.0,
+    result.iterations ? (double)result.recordBytes / result.iterations : 0.0);
+  printf("Checksum    : %lu\n", result.checksum);
+  return 0;
+}
@@ -0,0 +1,153 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+// Fuzzing of the edge handlers of the decoders (RCSwitch and
+// NewRemoteReceiver): the input is a sequence of level durations (16 bits,
+// little endian, in microseconds), fed as edges as the RX interrupt would.
+// Run with a sanitizer to catch out of bounds accesses.
+//
+// With libFuzzer (clang, SKETCH_LIBFUZZER option), this is a fuzz target.
+// Otherwise main() runs a fixed corpus: random durations, and encoded frames
+// with their durations shuffled, truncated and stretched.
+
+#include <Arduino.h>
+#include <RCSwitch.h>
+#include <NewRemoteReceiver.h>
+#include "Waveform.h"
+
+static unsigned long decodedCodes = 0;
+
+static void onType2Code (NewRemoteCode code) {
+  decodedCodes++;
+}
+
+extern "C" int LLVMFuzzerTestOneInput (const uint8_t* data, size_t size) {
+  static RCSwitch rcSwitch = RCSwitch();
+  static bool initialized = false;
+  if (!initialized) {
+    NewRemoteReceiver::init(-1, 2, onType2Code);
+    initialized = true;
+  }
+  // Each input starts after a long silence, as a new burst
+  static unsigned long time = 0;
+  time += 100000;
+  RCSwitch::handleEdge(time);
+  NewRemoteReceiver::handleEdge(time);
+  for (size_t i = 0; i + 1 < size; i += 2) {
+    time += data[i] | (data[i + 1] << 8);
+    RCSwitch::handleEdge(time);
+    NewRemoteReceiver::handleEdge(time);
+  }
+  if (rcSwitch.available()) {
+    decodedCodes++;
+    rcSwitch.resetAvailable();
+  }
+  return 0;
+}
+
+#ifndef SKETCH_LIBFUZZER
+
+static uint32_t rng = 1;
+
+/**
+ * xorshift32 pseudo-random generator
+ */
+static uint32_t random32 () {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+/**
+ * Feed durations to the decoders
+ */
+static void feed (const unsigned int* durations, unsigned int count) {
+  uint8_t input[4 * WAVEFORM_MAX_LEVELS];
+  const unsigned int length = min(count, (unsigned int)sizeof(input) / 2);
+  for (unsigned int i = 0; i < length; i++) {
+    const unsigned int duration = min(durations[i], 0xFFFFU);
+    input[2 * i] = duration & 0xFF;
+    input[2 * i + 1] = duration >> 8;
+  }
+  LLVMFuzzerTestOneInput(input, 2 * length);
+}
+
+int main () {
+  static const unsigned long INPUTS = 200000;
+  unsigned int durations[2 * WAVEFORM_MAX_LEVELS];
+  Waveform waveform;
+
+  for (unsigned long n = 0; n < INPUTS; n++) {
+    unsigned int count;
+    if (n % 2 == 0) {
+      // Random durations, short to very long
+      count = random32() % (2 * WAVEFORM_MAX_LEVELS);
+      const unsigned int range = 1U << (4 + random32() % 13);
+      for (unsigned int i = 0; i < count; i++) {
+        durations[i] = random32() % range;
+      }
+    } else {
+      // An encoded frame, repeated, then damaged
+      if (n % 4 == 1) {
+        Type1Data data;
+        data.clear();
+        data.protocol = 1 + random32() % RCSwitch::getProtocolCount();
+        data.length = 1 + random32() % 32;
+        data.decimal = random32();
+        encodeWaveform(waveform, data);
+      } else {
+        Type2Data data;
+        data.clear();
+        data.period = 200 + random32() % 120;
+        data.address = random32() & 0x3FFFFFF;
+        data.unit = random32() % 16;
+        data.switchType = (Type2Data::SwitchType)(random32() % 3);
+        data.dimLevelPresent = data.switchType == Type2Data::dim;
+        data.dimLevel = random32() % 16;
+        encodeWaveform(waveform, data);
+      }
+      count = min(2 * waveform.count, (unsigned int)(sizeof(durations) / sizeof(durations[0])));
+      for (unsigned int i = 0; i < count; i++) {
+        durations[i] = waveform.durations[i % waveform.count];
+      }
+      switch (random32() % 4) {
+        case 0:
+          // Swapped durations
+          for (unsigned int k = 0; k < 4 && count > 1; k++) {
+            const unsigned int a = random32() % count;
+            const unsigned int b = random32() % count;
+            const unsigned int swapped = durations[a];
+            durations[a] = durations[b];
+            durations[b] = swapped;
+          }
+          break;
+        case 1:
+          // Truncated
+          count = random32() % (count + 1);
+          break;
+        case 2:
+          // Stretched
+          for (unsigned int i = 0; i < count; i++) {
+            durations[i] = durations[i] * (50 + random32() % 100) / 100;
+          }
+          break;
+        default:
+          // Untouched
+          break;
+      }
+    }
+    feed(durations, count);
+  }
+  NewRemoteReceiver::deinit();
+  printf("fuzz decoders: passed (%lu inputs, %lu codes decoded)\n", INPUTS, decodedCodes);
+  return 0;
+}
+
+#endif
@@ -0,0 +1,151 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#include <Arduino.h>
+#include <chrono>
+#include <thread>
+
+HostSerial Serial;
+
+static const unsigned int PINS = 64;
+static const std::chrono::steady_clock::time_point startedAt = std::chrono::steady_clock::now();
+static volatile uint8_t levels[PINS];
+static void (*volatile handlers[PINS])(void);
+static uint8_t wires[PINS];
+static bool wired = false;
+
+unsigned long micros () {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startedAt).count();
+}
+
+unsigned long millis () {
+  return micros() / 1000;
+}
+
+void delay (unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds (unsigned int us) {
+  // Busy wait, as on the device: sleeping would be too late
+  const unsigned long start = micros();
+  while (micros() - start < us) {
+    // ...
+  }
+}
+
+void yield () {
+  std::this_thread::yield();
+}
+
+void pinMode (uint8_t pin, uint8_t mode) {
+  // Nothing to configure
+}
+
+void digitalWrite (uint8_t pin, uint8_t level) {
+  if (pin >= PINS || levels[pin] == level) {
+    return;
+  }
+  levels[pin] = level;
+  const uint8_t input = wired ? wires[pin] : 0xFF;
+  if (input < PINS && levels[input] != level) {
+    levels[input] = level;
+    void (*handler)(void) = handlers[input];
+    if (handler) {
+      handler();
+    }
+  }
+}
+
+int digitalRead (uint8_t pin) {
+  return pin < PINS ? levels[pin] : LOW;
+}
+
+void analogWrite (uint8_t pin, int value) {
+  digitalWrite(pin, value > 0 ? HIGH : LOW);
+}
+
+void attachInterrupt (uint8_t interrupt, void (*handler)(void), int mode) {
+  if (interrupt < PINS) {
+    handlers[interrupt] = handler;
+  }
+}
+
+void detachInterrupt (uint8_t interrupt) {
+  if (interrupt < PINS) {
+    handlers[interrupt] = nullptr;
+  }
+}
+
+void hostWire (uint8_t output, uint8_t input) {
+  if (!wired) {
+    memset(wires, 0xFF, sizeof(wires));
+    wired = true;
+  }
+  if (output < PINS) {
+    wires[output] = input;
+  }
+}
+
+size_t Print::print (long value, int base) {
+  if (value < 0) {
+    return print('-') + print((unsigned long)-value, base);
+  }
+  return print((unsigned long)value, base);
+}
+
+size_t Print::print (unsigned long value, int base) {
+  return print((unsigned long long)value, base);
+}
+
+size_t Print::print (long long value, int base) {
+  if (value < 0) {
+    return print('-') + print((unsigned long long)-value, base);
+  }
+  return print((unsigned long long)value, base);
+}
+
+size_t Print::print (unsigned long long value, int base) {
+  char digits[65];
+  unsigned int i = sizeof(digits);
+  do {
+    const unsigned int digit = value % base;
+    digits[--i] = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    value /= base;
+  } while (value > 0);
+  return write(digits + i, sizeof(digits) - i);
+}
+
+size_t Print::print (double value, int digits) {
+  char text[64];
+  snprintf(text, sizeof(text), "%.*f", digits, value);
+  return write(text);
+}
+
+size_t HostSerial::write (uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HostSerial::write (const uint8_t* bytes, size_t length) {
+  if (capture) {
+    output.append((const char*)bytes, length);
+  } else {
+    fwrite(bytes, 1, length, stdout);
+  }
+  return length;
+}
+
+int HostSerial::read () {
+  if (input.empty()) {
+    return -1;
+  }
+  const uint8_t c = input[0];
+  input.erase(0, 1);
+  return c;
+}
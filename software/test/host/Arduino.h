@@ -0,0 +1,178 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Host shim of the Arduino core: just what the sketch modules use, so that
+// they build and run on a computer (host tests and benchmarks).
+// - time: micros()/millis() from the steady clock, real delays
+// - pins: levels in memory; hostWire() connects an output to an input,
+//   whose interrupt handler is then called on each level change
+// - Serial: written to stdout (or kept in a string), read from a string
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define ICACHE_RAM_ATTR
+#define PROGMEM
+#define memcpy_P memcpy
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define CHANGE 3
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+// Binary constants of the Arduino core (binary.h), up to 4 digits
+#define B0 0
+#define B1 1
+#define B00 0
+#define B01 1
+#define B10 2
+#define B11 3
+#define B000 0
+#define B001 1
+#define B010 2
+#define B011 3
+#define B100 4
+#define B101 5
+#define B110 6
+#define B111 7
+#define B0000 0
+#define B0001 1
+#define B0010 2
+#define B0011 3
+#define B0100 4
+#define B0101 5
+#define B0110 6
+#define B0111 7
+#define B1000 8
+#define B1001 9
+#define B1010 10
+#define B1011 11
+#define B1100 12
+#define B1101 13
+#define B1110 14
+#define B1111 15
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+class __FlashStringHelper;
+#define F(text) (reinterpret_cast<const __FlashStringHelper*>(text))
+
+using std::min;
+using std::max;
+
+#define constrain(value, low, high) ((value) < (low) ? (low) : ((value) > (high) ? (high) : (value)))
+#define digitalPinToInterrupt(pin) (pin)
+
+unsigned long micros ();
+unsigned long millis ();
+void delay (unsigned long ms);
+void delayMicroseconds (unsigned int us);
+void yield ();
+
+void pinMode (uint8_t pin, uint8_t mode);
+void digitalWrite (uint8_t pin, uint8_t level);
+int digitalRead (uint8_t pin);
+void analogWrite (uint8_t pin, int value);
+void attachInterrupt (uint8_t interrupt, void (*handler)(void), int mode);
+void detachInterrupt (uint8_t interrupt);
+
+/**
+ * Connect an output pin to an input pin (e.g. TX_PIN to RX_PIN: loopback
+ * without radio). Pass 0xFF as input to disconnect.
+ */
+void hostWire (uint8_t output, uint8_t input);
+
+/**
+ * Print class (as the Arduino core one)
+ */
+class Print {
+  public:
+    virtual ~Print () {}
+    virtual size_t write (uint8_t c) = 0;
+    virtual size_t write (const uint8_t* bytes, size_t length) {
+      for (size_t i = 0; i < length; i++) {
+        write(bytes[i]);
+      }
+      return length;
+    }
+    size_t write (const char* text) { return write((const uint8_t*)text, strlen(text)); }
+    size_t write (const char* bytes, size_t length) { return write((const uint8_t*)bytes, length); }
+    virtual int availableForWrite () { return 0; }
+    virtual void flush () {}
+
+    size_t print (const __FlashStringHelper* text) { return write((const char*)text); }
+    size_t print (const char* text) { return write(text); }
+    size_t print (char c) { return write((uint8_t)c); }
+    size_t print (unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print (int value, int base = DEC) { return print((long)value, base); }
+    size_t print (unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print (long value, int base = DEC);
+    size_t print (unsigned long value, int base = DEC);
+    size_t print (long long value, int base = DEC);
+    size_t print (unsigned long long value, int base = DEC);
+    size_t print (double value, int digits = 2);
+
+    size_t println () { return write("\r\n"); }
+    template <typename T> size_t println (T value) { size_t n = print(value); return n + println(); }
+    template <typename T> size_t println (T value, int format) { size_t n = print(value, format); return n + println(); }
+};
+
+/**
+ * Stream class (as the Arduino core one)
+ */
+class Stream : public Print {
+  public:
+    virtual int available () { return 0; }
+    virtual int read () { return -1; }
+    virtual int peek () { return -1; }
+};
+
+/**
+ * Serial port of the host: output to stdout (or a string), input from a string
+ */
+class HostSerial : public Stream {
+  public:
+    // Written bytes are kept in "output" (for the tests), else go to stdout
+    bool capture = false;
+    std::string output;
+    // Bytes left to read
+    std::string input;
+    // Bytes accepted by availableForWrite()
+    int writable = 4096;
+
+    void begin (unsigned long baudrate) {}
+    size_t write (uint8_t c) override;
+    size_t write (const uint8_t* bytes, size_t length) override;
+    using Print::write;
+    int availableForWrite () override { return writable; }
+    int available () override { return input.size(); }
+    int read () override;
+    int peek () override { return input.empty() ? -1 : (uint8_t)input[0]; }
+};
+
+extern HostSerial Serial;
+
+#endif
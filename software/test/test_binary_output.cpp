@@ -0,0 +1,166 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+// Binary output records, decoded as a reader does:
+// - the CRC is a CRC-16/CCITT-FALSE (check value of "123456789": 0x29B1),
+//   against a bit by bit reference
+// - records of every payload length, with and without 0x00 bytes, are
+//   encoded with no 0x00 but the last byte, and decoded as they were
+//   written: type, sequence (incremented), time, payload and CRC
+// - runs of 254 bytes and more without 0x00 are split in 0xFF blocks
+
+#include <Arduino.h>
+#include <vector>
+#include "Check.h"
+#include "BinaryOutput.h"
+
+// Header (type, sequence, time) and CRC
+static const unsigned int HEADER = 7;
+static const unsigned int CRC = 2;
+static const unsigned int MAX_PAYLOAD = RecordWriter::MAX_SIZE - HEADER - CRC;
+
+/**
+ * CRC-16/CCITT-FALSE, bit by bit (polynomial 0x1021, initial value 0xFFFF)
+ */
+static uint16_t referenceCrc (const uint8_t* bytes, unsigned int length) {
+  uint16_t crc = 0xFFFF;
+  for (unsigned int i = 0; i < length; i++) {
+    crc ^= bytes[i] << 8;
+    for (unsigned int bit = 0; bit < 8; bit++) {
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+/**
+ * COBS decoding of a record (without its final 0x00)
+ *
+ * @param longBlock Set if a block of 254 bytes (0xFF) has been read
+ */
+static bool decode (const uint8_t* bytes, unsigned int length, std::vector<uint8_t>& record, bool& longBlock) {
+  record.clear();
+  unsigned int i = 0;
+  while (i < length) {
+    const uint8_t code = bytes[i];
+    if (code == 0 || i + code > length) {
+      return false;
+    }
+    record.insert(record.end(), bytes + i + 1, bytes + i + code);
+    i += code;
+    if (code == 0xFF) {
+      longBlock = true;
+    } else if (i < length) {
+      record.push_back(0);
+    }
+  }
+  return true;
+}
+
+static uint16_t get16 (const std::vector<uint8_t>& record, unsigned int offset) {
+  return record[offset] | record[offset + 1] << 8;
+}
+
+static uint32_t get32 (const std::vector<uint8_t>& record, unsigned int offset) {
+  return get16(record, offset) | (uint32_t)get16(record, offset + 2) << 16;
+}
+
+/**
+ * Payload byte: a 0x00 every "period" bytes, none if 0
+ */
+static uint8_t payloadByte (unsigned int i, unsigned int period) {
+  if (period > 0 && i % period == period - 1) {
+    return 0;
+  }
+  return 1 + (i * 7 + period) % 255;
+}
+
+static void checkCrc () {
+  CHECK(RecordWriter::crc16((const uint8_t*)"123456789", 9) == 0x29B1);
+  CHECK(referenceCrc((const uint8_t*)"123456789", 9) == 0x29B1);
+  CHECK(RecordWriter::crc16(nullptr, 0) == 0xFFFF);
+  uint8_t bytes[300];
+  for (unsigned int i = 0; i < sizeof(bytes); i++) {
+    bytes[i] = i * 37 + (i >> 3);
+  }
+  for (unsigned int length = 0; length <= sizeof(bytes); length += 13) {
+    CHECK(RecordWriter::crc16(bytes, length) == referenceCrc(bytes, length));
+  }
+}
+
+static void checkRecords () {
+  static const unsigned int PERIODS[] = { 0, 1, 2, 100, 253, 254, 255, 300 };
+  static Formatter out;
+  RecordWriter writer;
+  std::vector<uint8_t> record;
+  uint16_t sequence = 0;
+  for (unsigned int p = 0; p < sizeof(PERIODS) / sizeof(PERIODS[0]); p++) {
+    const unsigned int period = PERIODS[p];
+    for (unsigned int length = 0; length <= MAX_PAYLOAD; length++) {
+      const uint32_t time = 0x01020304UL + length * 0x01010101UL;
+      out.clear();
+      writer.begin(RECORD_RAW, time);
+      for (unsigned int i = 0; i < length; i++) {
+        writer.put8(payloadByte(i, period));
+      }
+      writer.end(out);
+      CHECK(!out.overflow());
+
+      // A single 0x00: the end of the record
+      const uint8_t* bytes = (const uint8_t*)out.data();
+      CHECK(out.length() > 0 && bytes[out.length() - 1] == 0);
+      CHECK(memchr(bytes, 0, out.length() - 1) == nullptr);
+      // One byte of overhead per block of 254 bytes, at most
+      const unsigned int size = HEADER + length + CRC;
+      CHECK(out.length() <= size + size / 254 + 2);
+
+      bool longBlock = false;
+      CHECK(decode(bytes, out.length() - 1, record, longBlock));
+      CHECK(record.size() == size);
+      if (record.size() != size) {
+        continue;
+      }
+      CHECK(record[0] == RECORD_RAW);
+      CHECK(get16(record, 1) == sequence);
+      CHECK(get32(record, 3) == time);
+      bool same = true;
+      unsigned int run = 0;
+      unsigned int longestRun = 0;
+      for (unsigned int i = 0; i < size; i++) {
+        if (i >= HEADER && i < HEADER + length) {
+          same = same && record[i] == payloadByte(i - HEADER, period);
+        }
+        run = record[i] == 0 ? 0 : run + 1;
+        longestRun = max(longestRun, run);
+      }
+      CHECK(same);
+      CHECK(get16(record, size - CRC) == referenceCrc(record.data(), size - CRC));
+      // Split at 254 bytes
+      CHECK(longBlock == (longestRun >= 254));
+      sequence++;
+    }
+  }
+  // Longer than the record: truncated, the CRC still fits
+  out.clear();
+  writer.begin(RECORD_RAW, 1);
+  for (unsigned int i = 0; i < MAX_PAYLOAD + 10; i++) {
+    writer.put8(0x55);
+  }
+  writer.end(out);
+  bool longBlock = false;
+  CHECK(decode((const uint8_t*)out.data(), out.length() - 1, record, longBlock));
+  CHECK(record.size() == RecordWriter::MAX_SIZE);
+  CHECK(get16(record, RecordWriter::MAX_SIZE - CRC) == referenceCrc(record.data(), RecordWriter::MAX_SIZE - CRC));
+}
+
+int main () {
+  checkCrc();
+  checkRecords();
+  return checkResult("binary output");
+}
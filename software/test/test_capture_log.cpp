@@ -0,0 +1,322 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+// Capture log over the file backed flash region (see FlashRegion.h):
+// - records are decoded as they were encoded, damaged records are rejected
+// - the ring wraps: the oldest sectors are erased, the records left are the
+//   newest ones, in order, and a tail reads only the last ones
+// - the log is found again when it is reopened (next boot)
+// - nothing is programmed or erased while the device is busy: the records
+//   wait in RAM, and are written in order once it is free
+// - appended while the log is read (busy, as the sketch does), the records
+//   don't erase the sector under the read cursor
+
+#include <Arduino.h>
+#include <cstdio>
+#include "Check.h"
+#include "CaptureLog.h"
+
+static const char* const STORAGE = "test_capture_log.bin";
+static const unsigned int SECTORS = 4;
+static const unsigned long RECORDS = 2000;
+
+static bool busy = false;
+
+static bool isBusy () {
+  return busy;
+}
+
+/**
+ * A type 1 record: its code is its index
+ */
+static Frame createRecord (unsigned long index) {
+  Type1Data data;
+  data.clear();
+  data.decimal = index;
+  data.protocol = 1 + index % 12;
+  data.delay = 350;
+  data.length = 24;
+  Frame frame = createFrame(data);
+  frame.timestamp = 1000 + index * 7;
+  return frame;
+}
+
+/**
+ * Raw timings of a code (sync, 2 per bit, last pulse)
+ */
+static void createRaw (RawCapture& raw, const Frame& frame) {
+  raw.count = frame.bitLength * 2 + 2;
+  raw.timings[0] = 10850;
+  for (unsigned int i = 0; i < frame.bitLength; i++) {
+    const bool bit = (frame.payload[i / 32] >> (i % 32)) & 1;
+    raw.timings[1 + i * 2] = bit ? 1050 + i : 350 - i;
+    raw.timings[2 + i * 2] = bit ? 350 + i : 1050 - i;
+  }
+  raw.timings[raw.count - 1] = 350;
+}
+
+static bool sameFrame (const Frame& a, const Frame& b) {
+  return a.decoder == b.decoder && a.protocol == b.protocol && a.bitLength == b.bitLength &&
+    a.period == b.period && a.flags == b.flags && memcmp(a.payload, b.payload, sizeof(a.payload)) == 0;
+}
+
+static void checkEncoding () {
+  uint8_t record[CaptureLog::MAX_RECORD_SIZE];
+  Frame decoded;
+  uint32_t delta;
+  static RawCapture raw, decodedRaw;
+
+  // Type 1, longest frame, with raw timings
+  Type1Data t1;
+  t1.clear();
+  t1.decimal = 0xA5C3F00FUL;
+  t1.protocol = 7;
+  t1.delay = 420;
+  t1.length = RCSWITCH_MAX_BITS;
+  Frame frame = createFrame(t1);
+  for (unsigned int i = 1; i < FRAME_PAYLOAD_WORDS; i++) {
+    frame.payload[i] = 0x12345678UL * i;
+  }
+  frame.flags |= FRAME_FLAG_RAW | FRAME_FLAG_ECHO;
+  createRaw(raw, frame);
+  unsigned int length = CaptureLog::encode(record, frame, 123456, &raw);
+  CHECK(length <= CaptureLog::MAX_RECORD_SIZE);
+  CHECK(CaptureLog::decode(record, length, decoded, delta, &decodedRaw));
+  CHECK(sameFrame(decoded, frame));
+  CHECK(delta == 123456);
+  CHECK(decodedRaw.count == raw.count && memcmp(decodedRaw.timings, raw.timings, raw.count * 2) == 0);
+  // Without its raw timings
+  CHECK(CaptureLog::decode(record, length, decoded, delta, nullptr));
+  // Damaged: checksum, truncated
+  record[length / 2] ^= 0x10;
+  CHECK(!CaptureLog::decode(record, length, decoded, delta, &decodedRaw));
+  record[length / 2] ^= 0x10;
+  CHECK(!CaptureLog::decode(record, length - 1, decoded, delta, &decodedRaw));
+
+  // Type 2 with dim level, no raw timings
+  Type2Data t2;
+  t2.clear();
+  t2.period = 260;
+  t2.address = 0x2ABCDEF;
+  t2.unit = 9;
+  t2.switchType = Type2Data::dim;
+  t2.dimLevelPresent = true;
+  t2.dimLevel = 11;
+  frame = createFrame(t2);
+  length = CaptureLog::encode(record, frame, 0, nullptr);
+  CHECK(CaptureLog::decode(record, length, decoded, delta, &decodedRaw));
+  CHECK(sameFrame(decoded, frame));
+  CHECK(delta == 0 && decodedRaw.count == 0);
+  CHECK(decoded.address() == 0x2ABCDEF && decoded.dimLevel() == 11);
+}
+
+/**
+ * Read the whole log: the records must be consecutive, up to "last"
+ *
+ * @return The number of records
+ */
+static unsigned long checkRecords (CaptureLog& log, unsigned long last, uint32_t boot) {
+  LogCursor cursor;
+  LogEntry entry;
+  unsigned long count = 0;
+  unsigned long first = 0;
+  log.first(cursor);
+  while (log.next(cursor, entry, nullptr)) {
+    if (count == 0) {
+      first = entry.frame.payload[0];
+    }
+    const Frame expected = createRecord(first + count);
+    CHECK(sameFrame(entry.frame, expected));
+    CHECK(entry.frame.timestamp == expected.timestamp);
+    CHECK(entry.boot == boot);
+    count++;
+  }
+  CHECK(count > 0 && first + count - 1 == last);
+  return count;
+}
+
+static void checkRing () {
+  TimerWheel timers;
+  CaptureLog log = CaptureLog(timers, 1000);
+  CHECK(log.begin(STORAGE, SECTORS));
+  CHECK(log.usedSectors() == 0 && log.boot() == 0);
+  for (unsigned long i = 0; i < RECORDS; i++) {
+    CHECK(log.append(createRecord(i), nullptr));
+  }
+  // Wrapped: every sector used, the oldest records erased
+  CHECK(log.usedSectors() == SECTORS);
+  CHECK(log.erases() > SECTORS);
+  CHECK(log.failed() == 0);
+  const unsigned long count = checkRecords(log, RECORDS - 1, 0);
+  CHECK(count < RECORDS);
+
+  // Tail: the last records only, from the newest sectors
+  LogCursor cursor;
+  LogEntry entry;
+  unsigned long skip = log.tail(cursor, 10);
+  unsigned long index = 0;
+  while (log.next(cursor, entry, nullptr)) {
+    if (index >= skip) {
+      CHECK(entry.frame.payload[0] == RECORDS - 10 + (index - skip));
+    }
+    index++;
+  }
+  CHECK(index - skip == 10);
+  CHECK(index < count);
+  // More than the whole log: every record
+  skip = log.tail(cursor, RECORDS);
+  index = 0;
+  while (log.next(cursor, entry, nullptr)) {
+    index++;
+  }
+  CHECK(skip == 0 && index == count);
+  log.flush();
+}
+
+static void checkReopen () {
+  TimerWheel timers;
+  CaptureLog log = CaptureLog(timers, 1000);
+  CHECK(log.begin(STORAGE, SECTORS));
+  // Next boot: the records of the previous one are found
+  CHECK(log.boot() == 1);
+  CHECK(log.usedSectors() == SECTORS);
+  const unsigned long count = checkRecords(log, RECORDS - 1, 0);
+
+  // A new record starts a new sector (the oldest one is erased)
+  Frame frame = createRecord(RECORDS);
+  CHECK(log.append(frame, nullptr));
+  CHECK(log.erases() == 1);
+  LogCursor cursor;
+  LogEntry entry;
+  log.tail(cursor, 1);
+  unsigned long index = 0;
+  while (log.next(cursor, entry, nullptr)) {
+    index++;
+  }
+  CHECK(index == 1 && entry.boot == 1 && sameFrame(entry.frame, frame));
+  unsigned long total = 0;
+  log.first(cursor);
+  while (log.next(cursor, entry, nullptr)) {
+    total++;
+  }
+  CHECK(total < count + 1);
+}
+
+static void checkBusy () {
+  TimerWheel timers;
+  CaptureLog log = CaptureLog(timers, 1000, isBusy);
+  CHECK(log.begin(STORAGE, SECTORS));
+  CHECK(log.clear());
+
+  // Busy: nothing programmed nor erased (the first record needs a sector)
+  static RawCapture raw;
+  busy = true;
+  unsigned long appended = 0;
+  for (; appended < 8; appended++) {
+    Frame frame = createRecord(appended);
+    frame.flags |= FRAME_FLAG_RAW;
+    createRaw(raw, frame);
+    CHECK(log.append(frame, &raw));
+  }
+  CHECK(log.pending() == appended);
+  log.flush();
+  CHECK(!log.clear());
+  CHECK(log.pageWrites() == 0 && log.erases() == 0);
+  LogEntry entry;
+  CHECK(!log.writePending(entry));
+  // Kept in RAM up to its size, then refused
+  unsigned long refused = 0;
+  while (refused == 0 && appended < RECORDS) {
+    Frame frame = createRecord(appended);
+    frame.flags |= FRAME_FLAG_RAW;
+    createRaw(raw, frame);
+    if (log.append(frame, &raw)) {
+      appended++;
+    } else {
+      refused++;
+    }
+  }
+  CHECK(log.failed() == 1);
+  CHECK(log.pageWrites() == 0 && log.erases() == 0);
+
+  // Free: written in order, with their own time and raw timings
+  busy = false;
+  unsigned long written = 0;
+  while (log.writePending(entry)) {
+    CHECK(entry.frame.payload[0] == written);
+    CHECK(entry.boot == log.boot());
+    written++;
+  }
+  CHECK(written == appended && log.pending() == 0);
+  log.flush();
+  CHECK(log.pageWrites() > 0 && log.erases() == 1);
+  LogCursor cursor;
+  static RawCapture expected;
+  unsigned long index = 0;
+  log.first(cursor);
+  while (log.next(cursor, entry, &raw)) {
+    const Frame frame = createRecord(index);
+    CHECK(entry.frame.payload[0] == index && entry.frame.timestamp == frame.timestamp);
+    createRaw(expected, frame);
+    CHECK(raw.count == expected.count && memcmp(raw.timings, expected.timings, raw.count * 2) == 0);
+    index++;
+  }
+  CHECK(index == appended);
+}
+
+static void checkReadWhileAppending () {
+  TimerWheel timers;
+  CaptureLog log = CaptureLog(timers, 1000, isBusy);
+  CHECK(log.begin(STORAGE, SECTORS));
+  CHECK(log.clear());
+  unsigned long appended = 0;
+  for (; appended < RECORDS; appended++) {
+    CHECK(log.append(createRecord(appended), nullptr));
+  }
+  CHECK(log.usedSectors() == SECTORS);
+
+  // Two records appended per record read
+  LogCursor cursor;
+  LogEntry entry;
+  unsigned long first = 0;
+  unsigned long count = 0;
+  const unsigned long erases = log.erases();
+  log.first(cursor);
+  busy = true;
+  while (log.next(cursor, entry, nullptr)) {
+    if (count == 0) {
+      first = entry.frame.payload[0];
+    }
+    CHECK(entry.frame.payload[0] == first + count);
+    count++;
+    for (unsigned int i = 0; i < 2; i++) {
+      if (log.append(createRecord(appended), nullptr)) {
+        appended++;
+      }
+    }
+    log.writePending(entry);
+  }
+  busy = false;
+  CHECK(count > 0 && first + count <= RECORDS);
+  CHECK(log.erases() == erases);
+  while (log.writePending(entry)) {
+  }
+  checkRecords(log, appended - 1, log.boot());
+}
+
+int main () {
+  remove(STORAGE);
+  checkEncoding();
+  checkRing();
+  checkReopen();
+  checkBusy();
+  checkReadWhileAppending();
+  remove(STORAGE);
+  return checkResult("capture log");
+}
@@ -0,0 +1,170 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+// Code library over the file backed flash region (see FlashRegion.h):
+// - a code is found again as it was saved (frame, waveform)
+// - saving a name replaces its code, deleting it rebuilds the index (the
+//   other names are still found)
+// - a full bank is compacted into the other one, without the deleted and
+//   replaced codes
+// - the library is found again when it is reopened (next boot)
+// - nothing is written while the device is busy
+
+#include <Arduino.h>
+#include <cstdio>
+#include "Check.h"
+#include "CodeLibrary.h"
+
+static const char* const STORAGE = "test_code_library.bin";
+// One sector per bank
+static const unsigned int SECTORS = 2;
+static const unsigned int NAMES = 6;
+
+static bool busy = false;
+
+static bool isBusy () {
+  return busy;
+}
+
+// Version of the code saved for each name, 0 if deleted
+static unsigned int versions[NAMES];
+
+static void nameOf (char* name, unsigned int index) {
+  snprintf(name, CodeLibrary::MAX_NAME + 1, "code-%u", index);
+}
+
+/**
+ * The code of a name in a given version: its levels depend on both
+ */
+static Frame createCode (Waveform& waveform, unsigned int index, unsigned int version) {
+  Type1Data data;
+  data.clear();
+  data.decimal = index * 1000 + version;
+  data.protocol = 1;
+  data.delay = 350;
+  data.length = 24;
+  waveform.count = 100 + (index * 7 + version * 13) % 48;
+  waveform.inverted = version % 2 == 1;
+  for (unsigned int i = 0; i < waveform.count; i++) {
+    waveform.durations[i] = 300 + index * 100 + version * 10 + i;
+  }
+  return createFrame(data);
+}
+
+static bool save (CodeLibrary& library, unsigned int index, unsigned int version) {
+  static Waveform waveform;
+  char name[CodeLibrary::MAX_NAME + 1];
+  nameOf(name, index);
+  const Frame frame = createCode(waveform, index, version);
+  if (!library.save(name, frame, waveform, 1, 3)) {
+    return false;
+  }
+  versions[index] = version;
+  return true;
+}
+
+/**
+ * Every name is found with its last version, the deleted ones are not
+ */
+static void checkCodes (CodeLibrary& library) {
+  static Waveform expected, waveform;
+  unsigned int count = 0;
+  for (unsigned int index = 0; index < NAMES; index++) {
+    char name[CodeLibrary::MAX_NAME + 1];
+    nameOf(name, index);
+    LibraryCode code;
+    if (versions[index] == 0) {
+      CHECK(!library.find(name, code));
+      continue;
+    }
+    count++;
+    const Frame frame = createCode(expected, index, versions[index]);
+    CHECK(library.find(name, code));
+    CHECK(strcmp(code.name, name) == 0);
+    CHECK(code.frame.payload[0] == frame.payload[0] && code.first == 1 && code.repeats == 3);
+    CHECK(library.load(code, waveform));
+    CHECK(waveform.count == expected.count && waveform.inverted == expected.inverted);
+    CHECK(memcmp(waveform.durations, expected.durations, expected.count * sizeof(unsigned int)) == 0);
+  }
+  CHECK(library.count() == count);
+  // Listed once each
+  unsigned int position = 0;
+  unsigned int listed = 0;
+  LibraryCode code;
+  while (library.next(position, code)) {
+    unsigned int index = 0;
+    CHECK(sscanf(code.name, "code-%u", &index) == 1 && index < NAMES && versions[index] != 0);
+    CHECK(code.frame.payload[0] == index * 1000 + versions[index]);
+    listed++;
+  }
+  CHECK(listed == count);
+}
+
+static void checkEdit (CodeLibrary& library) {
+  CHECK(library.begin(STORAGE, 0, SECTORS));
+  CHECK(library.count() == 0);
+  for (unsigned int index = 0; index < NAMES; index++) {
+    CHECK(save(library, index, 1));
+  }
+  checkCodes(library);
+
+  // Replaced: still one code for the name
+  CHECK(save(library, 2, 2));
+  checkCodes(library);
+
+  // Deleted: the names after it in the index are still found
+  char name[CodeLibrary::MAX_NAME + 1];
+  nameOf(name, 1);
+  CHECK(library.remove(name));
+  versions[1] = 0;
+  CHECK(!library.remove(name));
+  CHECK(!library.remove("unknown"));
+  checkCodes(library);
+
+  // Busy: nothing written
+  busy = true;
+  const unsigned long available = library.available();
+  Waveform waveform;
+  CHECK(!library.save(name, createCode(waveform, 1, 3), waveform, 1, 3));
+  nameOf(name, 0);
+  CHECK(!library.remove(name));
+  CHECK(library.available() == available);
+  busy = false;
+  checkCodes(library);
+}
+
+static void checkCompaction (CodeLibrary& library) {
+  // Replaced until the bank is full: compacted, then full again
+  unsigned int compactions = 0;
+  for (unsigned int version = 3; version < 40; version++) {
+    const unsigned long available = library.available();
+    CHECK(save(library, version % NAMES, version));
+    if (library.available() > available) {
+      compactions++;
+    }
+  }
+  CHECK(compactions >= 2);
+  checkCodes(library);
+}
+
+static void checkReopen () {
+  CodeLibrary library = CodeLibrary(isBusy);
+  CHECK(library.begin(STORAGE, 0, SECTORS));
+  checkCodes(library);
+}
+
+int main () {
+  remove(STORAGE);
+  CodeLibrary library = CodeLibrary(isBusy);
+  checkEdit(library);
+  checkCompaction(library);
+  checkReopen();
+  remove(STORAGE);
+  return checkResult("code library");
+}
@@ -0,0 +1,69 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+// Numbers printed by the formatter, up to the limits of the types (unsigned
+// long is 64 bits on most hosts)
+
+#include <Arduino.h>
+#include <limits.h>
+#include <limits>
+#include "Check.h"
+#include "Formatter.h"
+
+static Formatter formatter;
+
+/**
+ * To know if the formatter holds text
+ */
+static bool holds (const char* text) {
+  return formatter.length() == strlen(text) && memcmp(formatter.data(), text, formatter.length()) == 0;
+}
+
+template <typename T>
+static void checkNumber (T value) {
+  char expected[32];
+  if constexpr (std::numeric_limits<T>::is_signed) {
+    snprintf(expected, sizeof(expected), "%lld", (long long)value);
+  } else {
+    snprintf(expected, sizeof(expected), "%llu", (unsigned long long)value);
+  }
+  formatter.clear();
+  formatter.print(value);
+  CHECK(holds(expected));
+}
+
+int main () {
+  static const unsigned long values[] = { 0, 1, 9, 10, 99, 100, 101, 999, 1000, 5592332, 4294967295UL };
+  for (unsigned long value : values) {
+    checkNumber(value);
+    checkNumber((long)value);
+    checkNumber(-(long)value);
+  }
+  for (unsigned long value = 1; value < ULONG_MAX / 10; value *= 10) {
+    checkNumber(value * 10 - 1);
+    checkNumber(value * 10);
+  }
+  checkNumber(ULONG_MAX);
+  checkNumber(LONG_MAX);
+  checkNumber(LONG_MIN);
+  checkNumber(UINT_MAX);
+  checkNumber(INT_MIN);
+
+  // Numbers among text
+  formatter.clear();
+  formatter.print("code ");
+  formatter.print(ULONG_MAX);
+  formatter.print(' ');
+  formatter.print(-42);
+  char expected[64];
+  snprintf(expected, sizeof(expected), "code %lu -42", ULONG_MAX);
+  CHECK(holds(expected));
+
+  return checkResult("formatter");
+}
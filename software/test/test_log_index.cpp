@@ -0,0 +1,249 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+// Capture log index over the file backed flash region, checked against a
+// scan of the whole log:
+// - a protocol query returns the records of a scan, and only reads the
+//   sectors holding that protocol
+// - the summary of a sector is reset when the sector is used again
+// - the top talkers keep the frequent codes, with an upper bound of their
+//   count, sorted
+// - "LOG LAST" finds the record of a scan, from a top talker or by reading
+//   the sectors
+// - the index is built again when the log is reopened (next boot)
+
+#include <Arduino.h>
+#include <cstdio>
+#include "Check.h"
+#include "LogIndex.h"
+
+static const char* const STORAGE = "test_log_index.bin";
+static const unsigned int SECTORS = 8;
+// Records of a protocol in a row (about a sector)
+static const unsigned long RUN = 300;
+static const unsigned long RECORDS = 1500;
+// Frequent codes (see codeOf)
+static const unsigned int FREQUENT = 5;
+
+static unsigned long appended = 0;
+// Records of each frequent code appended
+static unsigned long frequentCounts[FREQUENT];
+
+/**
+ * Code of a record: out of 30 records, 5 of the first frequent code, 4 of
+ * the second... then 15 codes seen once
+ */
+static uint32_t codeOf (unsigned long index) {
+  static const uint8_t slots[15] = { 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 3, 3, 4 };
+  const unsigned int slot = index % 30;
+  return slot < 15 ? 100 + slots[slot] : 10000 + index;
+}
+
+static Frame createRecord (unsigned long index, uint8_t protocol) {
+  Type1Data data;
+  data.clear();
+  data.decimal = codeOf(index);
+  data.protocol = protocol;
+  data.delay = 350;
+  data.length = 24;
+  Frame frame = createFrame(data);
+  frame.timestamp = 1000 + index * 7;
+  return frame;
+}
+
+static void append (LogIndex& index, uint8_t protocol, unsigned long count) {
+  for (unsigned long i = 0; i < count; i++, appended++) {
+    const uint32_t code = codeOf(appended);
+    if (code < 100 + FREQUENT) {
+      frequentCounts[code - 100]++;
+    }
+    CHECK(index.append(createRecord(appended, protocol), nullptr));
+  }
+}
+
+static bool sameEntry (const LogEntry& a, const LogEntry& b) {
+  return a.address == b.address && a.boot == b.boot && a.frame.timestamp == b.frame.timestamp &&
+    memcmp(a.frame.payload, b.frame.payload, sizeof(a.frame.payload)) == 0;
+}
+
+/**
+ * A protocol query returns the records of a scan, from the sectors holding
+ * that protocol only
+ */
+static void checkProtocol (CaptureLog& log, LogIndex& index, uint8_t protocol) {
+  // Scan: the records, and the sectors holding them
+  LogEntry expected[RECORDS];
+  unsigned long count = 0;
+  bool holding[SECTORS] = {};
+  unsigned int sectors = 0;
+  LogCursor cursor;
+  LogEntry entry;
+  log.first(cursor);
+  while (log.next(cursor, entry, nullptr)) {
+    if (entry.frame.protocol != protocol) {
+      continue;
+    }
+    const unsigned int sector = entry.address / FlashRegion::SECTOR_SIZE;
+    if (!holding[sector]) {
+      holding[sector] = true;
+      sectors++;
+    }
+    CHECK(count < RECORDS);
+    if (count < RECORDS) {
+      expected[count++] = entry;
+    }
+  }
+
+  LogQuery query;
+  query.clear();
+  query.byProtocol = true;
+  query.protocol = protocol;
+  const unsigned long read = index.sectorsRead();
+  const unsigned long skipped = index.sectorsSkipped();
+  unsigned long found = 0;
+  index.start(query);
+  while (index.next(query, entry, nullptr)) {
+    CHECK(found < count && sameEntry(entry, expected[found]));
+    found++;
+  }
+  CHECK(found == count);
+  // Protocols below 32: the summaries are exact
+  CHECK(index.sectorsRead() - read == sectors);
+  CHECK(index.sectorsSkipped() - skipped == SECTORS - sectors);
+}
+
+/**
+ * Last record of a code, from a scan
+ */
+static bool scanLast (CaptureLog& log, uint32_t key, LogEntry& last) {
+  LogCursor cursor;
+  LogEntry entry;
+  bool found = false;
+  log.first(cursor);
+  while (log.next(cursor, entry, nullptr)) {
+    if (LogIndex::key(entry.frame) == key) {
+      last = entry;
+      found = true;
+    }
+  }
+  return found;
+}
+
+static bool isTalker (LogIndex& index, uint32_t key) {
+  for (unsigned int rank = 0; rank < index.talkers(); rank++) {
+    if (index.talker(rank).key == key) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * The codes more frequent than 1 out of TALKERS are kept, in order, with an
+ * upper bound of their count
+ */
+static void checkTalkers (LogIndex& index, unsigned long total, const unsigned long* counts) {
+  CHECK(index.talkers() == LogIndex::TALKERS);
+  // Every record is counted once: a new code takes the count of the one it replaces
+  unsigned long sum = index.talker(0).count;
+  for (unsigned int rank = 1; rank < index.talkers(); rank++) {
+    CHECK(index.talker(rank - 1).count >= index.talker(rank).count);
+    sum += index.talker(rank).count;
+  }
+  CHECK(sum == total);
+  for (unsigned int i = 0; i < FREQUENT; i++) {
+    if (counts[i] * LogIndex::TALKERS <= total) {
+      continue;
+    }
+    CHECK(index.talker(i).key == LogIndex::key(FRAME_TYPE1, 100 + i));
+    CHECK(index.talker(i).count >= counts[i]);
+  }
+}
+
+static void checkLast (CaptureLog& log, LogIndex& index) {
+  LogEntry entry, expected;
+  // A top talker: no sector read
+  const uint32_t frequent = LogIndex::key(FRAME_TYPE1, 100);
+  CHECK(isTalker(index, frequent));
+  const unsigned long read = index.sectorsRead();
+  CHECK(index.last(frequent, entry));
+  CHECK(index.sectorsRead() == read);
+  CHECK(scanLast(log, frequent, expected) && sameEntry(entry, expected));
+
+  // Seen once, out of the top talkers: read from the newest sector holding it
+  unsigned long once = appended - 1;
+  while (codeOf(once) < 10000 || isTalker(index, LogIndex::key(FRAME_TYPE1, codeOf(once)))) {
+    once--;
+  }
+  const uint32_t key = LogIndex::key(FRAME_TYPE1, codeOf(once));
+  CHECK(index.last(key, entry));
+  CHECK(index.sectorsRead() > read);
+  CHECK(scanLast(log, key, expected) && sameEntry(entry, expected));
+
+  // Never seen (or erased from the log)
+  CHECK(!index.last(LogIndex::key(FRAME_TYPE1, 7), entry));
+  CHECK(!index.last(LogIndex::key(FRAME_TYPE1, 10000), entry) && !scanLast(log, LogIndex::key(FRAME_TYPE1, 10000), expected));
+}
+
+int main () {
+  remove(STORAGE);
+  TimerWheel timers;
+  CaptureLog log = CaptureLog(timers, 1000);
+  LogIndex index = LogIndex(log);
+  CHECK(log.begin(STORAGE, SECTORS));
+  CHECK(index.begin());
+
+  // Protocols 1 to 5, about a sector each: the ring is not full
+  for (uint8_t protocol = 1; protocol <= RECORDS / RUN; protocol++) {
+    append(index, protocol, RUN);
+  }
+  CHECK(log.usedSectors() < SECTORS && log.erases() == log.usedSectors());
+  checkTalkers(index, appended, frequentCounts);
+  for (uint8_t protocol = 1; protocol <= 6; protocol++) {
+    checkProtocol(log, index, protocol);
+  }
+  checkLast(log, index);
+
+  // Protocol 6 until the sectors of protocols 1 and 2 are used again: their
+  // summaries are reset
+  append(index, 6, RECORDS);
+  CHECK(log.erases() > SECTORS);
+  for (uint8_t protocol = 1; protocol <= 6; protocol++) {
+    checkProtocol(log, index, protocol);
+  }
+  checkLast(log, index);
+  log.flush();
+
+  // Next boot: built from the records left in the log
+  TimerWheel reopenedTimers;
+  CaptureLog reopened = CaptureLog(reopenedTimers, 1000);
+  LogIndex reindexed = LogIndex(reopened);
+  CHECK(reopened.begin(STORAGE, SECTORS));
+  CHECK(reindexed.begin());
+  unsigned long counts[FREQUENT] = {};
+  unsigned long total = 0;
+  LogCursor cursor;
+  LogEntry entry;
+  reopened.first(cursor);
+  while (reopened.next(cursor, entry, nullptr)) {
+    const uint32_t code = entry.frame.payload[0];
+    if (code >= 100 && code < 100 + FREQUENT) {
+      counts[code - 100]++;
+    }
+    total++;
+  }
+  checkTalkers(reindexed, total, counts);
+  for (uint8_t protocol = 1; protocol <= 6; protocol++) {
+    checkProtocol(reopened, reindexed, protocol);
+  }
+  checkLast(reopened, reindexed);
+
+  remove(STORAGE);
+  return checkResult("log index");
+}
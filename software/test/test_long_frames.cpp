@@ -0,0 +1,105 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+// Type 1 frames longer than 32 bits: synthetic transmissions (RCSwitch
+// protocol 1, sent 3 times) are fed to RCSwitch::handleEdge, and the decoded
+// words must be the sent code, bit for bit, up to RCSWITCH_MAX_BITS.
+
+#include <Arduino.h>
+#include <RCSwitch.h>
+#include "Check.h"
+
+static const unsigned int LENGTHS[] = { 40, 64, 66, 100, 128 };
+static const unsigned int REPEATS = 3;
+
+static unsigned long now = 0;
+
+static uint32_t rng = 1;
+
+// xorshift32
+static uint32_t random32 () {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+/**
+ * A level of the given duration: its first edge is now
+ */
+static void level (unsigned long duration) {
+  RCSwitch::handleEdge(now);
+  now += duration;
+}
+
+/**
+ * Send a code of "length" bits (words: least significant first), from its
+ * most significant bit, then the sync pulse
+ */
+static void send (const uint32_t* words, unsigned int length) {
+  const RCSwitch::Protocol protocol = RCSwitch::getProtocol(1);
+  const unsigned long T = protocol.pulseLength;
+  for (unsigned int r = 0; r < REPEATS; r++) {
+    for (int i = length - 1; i >= 0; i--) {
+      const RCSwitch::HighLow& pulses = (words[i / 32] >> (i % 32)) & 1 ? protocol.one : protocol.zero;
+      level(T * pulses.high);
+      level(T * pulses.low);
+    }
+    level(T * protocol.syncFactor.high);
+    level(T * protocol.syncFactor.low);
+  }
+  // End of the last sync
+  RCSwitch::handleEdge(now);
+  // Silence before the next transmission
+  now += 100000;
+}
+
+static void checkLength (RCSwitch& rcSwitch, unsigned int length, const uint32_t* words) {
+  uint32_t code[RCSWITCH_MAX_WORDS] = {};
+  for (unsigned int w = 0; w * 32 < length; w++) {
+    const unsigned int bits = length - w * 32;
+    code[w] = bits >= 32 ? words[w] : words[w] & ((1UL << bits) - 1);
+  }
+  send(code, length);
+  CHECK(rcSwitch.available());
+  CHECK(rcSwitch.getReceivedBitlength() == length);
+  CHECK(rcSwitch.getReceivedProtocol() == 1);
+  CHECK(memcmp(rcSwitch.getReceivedWords(), code, sizeof(code)) == 0);
+  CHECK(rcSwitch.getReceivedValue() == code[0]);
+  rcSwitch.resetAvailable();
+}
+
+int main () {
+  RCSwitch rcSwitch = RCSwitch();
+  static_assert(RCSWITCH_MAX_BITS >= 128, "The longest frames are decoded");
+  for (unsigned int l = 0; l < sizeof(LENGTHS) / sizeof(LENGTHS[0]); l++) {
+    const unsigned int length = LENGTHS[l];
+    uint32_t words[RCSWITCH_MAX_WORDS];
+    // Random codes, and the bits at the word boundaries
+    for (unsigned int n = 0; n < 20; n++) {
+      for (unsigned int w = 0; w < RCSWITCH_MAX_WORDS; w++) {
+        words[w] = random32();
+      }
+      checkLength(rcSwitch, length, words);
+    }
+    for (unsigned int w = 0; w < RCSWITCH_MAX_WORDS; w++) {
+      words[w] = 0x80000001UL;
+    }
+    checkLength(rcSwitch, length, words);
+    // Leading zeros: only its last bit set
+    memset(words, 0, sizeof(words));
+    words[0] = 1;
+    checkLength(rcSwitch, length, words);
+    // Only its first bit (the most significant one)
+    memset(words, 0, sizeof(words));
+    words[(length - 1) / 32] = 1UL << ((length - 1) % 32);
+    checkLength(rcSwitch, length, words);
+  }
+  return checkResult("long frames");
+}
@@ -0,0 +1,55 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+// Encode-to-decode loopback test (the "TEST" command) over a fixed set of
+// seeds: every protocol must decode most of its frames, despite the jitter
+// and the dropped pulses.
+//
+// Known findings, not checked: type 1 protocol 4 never decodes (its sync gap
+// is below the RCSwitch separation limit) and protocol 9 decodes as 8.
+
+#include <Arduino.h>
+#include "Check.h"
+#include "SelfTest.h"
+
+static const unsigned long SEEDS[] = { 1, 2, 3, 12345, 0xDEADBEEF, 0x9E3779B9 };
+static const unsigned long FRAMES = 2600;
+// Minimum decode rate (in percent): 10% of the frames lose a pulse, and a
+// frame may still decode from its other repeats
+static const unsigned long MIN_RATE = 85;
+
+static bool isKnownFinding (int target) {
+  return target == 4 - 1 || target == 9 - 1;
+}
+
+int main () {
+  for (unsigned long seed : SEEDS) {
+    LoopbackResult result;
+    runLoopbackTest(result, FRAMES, seed);
+    printf("seed %lu\n", seed);
+    printLoopbackResult(result);
+
+    unsigned long total = 0;
+    for (int target = 0; target < result.targets; target++) {
+      total += result.attempts[target];
+      CHECK(result.decoded[target] <= result.attempts[target]);
+      if (!isKnownFinding(target)) {
+        CHECK(result.attempts[target] > 0);
+        CHECK(result.decoded[target] * 100 >= result.attempts[target] * MIN_RATE);
+      }
+    }
+    CHECK(total == FRAMES);
+
+    // Same seed, same frames
+    LoopbackResult again;
+    runLoopbackTest(again, FRAMES, seed);
+    CHECK(memcmp(again.decoded, result.decoded, sizeof(result.decoded)) == 0);
+  }
+  return checkResult("loopback");
+}
@@ -0,0 +1,292 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+// Output queue in front of a slow serial port (availableForWrite returns a
+// few bytes, or none):
+// - a frame dropped behind a partly written one: the following bytes are
+//   moved over it across the end of the ring, the written frame completes
+// - coalescing: a frame with the key of the last queued one is dropped,
+//   unless that one is being written
+// - OUTPUT_DROP_RAW: the raw section is replaced when the frame doesn't fit,
+//   the frame is dropped when it doesn't fit without it
+// - random frames under each policy: the output is whole frames, in order,
+//   never more bytes than available, and the counters account for every
+//   frame and byte not written
+
+#include <Arduino.h>
+#include <string>
+#include <vector>
+#include "Check.h"
+#include "OutputQueue.h"
+
+/**
+ * Serial port taking a given number of bytes per call to availableForWrite
+ */
+class SlowOutput : public Print {
+  public:
+    std::string written;
+    // Bytes available at each call (cycled), random if empty
+    std::vector<int> script;
+    // If drain() writes no more than available (drainAll() waits instead)
+    bool limited = true;
+
+    size_t write (uint8_t c) override {
+      return write(&c, 1);
+    }
+
+    size_t write (const uint8_t* bytes, size_t length) override {
+      if (limited) {
+        CHECK((int)length <= _available);
+        _available -= length;
+      }
+      written.append((const char*)bytes, length);
+      return length;
+    }
+
+    int availableForWrite () override {
+      if (script.empty()) {
+        _rng = _rng * 1103515245UL + 12345UL;
+        _available = (_rng >> 16) % 9;
+      } else {
+        _available = script[_call++ % script.size()];
+      }
+      return _available;
+    }
+
+  private:
+    int _available = 0;
+    unsigned int _call = 0;
+    uint32_t _rng = 1;
+};
+
+static Formatter frame;
+
+/**
+ * Frame "<id>:<text><raw>\n" (raw: the optional section)
+ */
+static std::string render (unsigned int id, unsigned int textLength, unsigned int rawLength) {
+  frame.clear();
+  frame.print(id);
+  frame.print(':');
+  for (unsigned int i = 0; i < textLength; i++) {
+    frame.print((char)('a' + (id + i) % 26));
+  }
+  if (rawLength > 0) {
+    frame.beginOptional();
+    for (unsigned int i = 0; i < rawLength; i++) {
+      frame.print((char)('0' + (id + i) % 10));
+    }
+    frame.endOptional();
+  }
+  frame.print('\n');
+  return std::string(frame.data(), frame.length());
+}
+
+/**
+ * The frame without its raw section
+ */
+static std::string strip (const std::string& full, unsigned int rawLength) {
+  return full.substr(0, full.length() - 1 - rawLength) + OUTPUT_DROPPED_RAW + "\n";
+}
+
+static void checkDropBehindPartial () {
+  OutputQueue<64, 4> queue = OutputQueue<64, 4>(OUTPUT_DROP_OLDEST);
+  SlowOutput out;
+  // Filler: the next frames start at byte 40
+  const std::string filler = render(0, 37, 0);
+  CHECK(filler.length() == 40);
+  CHECK(queue.push(frame));
+  out.limited = false;
+  queue.drainAll(out);
+  out.limited = true;
+
+  const std::string a = render(1, 17, 0);
+  CHECK(queue.push(frame));
+  out.script = { 5, 0 };
+  queue.drain(out);
+  CHECK(out.written == filler + a.substr(0, 5));
+  // B wraps around the end of the ring, C follows it
+  const std::string b = render(2, 13, 0);
+  CHECK(queue.push(frame));
+  const std::string c = render(3, 7, 0);
+  CHECK(queue.push(frame));
+  CHECK(queue.used() == a.length() - 5 + b.length() + c.length());
+
+  // D doesn't fit: B is dropped (A is being written), C is moved over it
+  const std::string d = render(4, 27, 0);
+  CHECK(queue.push(frame));
+  CHECK(queue.count() == 3);
+  CHECK(queue.droppedFrames() == 1 && queue.droppedBytes() == b.length());
+  CHECK(queue.used() == a.length() - 5 + c.length() + d.length());
+  out.limited = false;
+  queue.drainAll(out);
+  CHECK(out.written == filler + a + c + d);
+  CHECK(queue.used() == 0 && queue.count() == 0);
+}
+
+static void checkCoalesce () {
+  OutputQueue<256, 8> queue = OutputQueue<256, 8>(OUTPUT_COALESCE);
+  SlowOutput out;
+  const std::string a = render(1, 20, 0);
+  CHECK(queue.push(frame, 7));
+  // Same key as the last queued frame
+  render(2, 20, 0);
+  CHECK(!queue.push(frame, 7));
+  CHECK(queue.coalescedFrames() == 1 && queue.count() == 1 && queue.used() == a.length());
+  CHECK(frame.length() == 0);
+  // Key 0: never coalesced
+  const std::string b = render(3, 5, 0);
+  CHECK(queue.push(frame, 0));
+  const std::string c = render(4, 5, 0);
+  CHECK(queue.push(frame, 0));
+  out.limited = false;
+  queue.drainAll(out);
+  out.limited = true;
+
+  // The last queued frame is being written: queued anyway
+  const std::string d = render(5, 20, 0);
+  CHECK(queue.push(frame, 7));
+  out.script = { 3, 0 };
+  queue.drain(out);
+  const std::string e = render(6, 20, 0);
+  CHECK(queue.push(frame, 7));
+  // Then coalesced with that one
+  render(7, 20, 0);
+  CHECK(!queue.push(frame, 7));
+  // Another key
+  const std::string f = render(8, 20, 0);
+  CHECK(queue.push(frame, 8));
+  CHECK(queue.coalescedFrames() == 2 && queue.droppedFrames() == 0 && queue.droppedBytes() == 0);
+  out.limited = false;
+  queue.drainAll(out);
+  CHECK(out.written == a + b + c + d + e + f);
+}
+
+static void checkDropRaw () {
+  OutputQueue<100, 4> queue = OutputQueue<100, 4>(OUTPUT_DROP_RAW);
+  SlowOutput out;
+  const std::string a = render(1, 49, 0);
+  CHECK(a.length() == 52);
+  CHECK(queue.push(frame));
+  // Fits with its raw section: kept
+  const std::string b = render(2, 11, 20);
+  CHECK(b.length() == 34);
+  CHECK(queue.push(frame));
+  CHECK(queue.strippedFrames() == 0);
+
+  // 14 bytes left: stripped to "3:(dropped)\n" (12 bytes)
+  const std::string c = render(3, 0, 30);
+  CHECK(queue.push(frame));
+  CHECK(queue.strippedFrames() == 1 && queue.droppedFrames() == 0);
+  CHECK(queue.droppedBytes() == 30 - strlen(OUTPUT_DROPPED_RAW));
+  CHECK(queue.used() == a.length() + b.length() + 12);
+  // Too long, even without its raw section
+  const std::string d = render(4, 10, 30);
+  CHECK(!queue.push(frame));
+  // No raw section to drop
+  render(5, 10, 0);
+  CHECK(!queue.push(frame));
+  CHECK(queue.droppedFrames() == 2 && queue.strippedFrames() == 1);
+  CHECK(queue.droppedBytes() == 30 - strlen(OUTPUT_DROPPED_RAW) + d.length() + 13);
+  out.limited = false;
+  queue.drainAll(out);
+  CHECK(out.written == a + b + strip(c, 30));
+
+  queue.resetCounters();
+  CHECK(queue.droppedFrames() == 0 && queue.droppedBytes() == 0 && queue.strippedFrames() == 0);
+}
+
+/**
+ * Random frames, drained by a slow output: the output is whole frames, in
+ * order, and the counters account for the others
+ */
+static void checkRandom (OutputPolicy policy) {
+  static const unsigned int FRAMES = 5000;
+  OutputQueue<160, 6> queue = OutputQueue<160, 6>(policy);
+  SlowOutput out;
+  std::vector<std::string> full, stripped;
+  std::vector<bool> coalesced;
+  uint32_t rng = 12345;
+  unsigned long coalescedCount = 0;
+  for (unsigned int id = 0; id < FRAMES; id++) {
+    rng = rng * 1103515245UL + 12345UL;
+    const unsigned int textLength = (rng >> 8) % 40;
+    const unsigned int rawLength = (rng >> 16) % 3 == 0 ? 0 : (rng >> 18) % 60;
+    full.push_back(render(id, textLength, rawLength));
+    stripped.push_back(rawLength > 0 ? strip(full.back(), rawLength) : "");
+    const unsigned long before = queue.coalescedFrames();
+    queue.push(frame, 1 + (rng >> 24) % 3);
+    CHECK(frame.length() == 0);
+    coalesced.push_back(queue.coalescedFrames() > before);
+    coalescedCount += coalesced.back() ? 1 : 0;
+    // Drained once every few frames
+    if ((rng >> 28) % 3 == 0) {
+      queue.drain(out);
+    }
+  }
+  out.limited = false;
+  queue.drainAll(out);
+  CHECK(queue.used() == 0 && queue.count() == 0);
+
+  // Whole frames in order, counted
+  unsigned long written = 0;
+  unsigned long strippedCount = 0;
+  unsigned long droppedBytes = 0;
+  unsigned int next = 0;
+  size_t position = 0;
+  while (position < out.written.length()) {
+    const size_t end = out.written.find('\n', position);
+    CHECK(end != std::string::npos);
+    if (end == std::string::npos) {
+      break;
+    }
+    const std::string line = out.written.substr(position, end + 1 - position);
+    const unsigned int id = strtoul(line.c_str(), nullptr, 10);
+    CHECK(id >= next && id < FRAMES);
+    if (id < next || id >= FRAMES) {
+      break;
+    }
+    for (; next < id; next++) {
+      if (!coalesced[next]) {
+        droppedBytes += full[next].length();
+      }
+    }
+    if (line == stripped[id]) {
+      strippedCount++;
+      droppedBytes += full[id].length() - line.length();
+    } else {
+      CHECK(line == full[id]);
+    }
+    CHECK(!coalesced[id]);
+    written++;
+    next = id + 1;
+    position = end + 1;
+  }
+  for (; next < FRAMES; next++) {
+    if (!coalesced[next]) {
+      droppedBytes += full[next].length();
+    }
+  }
+  CHECK(written + queue.droppedFrames() + queue.coalescedFrames() == FRAMES);
+  CHECK(queue.coalescedFrames() == coalescedCount);
+  CHECK(queue.strippedFrames() == strippedCount);
+  CHECK(queue.droppedBytes() == droppedBytes);
+  // The queue has been full
+  CHECK(queue.droppedFrames() + queue.strippedFrames() + queue.coalescedFrames() > 0);
+}
+
+int main () {
+  checkDropBehindPartial();
+  checkCoalesce();
+  checkDropRaw();
+  checkRandom(OUTPUT_DROP_OLDEST);
+  checkRandom(OUTPUT_DROP_RAW);
+  checkRandom(OUTPUT_COALESCE);
+  return checkResult("output queue");
+}
@@ -0,0 +1,211 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+// Task graph stress test: the decode and transmit tasks run as threads (see
+// Tasks.h) and TX_PIN is wired to RX_PIN, so that every sent signal goes
+// through the RX interrupt, the edge queue, the decoders and the frame
+// queue. Signals are queued back to back while the frames are consumed:
+// - most of them must be decoded with their code (the host scheduler may
+//   disturb a few edges)
+// - a decoded type 1 frame must carry its own raw timings
+// - every queued signal is played, and isTransmitting() tells it
+// Then signals are sent while the frames are not consumed: the frame queue
+// fills up and drops frames, the queued ones keep their own raw timings.
+
+#include <Arduino.h>
+#include <RCSwitch.h>
+#include <cstdlib>
+#include "Check.h"
+#include "Config.h"
+#include "TaskGraph.h"
+
+static const unsigned int JOBS = 24;
+// Signals sent while the frames are not consumed (type 1 only)
+static const unsigned int UNCONSUMED_JOBS = 12;
+static const unsigned int REPEATS = 8;
+// Minimum rate of decoded signals (in percent): a signal needs two clean
+// frames, and the host may delay edges
+static const unsigned int MIN_RATE = 75;
+// A host stalling a busy thread more often than this (per second, for more
+// than a pulse tolerance) disturbs most frames: the rate is not checked
+static const unsigned long MAX_STALLS = 2;
+
+static uint32_t rng = 1;
+
+/**
+ * xorshift32 pseudo-random generator
+ */
+static uint32_t random32 () {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+// Codes sent, by job
+static Frame sent[JOBS];
+static bool decoded[JOBS];
+static unsigned long rawErrors = 0;
+
+/**
+ * To know if the raw timings of a type 1 frame hold its code (protocols 1
+ * and 2: the longest level of a bit gives its value). A bit disturbed by the
+ * host scheduler (levels of about the same length) is not checked.
+ */
+static bool rawMatches (const Frame& frame, const RawCapture& raw) {
+  if (raw.count != frame.bitLength * 2 + 2) {
+    return false;
+  }
+  for (unsigned int i = 0; i < frame.bitLength; i++) {
+    const unsigned int high = raw.timings[1 + i * 2];
+    const unsigned int low = raw.timings[2 + i * 2];
+    const bool bit = (frame.payload[0] >> (frame.bitLength - 1 - i)) & 1;
+    if ((bit && 2 * low > 3 * high) || (!bit && 2 * high > 3 * low)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Handle the decoded frames
+ */
+static void consumeFrames (unsigned long timeout) {
+  Frame frame;
+  while (frameQueue.pop(frame, timeout)) {
+    if (frame.decoder == FRAME_TYPE1) {
+      const RawCapture* raw = rawCapture(frame);
+      if (raw == nullptr || !rawMatches(frame, *raw)) {
+        rawErrors++;
+      }
+    }
+    // Other frames: type 2 signals may also be decoded as type 1 protocol 2
+    for (unsigned int n = 0; n < JOBS; n++) {
+      if (sent[n].decoder == frame.decoder && sent[n].payload[0] == frame.payload[0] &&
+          (frame.decoder == FRAME_TYPE2 || sent[n].bitLength == frame.bitLength)) {
+        decoded[n] = true;
+      }
+    }
+  }
+}
+
+/**
+ * Number of stalls of a busy thread during a second (e.g. single CPU
+ * virtual machine)
+ */
+static unsigned long measureStalls () {
+  unsigned long stalls = 0;
+  const unsigned long start = micros();
+  unsigned long last = start;
+  while (last - start < 1000000) {
+    const unsigned long now = micros();
+    if (now - last > 150) {
+      stalls++;
+    }
+    last = now;
+  }
+  return stalls;
+}
+
+/**
+ * A random job: type 1 (protocol 1 or 2, 24 to 32 bits) or type 2
+ */
+static void createJob (TransmitJob& job, Frame& frame, bool type1Only) {
+  job.first = 0;
+  job.scale = 100;
+  job.repeats = REPEATS;
+  if (type1Only || random32() % 3 > 0) {
+    Type1Data data;
+    data.clear();
+    data.protocol = 1 + random32() % 2;
+    data.length = 24 + random32() % 9;
+    data.decimal = (random32() & (0xFFFFFFFFUL >> (32 - data.length))) | 1;
+    encodeWaveform(job.waveform, data);
+    frame = createFrame(data);
+  } else {
+    Type2Data data;
+    data.clear();
+    data.period = 260;
+    data.address = random32() & 0x3FFFFFF;
+    data.unit = random32() % 16;
+    data.switchType = (Type2Data::SwitchType)(random32() % 2);
+    encodeWaveform(job.waveform, data);
+    frame = createFrame(data);
+  }
+}
+
+int main () {
+  const unsigned long stalls = measureStalls();
+  static RCSwitch receiver = RCSwitch();
+  hostWire(TX_PIN, RX_PIN);
+  startTaskGraph(receiver);
+  startDecoding(true, true);
+  CHECK(!isTransmitting());
+
+  static TransmitJob job;
+  unsigned int queued = 0;
+  unsigned long refused = 0;
+  const unsigned long startedAt = millis();
+  while (queued < JOBS) {
+    createJob(job, sent[queued], false);
+    // Back to back: queued as soon as there is room
+    while (!transmitQueue.push(job)) {
+      refused++;
+      consumeFrames(50);
+    }
+    CHECK(isTransmitting());
+    queued++;
+    consumeFrames(0);
+  }
+  while (isTransmitting()) {
+    consumeFrames(5);
+  }
+  // Last frames: decoded after the end of the transmission
+  consumeFrames(100);
+  const unsigned long elapsed = millis() - startedAt;
+  const unsigned long rawErrorsConsumed = rawErrors;
+
+  // Frames left in the queue: more frames than the queue holds
+  static Frame unconsumed;
+  for (unsigned int n = 0; n < UNCONSUMED_JOBS; n++) {
+    createJob(job, unconsumed, true);
+    while (!transmitQueue.push(job)) {
+      delay(10);
+    }
+  }
+  while (isTransmitting()) {
+    delay(10);
+  }
+  delay(100);
+  CHECK(frameQueue.dropped() > 0);
+  // Raw timings of the frames left are checked (codes are not counted)
+  consumeFrames(0);
+  stopDecoding();
+
+  unsigned int decodedJobs = 0;
+  for (unsigned int n = 0; n < JOBS; n++) {
+    decodedJobs += decoded[n];
+  }
+  printf("%u/%u signals decoded in %lu ms (%lu pushes refused, %lu frames dropped, %lu edges dropped, %lu host stalls/s)\n",
+    decodedJobs, JOBS, elapsed, refused, frameQueue.dropped(), edgeQueue.dropped(), stalls);
+  if (stalls <= MAX_STALLS) {
+    CHECK(decodedJobs * 100 >= JOBS * MIN_RATE);
+  } else {
+    printf("Noisy host: decode rate not checked\n");
+    CHECK(decodedJobs > 0);
+  }
+  CHECK(rawErrorsConsumed == 0);
+  CHECK(rawErrors == 0);
+  // The transmit queue was full at times: the jobs are played one at a time
+  CHECK(refused > 0);
+  CHECK(!isTransmitting());
+  // The tasks never return: exit without destroying the queues they wait on
+  fflush(stdout);
+  std::quick_exit(checkResult("task graph"));
+}
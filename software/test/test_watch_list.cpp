@@ -0,0 +1,202 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+// Watch list against a reference set, over random adds, changes and
+// removals of a few values (long probe sequences, wrapping around the
+// table):
+// - the filters listed are the ones of the set, once each (a removal
+//   shifts the following entries back: they are still found)
+// - a signal is accepted if it matches no excluded value and, when there
+//   are included values, at least one of them; CODE never matches a frame
+//   longer than 32 bits
+// - the list is full at MAX_ENTRIES filters, and can be cleared
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <utility>
+#include "Check.h"
+#include "WatchList.h"
+
+static const unsigned int OPERATIONS = 20000;
+// Values of the filters and of the signals (40: a frame longer than 32 bits)
+static const uint32_t VALUES[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 40 };
+static const unsigned int VALUE_COUNT = sizeof(VALUES) / sizeof(VALUES[0]);
+
+typedef std::map<std::pair<unsigned int, uint32_t>, WatchMode> Reference;
+
+/**
+ * Print output, kept in a string
+ */
+class Lines : public Print {
+  public:
+    std::string text;
+
+    size_t write (uint8_t c) override {
+      text += (char)c;
+      return 1;
+    }
+};
+
+static uint32_t rng = 1;
+
+static uint32_t randomBelow (uint32_t limit) {
+  rng = rng * 1103515245UL + 12345UL;
+  return (rng >> 8) % limit;
+}
+
+static WatchMode modeOf (const Reference& reference, WatchField field, uint32_t value) {
+  Reference::const_iterator entry = reference.find(std::make_pair((unsigned int)field, value));
+  return entry == reference.end() ? WATCH_NONE : entry->second;
+}
+
+/**
+ * Reference acceptance of a signal, from its filtered fields
+ */
+static bool referenceAccepts (const Reference& reference, const WatchMode* modes, unsigned int count) {
+  bool includes = false;
+  for (Reference::const_iterator entry = reference.begin(); entry != reference.end(); entry++) {
+    includes = includes || entry->second == WATCH_INCLUDE;
+  }
+  bool matched = false;
+  for (unsigned int i = 0; i < count; i++) {
+    if (modes[i] == WATCH_EXCLUDE) {
+      return false;
+    }
+    matched = matched || modes[i] == WATCH_INCLUDE;
+  }
+  return !includes || matched;
+}
+
+/**
+ * The listed filters are the ones of the set
+ */
+static void checkListed (const WatchList& list, const Reference& reference) {
+  CHECK(list.count() == reference.size());
+  Lines lines;
+  list.print(lines);
+  Reference listed;
+  size_t position = 0;
+  while (position < lines.text.length()) {
+    const size_t end = lines.text.find("\r\n", position);
+    CHECK(end != std::string::npos);
+    if (end == std::string::npos) {
+      break;
+    }
+    char mode[8], name[8];
+    unsigned long value;
+    const std::string line = lines.text.substr(position, end - position);
+    CHECK(sscanf(line.c_str(), "FILTER %7s %7s %lu", mode, name, &value) == 3);
+    unsigned int field = 0;
+    while (field < WATCH_FIELD_COUNT && strcmp(WatchList::fieldName((WatchField)field), name) != 0) {
+      field++;
+    }
+    CHECK(field < WATCH_FIELD_COUNT);
+    // Listed once
+    CHECK(listed.count(std::make_pair(field, (uint32_t)value)) == 0);
+    listed[std::make_pair(field, (uint32_t)value)] = strcmp(mode, "INCLUDE") == 0 ? WATCH_INCLUDE : WATCH_EXCLUDE;
+    position = end + 2;
+  }
+  CHECK(listed == reference);
+}
+
+/**
+ * Signals of every value: accepted as by the reference, the others counted
+ */
+static void checkAccepts (WatchList& list, const Reference& reference) {
+  unsigned long rejected = 0;
+  const unsigned long filtered = list.filtered();
+  for (unsigned int n = 0; n < 16; n++) {
+    WatchMode modes[3];
+    Frame frame;
+    if (n % 2 == 0) {
+      Type1Data data;
+      data.clear();
+      data.protocol = VALUES[randomBelow(VALUE_COUNT)];
+      data.decimal = VALUES[randomBelow(VALUE_COUNT)];
+      data.length = VALUES[randomBelow(VALUE_COUNT)];
+      frame = createFrame(data);
+      modes[0] = modeOf(reference, WATCH_PROTOCOL, data.protocol);
+      modes[1] = data.length <= 32 ? modeOf(reference, WATCH_CODE, data.decimal) : WATCH_NONE;
+      modes[2] = modeOf(reference, WATCH_LENGTH, data.length);
+    } else {
+      Type2Data data;
+      data.clear();
+      // Units are 4 bits long: 40 is never a unit
+      data.address = VALUES[randomBelow(VALUE_COUNT)];
+      data.unit = VALUES[randomBelow(VALUE_COUNT - 1)];
+      frame = createFrame(data);
+      modes[0] = modeOf(reference, WATCH_ADDRESS, data.address);
+      modes[1] = modeOf(reference, WATCH_UNIT, data.unit);
+    }
+    const bool expected = referenceAccepts(reference, modes, n % 2 == 0 ? 3 : 2);
+    CHECK(list.accepts(frame) == expected);
+    rejected += !expected;
+  }
+  CHECK(list.filtered() - filtered == (list.count() == 0 ? 0 : rejected));
+}
+
+static void checkRandom () {
+  WatchList list;
+  Reference reference;
+  for (unsigned int n = 0; n < OPERATIONS; n++) {
+    const WatchField field = (WatchField)randomBelow(WATCH_FIELD_COUNT);
+    const uint32_t value = VALUES[randomBelow(VALUE_COUNT)];
+    const std::pair<unsigned int, uint32_t> key = std::make_pair((unsigned int)field, value);
+    const unsigned int operation = randomBelow(100);
+    if (operation < 55) {
+      const WatchMode mode = randomBelow(4) == 0 ? WATCH_INCLUDE : WATCH_EXCLUDE;
+      const bool full = reference.size() == WatchList::MAX_ENTRIES && reference.count(key) == 0;
+      CHECK(list.add(field, value, mode) == !full);
+      if (!full) {
+        reference[key] = mode;
+      }
+    } else if (operation < 99) {
+      CHECK(list.remove(field, value) == (reference.erase(key) == 1));
+    } else {
+      list.clear();
+      reference.clear();
+    }
+    checkListed(list, reference);
+    checkAccepts(list, reference);
+  }
+}
+
+static void checkFull () {
+  WatchList list;
+  for (uint32_t value = 0; value < WatchList::MAX_ENTRIES; value++) {
+    CHECK(list.add(WATCH_CODE, value * 64, WATCH_EXCLUDE));
+  }
+  CHECK(!list.add(WATCH_CODE, 1, WATCH_EXCLUDE));
+  // Changed: not a new filter
+  CHECK(list.add(WATCH_CODE, 0, WATCH_INCLUDE));
+  CHECK(list.count() == WatchList::MAX_ENTRIES);
+  for (uint32_t value = 0; value < WatchList::MAX_ENTRIES; value += 2) {
+    CHECK(list.remove(WATCH_CODE, value * 64));
+  }
+  CHECK(!list.remove(WATCH_CODE, 0));
+  CHECK(list.count() == WatchList::MAX_ENTRIES / 2);
+  for (uint32_t value = 1; value < WatchList::MAX_ENTRIES; value += 2) {
+    CHECK(list.add(WATCH_CODE, value * 64, WATCH_INCLUDE));
+  }
+  CHECK(list.count() == WatchList::MAX_ENTRIES / 2);
+  list.clear();
+  CHECK(list.count() == 0);
+  Type1Data data;
+  data.clear();
+  data.decimal = 64;
+  data.length = 24;
+  CHECK(list.accepts(createFrame(data)));
+}
+
+int main () {
+  checkRandom();
+  checkFull();
+  return checkResult("watch list");
+}
@@ -0,0 +1,329 @@
+/**
+ * ESP32-RF433-Sniffer
+ *
+ * @author Hervé Perchec (https://github.com/hperchec)
+ *
+ * Copyright (c) 2025 Hervé Perchec. All right reserved.
+ * License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+ */
+
+// Cumulative timing error of the transmitter: waveforms are played through a
+// tracing GPIO HAL and each recorded edge is compared to the sum of the
+// durations played before it.
+// - exact HAL: every edge must be exactly on time
+// - slow HAL (each write takes time, each wait wakes up late): the error of
+//   an edge must stay below the cost of a single edge, whatever its position
+//   in the transmission (absolute deadlines: no drift)
+// - the encoded frames are the ones of the specification: type 1 from the
+//   pulse factors of the RCSwitch protocols, type 2 from the periods of the
+//   NewRemoteSwitch telegram, and are played on time
+
+#include <Arduino.h>
+#include <RCSwitch.h>
+#include "Check.h"
+#include "Gpio.h"
+#include "Transmitter.h"
+#include "Waveform.h"
+
+static const unsigned int REPEATS = 4;
+static const unsigned int CAPACITY = WAVEFORM_MAX_LEVELS * REPEATS + 1;
+
+typedef TraceGpioHal<CAPACITY> Trace;
+
+// Cost of a write and lateness of a wake-up of the slow HAL (in microseconds)
+static const unsigned long WRITE_COST = 3;
+static const unsigned long WAKE_LATE = 7;
+
+/**
+ * Slow policy: the trace, with time spent in each write and each wait
+ */
+struct SlowTraceHal {
+  template <uint8_t PIN>
+  static inline void setup () {
+    // Nothing to configure
+  }
+
+  template <uint8_t PIN>
+  static inline void high () {
+    Trace::clock += WRITE_COST;
+    Trace::record(true);
+  }
+
+  template <uint8_t PIN>
+  static inline void low () {
+    Trace::clock += WRITE_COST;
+    Trace::record(false);
+  }
+
+  static inline unsigned long now () {
+    return Trace::clock;
+  }
+
+  static inline void waitUntil (unsigned long deadline) {
+    Trace::waitUntil(deadline);
+    Trace::clock += WAKE_LATE;
+  }
+};
+
+typedef Transmitter<OutputPin<0, false, Trace>> ExactTransmitter;
+typedef Transmitter<OutputPin<0, false, SlowTraceHal>> SlowTransmitter;
+
+// Levels of a frame (from the durations, or from the specification)
+static bool frameLevels[WAVEFORM_MAX_LEVELS];
+static unsigned long frameDurations[WAVEFORM_MAX_LEVELS];
+static unsigned int frameCount;
+
+// Expected edges (from the levels)
+static unsigned long expectedEdges[CAPACITY];
+static bool expectedLevels[CAPACITY];
+static unsigned int expectedCount;
+
+static void addLevel (bool high, unsigned long duration) {
+  if (frameCount < WAVEFORM_MAX_LEVELS) {
+    frameLevels[frameCount] = high;
+    frameDurations[frameCount] = duration;
+  }
+  frameCount++;
+}
+
+/**
+ * Compute the edges of the frame levels sent from start: only level changes
+ * are edges (the pin is idle low), and the pin is low at the end
+ */
+static void expectLevels (unsigned long start, unsigned int scale, unsigned int repeats) {
+  unsigned long time = start;
+  bool level = false;
+  expectedCount = 0;
+  for (unsigned int r = 0; r < repeats; r++) {
+    for (unsigned int i = 0; i < frameCount && i < WAVEFORM_MAX_LEVELS; i++) {
+      if (frameLevels[i] != level && expectedCount < CAPACITY) {
+        expectedEdges[expectedCount] = time;
+        expectedLevels[expectedCount] = frameLevels[i];
+        expectedCount++;
+      }
+      level = frameLevels[i];
+      time += frameDurations[i] * scale / 100;
+    }
+  }
+  if (level && expectedCount < CAPACITY) {
+    expectedEdges[expectedCount] = time;
+    expectedLevels[expectedCount] = false;
+    expectedCount++;
+  }
+}
+
+/**
+ * Compute the edges of a waveform played from start (alternating levels)
+ */
+static void expect (const Waveform& waveform, unsigned long start, unsigned int scale, unsigned int repeats) {
+  frameCount = 0;
+  for (unsigned int i = 0; i < waveform.count; i++) {
+    addLevel((i % 2 == 0) != waveform.inverted, waveform.durations[i]);
+  }
+  expectLevels(start, scale, repeats);
+}
+
+/**
+ * Largest error of the recorded edges (in microseconds), ~0UL if the trace
+ * does not have the expected edges
+ */
+static unsigned long maxError () {
+  if (Trace::count != expectedCount || Trace::overflows > 0) {
+    return ~0UL;
+  }
+  unsigned long error = 0;
+  for (unsigned int i = 0; i < Trace::count; i++) {
+    if (Trace::levels[i] != expectedLevels[i] || (long)(Trace::edges[i] - expectedEdges[i]) < 0) {
+      // Wrong level, or early
+      return ~0UL;
+    }
+    error = max(error, Trace::edges[i] - expectedEdges[i]);
+  }
+  return error;
+}
+
+/**
+ * Type 1 frame of the specification, as RCSwitch::send sends it: the bits
+ * from the most significant one, then the sync, each a pulse of the
+ * protocol factors (low first for the inverted protocols)
+ */
+static void specifyType1 (const Type1Data& data) {
+  const RCSwitch::Protocol protocol = RCSwitch::getProtocol(data.protocol);
+  const unsigned long T = data.delay > 0 ? data.delay : protocol.pulseLength;
+  const bool first = !protocol.invertedSignal;
+  frameCount = 0;
+  for (unsigned int n = 0; n <= data.length; n++) {
+    RCSwitch::HighLow factors = protocol.syncFactor;
+    if (n < data.length) {
+      const unsigned int bit = data.length - 1 - n;
+      factors = (data.decimal >> bit) & 1 ? protocol.one : protocol.zero;
+    }
+    addLevel(first, T * factors.high);
+    addLevel(!first, T * factors.low);
+  }
+}
+
+/**
+ * Type 2 telegram of the specification (NewRemoteSwitch, period T): start
+ * pulse (T high, 10.5T low), address (26 bits), group bit, switch bit or
+ * 'dim' (T, T, T, T), unit (4 bits), dim level (4 bits, dim only), stop
+ * pulse (T high, 40T low). A '0' is (T, T, T, 5T), a '1' is (T, 5T, T, T).
+ */
+static void specifyType2 (const Type2Data& data) {
+  const unsigned long T = data.period;
+  const bool isDim = data.switchType == Type2Data::dim || (data.switchType == Type2Data::on && data.dimLevelPresent);
+  // Bits sent, from the most significant one
+  uint64_t bits = 0;
+  unsigned int length = 0;
+  auto add = [&](unsigned long value, unsigned int count) {
+    bits = (bits << count) | value;
+    length += count;
+  };
+  add(data.address, 26);
+  add(data.groupBit, 1);
+  // 'dim' takes the place of the switch bit (2 is not a bit)
+  const unsigned int switchPosition = length;
+  add(isDim ? 0 : data.switchType == Type2Data::on, 1);
+  add(data.groupBit ? 0 : data.unit, 4);
+  if (isDim) {
+    add(data.dimLevel, 4);
+  }
+  frameCount = 0;
+  addLevel(true, T);
+  addLevel(false, T * 10 + T / 2);
+  for (unsigned int n = 0; n < length; n++) {
+    const bool one = (bits >> (length - 1 - n)) & 1;
+    addLevel(true, T);
+    addLevel(false, isDim && n == switchPosition ? T : one ? 5 * T : T);
+    addLevel(true, T);
+    addLevel(false, isDim && n == switchPosition ? T : one ? T : 5 * T);
+  }
+  addLevel(true, T);
+  addLevel(false, T * 40);
+}
+
+/**
+ * The encoded waveform is the specified frame, and is played as specified
+ */
+static void checkSpecified (const Waveform& waveform) {
+  CHECK(frameCount <= WAVEFORM_MAX_LEVELS && waveform.count == frameCount);
+  for (unsigned int i = 0; i < waveform.count && i < frameCount; i++) {
+    CHECK(waveform.durations[i] == frameDurations[i]);
+    CHECK(((i % 2 == 0) != waveform.inverted) == frameLevels[i]);
+  }
+  for (unsigned int repeats = 1; repeats <= 2; repeats++) {
+    Trace::clock += 1000;
+    Trace::clear();
+    expectLevels(Trace::clock, 100, repeats);
+    ExactTransmitter::play(waveform.durations, waveform.count, 0, waveform.inverted, 100, repeats);
+    CHECK(maxError() == 0);
+  }
+}
+
+/**
+ * Play a waveform through both HALs and check the error of every edge
+ */
+static void check (const Waveform& waveform, unsigned int scale, unsigned int repeats) {
+  // Exact HAL: no error at all
+  Trace::clock += 1000;
+  Trace::clear();
+  expect(waveform, Trace::clock, scale, repeats);
+  ExactTransmitter::play(waveform.durations, waveform.count, 0, waveform.inverted, scale, repeats);
+  CHECK(maxError() == 0);
+
+  // Slow HAL: a write is late by the lateness of the previous wait and its
+  // own cost, never by more
+  Trace::clock += 1000;
+  Trace::clear();
+  expect(waveform, Trace::clock + WRITE_COST, scale, repeats);
+  SlowTransmitter::play(waveform.durations, waveform.count, 0, waveform.inverted, scale, repeats);
+  CHECK(maxError() <= WAKE_LATE + WRITE_COST);
+}
+
+int main () {
+  Waveform waveform;
+
+  // Type 1: every protocol, full length codes
+  for (int protocol = 1; protocol <= RCSwitch::getProtocolCount(); protocol++) {
+    Type1Data data;
+    data.clear();
+    data.protocol = protocol;
+    data.length = 32;
+    data.decimal = 0xA5C3F00FUL;
+    CHECK(encodeWaveform(waveform, data));
+    for (unsigned int repeats = 1; repeats <= REPEATS; repeats++) {
+      check(waveform, 100, repeats);
+      check(waveform, 85, repeats);
+      check(waveform, 115, repeats);
+    }
+  }
+
+  // Type 2: the longest frames (dim level)
+  Type2Data data;
+  data.clear();
+  data.period = 260;
+  data.address = 0x2ABCDEF;
+  data.switchType = Type2Data::dim;
+  data.dimLevelPresent = true;
+  data.dimLevel = 9;
+  CHECK(encodeWaveform(waveform, data));
+  CHECK(waveform.count == 148);
+  for (unsigned int repeats = 1; repeats <= REPEATS; repeats++) {
+    check(waveform, 100, repeats);
+    check(waveform, 110, repeats);
+  }
+
+  // Specification: every protocol, default and custom pulse lengths
+  static const unsigned long codes[] = { 0xA5C3F00FUL, 0x1UL, 0x80000000UL, 0x5A5A5UL };
+  static const unsigned int lengths[] = { 32, 1, 32, 24 };
+  for (int protocol = 1; protocol <= RCSwitch::getProtocolCount(); protocol++) {
+    for (unsigned int c = 0; c < 4; c++) {
+      for (unsigned int delay = 0; delay <= 420; delay += 420) {
+        Type1Data data;
+        data.clear();
+        data.protocol = protocol;
+        data.length = lengths[c];
+        data.decimal = codes[c];
+        data.delay = delay;
+        CHECK(encodeWaveform(waveform, data));
+        specifyType1(data);
+        checkSpecified(waveform);
+      }
+    }
+  }
+  // Unit, group, dim and group dim commands
+  for (unsigned int command = 0; command < 6; command++) {
+    Type2Data data;
+    data.clear();
+    data.period = 250 + command * 7;
+    data.address = command % 2 ? 0x3FFFFFF : 0x1234567;
+    data.groupBit = command >= 4;
+    data.unit = 5 + command;
+    data.switchType = command < 2 ? (Type2Data::SwitchType)command : Type2Data::dim;
+    data.dimLevelPresent = command >= 2;
+    data.dimLevel = 15 - command;
+    CHECK(encodeWaveform(waveform, data));
+    specifyType2(data);
+    checkSpecified(waveform);
+  }
+
+  // Whole buffer, starting at an offset (RCSwitch raw timings: first is 1)
+  unsigned int durations[WAVEFORM_MAX_LEVELS];
+  for (unsigned int i = 0; i < WAVEFORM_MAX_LEVELS; i++) {
+    durations[i] = 150 + (i * 37) % 900;
+  }
+  Trace::clock += 1000;
+  Trace::clear();
+  const unsigned long start = Trace::clock;
+  ExactTransmitter::play(durations, WAVEFORM_MAX_LEVELS, 1, false, 100, REPEATS);
+  unsigned long total = 0;
+  for (unsigned int i = 0; i < WAVEFORM_MAX_LEVELS; i++) {
+    total += durations[i];
+  }
+  CHECK(Trace::clock - start == total * REPEATS);
+  // Even count: the last level played is durations[0], low
+  CHECK(WAVEFORM_MAX_LEVELS % 2 == 0);
+  CHECK(Trace::count > 0 && Trace::edges[Trace::count - 1] - start == total * REPEATS - durations[0]);
+
+  return checkResult("waveform timing");
+}
@@ -0,0 +1,264 @@
+#!/usr/bin/env python3
+#
+# ESP32-RF433-Sniffer
+#
+# @author Hervé Perchec (https://github.com/hperchec)
+#
+# Copyright (c) 2025 Hervé Perchec. All right reserved.
+# License: GNU AFFERO GENERAL PUBLIC LICENSE (see LICENSE file)
+#
+# Static RAM/IRAM footprint of the firmware, per module, from the linker map
+# file of an ESP32 build, checked against a budget.
+#
+# The map file is written by the Arduino ESP32 core in the build folder:
+#
+#   arduino-cli compile --fqbn esp32:esp32:esp32 --build-path build \
+#     --libraries software/ESP32-RF433-Sniffer/libraries software/ESP32-RF433-Sniffer
+#   python3 software/tools/footprint.py build/ESP32-RF433-Sniffer.ino.map \
+#     --budget software/tools/footprint-budget.json
+#
+# Columns (bytes):
+#   iram : code and constants in IRAM (IRAM_ATTR, RECEIVE_ATTR...)
+#   data : initialized variables in DRAM (including DRAM_ATTR constants)
+#   bss  : zero-initialized variables in DRAM (static buffers, queues, stacks)
+#   dram : data + bss
+#
+# Modules are object files of the sketch and of its libraries (sketch
+# modules), or archives of the core and of ESP-IDF. "SKETCH" is the sum of
+# the sketch modules, "TOTAL" the sum of all modules.
+#
+# Exits with 1 if a module exceeds its budget (see footprint-budget.json).
+#
+# The budget is generated from a build (the "Firmware footprint" workflow,
+# run manually with "regenerate budget"): the footprint of each module and
+# column of the current budget (all the sketch modules if there is none), plus
+# some headroom, rounded up:
+#
+#   python3 software/tools/footprint.py build/ESP32-RF433-Sniffer.ino.map \
+#     --budget software/tools/footprint-budget.json \
+#     --write-budget software/tools/footprint-budget.json
+
+import argparse
+import json
+import math
+import os
+import re
+import sys
+
+COLUMNS = ("iram", "dram", "data", "bss")
+
+# Budgets are rounded up to this (bytes)
+BUDGET_ROUNDING = 256
+
+# Output sections, by prefix: the column they count in
+OUTPUT_SECTIONS = (
+    (".iram0", "iram"),
+    (".dram0.data", "data"),
+    (".dram0.bss", "bss"),
+    (".dram0.noinit", "bss"),
+    (".noinit", "bss"),
+)
+
+# Input section: " .name  0xaddress  0xsize  object", the name may be alone
+# on the previous line
+INPUT_SECTION = re.compile(r"^ (\S+)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+# Archive member: "path/libname.a(object.o)"
+ARCHIVE_MEMBER = re.compile(r"^(.*\.a)\((.*)\)$")
+
+
+def module_of(path):
+  """
+  Module name and if it is a sketch module, from an object path
+  """
+  path = path.strip()
+  member = ARCHIVE_MEMBER.match(path)
+  if member:
+    archive = os.path.basename(member.group(1))
+    # Libraries of the sketch may be archived (e.g. "RCSwitch.a")
+    is_sketch = "/libraries/" in member.group(1).replace("\\", "/")
+    return (archive[:-2] if is_sketch else archive), is_sketch
+  name = os.path.basename(path)
+  for suffix in (".cpp.o", ".c.o", ".S.o", ".o", ".obj"):
+    if name.endswith(suffix):
+      name = name[:-len(suffix)]
+      break
+  normalized = path.replace("\\", "/")
+  is_sketch = "/sketch/" in normalized or "/libraries/" in normalized
+  return name, is_sketch
+
+
+def column_of(output_section):
+  for prefix, column in OUTPUT_SECTIONS:
+    if output_section.startswith(prefix):
+      return column
+  return None
+
+
+def parse_map(lines):
+  """
+  Bytes per module and column: { module: { column: bytes } }, and the set
+  of sketch modules
+  """
+  usage = {}
+  sketch_modules = set()
+  in_memory_map = False
+  column = None
+  pending_name = None
+  for line in lines:
+    line = line.rstrip("\n")
+    if not in_memory_map:
+      # Skip the discarded input sections and the memory configuration
+      in_memory_map = line.startswith("Linker script and memory map")
+      continue
+    if line.startswith("."):
+      # Output section (its name may be alone on the line)
+      column = column_of(line.split()[0])
+      pending_name = None
+      continue
+    if column is None:
+      continue
+    if re.match(r"^ \S+$", line):
+      # Long input section name: address, size and object on the next line
+      pending_name = line.strip()
+      continue
+    match = INPUT_SECTION.match(line)
+    name = pending_name
+    pending_name = None
+    if not match:
+      continue
+    name = match.group(1) or name
+    if name is None or name.startswith("*"):
+      # Fill bytes and patterns
+      continue
+    size = int(match.group(3), 16)
+    if size == 0:
+      continue
+    module, is_sketch = module_of(match.group(4))
+    if is_sketch:
+      sketch_modules.add(module)
+    counts = usage.setdefault(module, dict.fromkeys(COLUMNS, 0))
+    counts[column] += size
+    if column in ("data", "bss"):
+      counts["dram"] += size
+  return usage, sketch_modules
+
+
+def add_totals(usage, sketch_modules):
+  totals = {"SKETCH": dict.fromkeys(COLUMNS, 0), "TOTAL": dict.fromkeys(COLUMNS, 0)}
+  for module, counts in usage.items():
+    for column in COLUMNS:
+      totals["TOTAL"][column] += counts[column]
+      if module in sketch_modules:
+        totals["SKETCH"][column] += counts[column]
+  usage.update(totals)
+
+
+def check_budget(usage, budget):
+  """
+  Budget overruns: [(module, column, used, budget)]
+  """
+  overruns = []
+  for module, limits in budget.items():
+    if module.startswith("_"):
+      # Comments
+      continue
+    counts = usage.get(module, dict.fromkeys(COLUMNS, 0))
+    for column, limit in limits.items():
+      if counts.get(column, 0) > limit:
+        overruns.append((module, column, counts.get(column, 0), limit))
+  return overruns
+
+
+def generate_budget(usage, sketch_modules, budget, headroom, source):
+  """
+  Budget from a footprint: same modules and columns as the current budget
+  (or every used column of the sketch modules and SKETCH), with headroom
+  """
+  template = {m: list(limits) for m, limits in budget.items() if not m.startswith("_")}
+  if not template:
+    for module in sorted(sketch_modules) + ["SKETCH"]:
+      columns = [c for c in COLUMNS if usage[module][c] > 0]
+      if columns:
+        template[module] = columns
+  generated = {key: value for key, value in budget.items() if key == "_comment"}
+  generated["_source"] = "Generated by footprint.py --write-budget from %s (+%d%% headroom, rounded up to %d bytes)" % (
+    source, headroom, BUDGET_ROUNDING)
+  for module, columns in template.items():
+    counts = usage.get(module, dict.fromkeys(COLUMNS, 0))
+    generated[module] = {}
+    for column in columns:
+      limit = math.ceil(counts.get(column, 0) * (100 + headroom) / 100 / BUDGET_ROUNDING) * BUDGET_ROUNDING
+      generated[module][column] = max(limit, BUDGET_ROUNDING)
+  return generated
+
+
+def write_budget(path, budget):
+  """
+  Budget file: one module per line
+  """
+  lines = []
+  for module, value in budget.items():
+    lines.append("  %s: %s" % (json.dumps(module), json.dumps(value)))
+  with open(path, "w", encoding="utf-8") as budget_file:
+    budget_file.write("{\n" + ",\n".join(lines) + "\n}\n")
+
+
+def print_report(usage, sketch_modules, budget, show_all):
+  print("%-28s %12s %12s %12s %12s" % (("Module",) + COLUMNS))
+  print("-" * 80)
+  shown = [m for m in usage if m not in ("SKETCH", "TOTAL") and (m in sketch_modules or show_all)]
+  shown.sort(key=lambda m: (m not in sketch_modules, -usage[m]["iram"] - usage[m]["dram"], m))
+  for module in shown + ["SKETCH", "TOTAL"]:
+    counts = usage[module]
+    limits = budget.get(module, {})
+    cells = []
+    for column in COLUMNS:
+      cell = str(counts[column])
+      if column in limits:
+        cell += "/" + str(limits[column])
+      cells.append(cell)
+    if module == "SKETCH":
+      print("-" * 80)
+    name = module + ("" if module in sketch_modules or module in ("SKETCH", "TOTAL") else " (core)")
+    print("%-28s %12s %12s %12s %12s" % ((name,) + tuple(cells)))
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Static RAM/IRAM footprint per module, from a linker map file")
+  parser.add_argument("map", help="linker map file (e.g. build/ESP32-RF433-Sniffer.ino.map)")
+  parser.add_argument("--budget", help="budget file (JSON): fails if a module exceeds it")
+  parser.add_argument("--all", action="store_true", help="also list the core and ESP-IDF modules")
+  parser.add_argument("--json", action="store_true", help="print the footprint as JSON")
+  parser.add_argument("--write-budget", metavar="FILE", help="write a budget generated from this footprint (no check)")
+  parser.add_argument("--headroom", type=int, default=10, help="headroom of a generated budget (percent, default: 10)")
+  args = parser.parse_args()
+
+  with open(args.map, encoding="utf-8", errors="replace") as map_file:
+    usage, sketch_modules = parse_map(map_file)
+  if not usage:
+    print("No IRAM/DRAM section found in " + args.map, file=sys.stderr)
+    return 2
+  add_totals(usage, sketch_modules)
+
+  budget = {}
+  if args.budget:
+    with open(args.budget, encoding="utf-8") as budget_file:
+      budget = json.load(budget_file)
+
+  if args.write_budget:
+    budget = generate_budget(usage, sketch_modules, budget, args.headroom, os.path.basename(args.map))
+    write_budget(args.write_budget, budget)
+
+  if args.json:
+    print(json.dumps(usage, indent=2, sort_keys=True))
+  else:
+    print_report(usage, sketch_modules, budget, args.all)
+
+  overruns = check_budget(usage, budget)
+  for module, column, used, limit in overruns:
+    print("BUDGET EXCEEDED: %s %s %d > %d bytes" % (module, column, used, limit), file=sys.stderr)
+  return 1 if overruns else 0
+
+
+if __name__ == "__main__":
+  sys.exit(main())